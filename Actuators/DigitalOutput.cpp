@@ -44,6 +44,25 @@ DigitalOutput::DigitalOutput(const char* name, uint8_t onValue,
     this->m_On = 0;
 }
 
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the actuator.
+ * \param[in] portId Pin of the output.
+ * \param[in] option On value of the output. 1 for HIGH, LOW otherwise.
+ *
+ * \returns The constructed object.
+ */
+Object* DigitalOutput::create(void* memory, const char* name, uint8_t portId,
+                              uint8_t option)
+{
+    DigitalOutput* output = new (memory) DigitalOutput(name,
+                                                       option == 1 ? 1 : 0,
+                                                       option == 1 ? 0 : 1);
+    output->setPin(portId);
+    return output;
+}
+
 uint16_t DigitalOutput::serialize(Stream* s)
 {
     uint16_t mySize = sizeof(m_OnValue) + sizeof(m_OffValue);
@@ -38,6 +38,8 @@ private:
     float m_DutyCycle;
 public:
     DigitalOutput(const char* name, uint8_t onValue, uint8_t offValue);
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
 
     virtual uint16_t serialize(Stream* s);
     virtual uint16_t deserialize(Stream* s);
@@ -38,6 +38,20 @@ ClockTimerController::ClockTimerController(const char* name) :
 	}
 }
 
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the controller.
+ * \param[in] portId Unused.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object.
+ */
+Object* ClockTimerController::create(void* memory, const char* name,
+		uint8_t portId, uint8_t option) {
+	return new (memory) ClockTimerController(name);
+}
+
 /**
  * \brief Destructor
  *
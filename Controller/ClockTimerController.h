@@ -44,6 +44,8 @@ class ClockTimerController: public Controller
 {
 public:
     ClockTimerController(const char* name);
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
     virtual ~ClockTimerController();
 
     ClockTimer* getClockTimer(int8_t id);
@@ -23,8 +23,6 @@
 
 #include <SD.h>
 
-#include <limits.h>
-
 enum TEMPLATE_LEVELCONTROLLER_STATES
 {
     LEVELCONTROLLER_STATE_OK,
@@ -47,6 +45,22 @@ LevelController::LevelController(const char* name) :
     m_State = LEVELCONTROLLER_STATE_OK;
     m_Timeout = 30;
     m_Sensor = -1;
+    m_LastTime = 0;
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the controller.
+ * \param[in] portId Unused.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object.
+ */
+Object* LevelController::create(void* memory, const char* name, uint8_t portId,
+                                uint8_t option)
+{
+    return new (memory) LevelController(name);
 }
 
 uint16_t LevelController::serialize(Stream* s)
@@ -113,28 +127,24 @@ uint16_t LevelController::deserialize(Stream* s)
  */
 int8_t LevelController::run()
 {
-    static unsigned long lastTime = 0;
     unsigned long millisNow = 0;
-    long delay_low_millis = 0;
-    long delay_high_millis = 0;
-    long timeout_millis = 0;
-    long deltaTSwitch = 0;
+    unsigned long delay_low_millis = 0;
+    unsigned long delay_high_millis = 0;
+    unsigned long timeout_millis = 0;
+    unsigned long deltaTSwitch = 0;
     int8_t sensor_val = 0;
 
     if (m_Sensor < 0 || m_Sensor >= MAX_SENSORS)
         return -1;
 
-    sensor_val = __aquaduino->getSensorValue(m_Sensor);
+    sensor_val = __aquaduino->getSensorMilliValue(m_Sensor) / 1000;
     millisNow = millis();
-    deltaTSwitch = millisNow - lastTime;
-
-    delay_high_millis = 1000 * (long) m_Delayh;
-    delay_low_millis = 1000 * (long) m_Delayl;
-    timeout_millis = 1000 * (long) m_Timeout;
+    //unsigned arithmetic handles the overflow of millis()
+    deltaTSwitch = millisNow - m_LastTime;
 
-    //Check for overflow while processing refill
-    if (m_State != LEVELCONTROLLER_STATE_OK && lastTime > millisNow)
-        deltaTSwitch = LONG_MAX - lastTime + millisNow;
+    delay_high_millis = 1000 * (unsigned long) m_Delayh;
+    delay_low_millis = 1000 * (unsigned long) m_Delayl;
+    timeout_millis = 1000 * (unsigned long) m_Timeout;
 
     switch (m_State)
     {
@@ -143,14 +153,14 @@ int8_t LevelController::run()
         if (sensor_val == HIGH)
         {
             m_State = LEVELCONTROLLER_STATE_DEBOUNCE;
-            lastTime = millisNow;
+            m_LastTime = millisNow;
         }
         break;
     case LEVELCONTROLLER_STATE_DEBOUNCE:
         if (sensor_val == HIGH && deltaTSwitch > delay_high_millis)
         {
             allMyActuators((int8_t) 1);
-            lastTime = millisNow;
+            m_LastTime = millisNow;
             m_State = LEVELCONTROLLER_STATE_REFILL;
         }
         else if (sensor_val == LOW)
@@ -162,7 +172,7 @@ int8_t LevelController::run()
         if (sensor_val == LOW)
         {
             m_State = LEVELCONTROLLER_STATE_OVERRUN;
-            lastTime = millisNow;
+            m_LastTime = millisNow;
         }
         else if (sensor_val == HIGH && deltaTSwitch > timeout_millis)
         {
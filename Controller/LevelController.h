@@ -43,6 +43,8 @@ class LevelController: public Controller
 {
 public:
     LevelController(const char* name);
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
 
     virtual uint16_t serialize(Stream* s);
     virtual uint16_t deserialize(Stream* s);
@@ -71,6 +73,7 @@ private:
     int16_t m_Timeout;
     int8_t m_State;
     int8_t m_Sensor;
+    unsigned long m_LastTime;
 };
 
 #endif /* LEVELCONTROLLER_H_ */
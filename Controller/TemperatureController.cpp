@@ -39,6 +39,22 @@ TemperatureController::TemperatureController(const char* name) :
     m_Actuator2 = -1;
     m_Cooling = 0;
     m_Heating = 0;
+    updateThresholds();
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the controller.
+ * \param[in] portId Unused.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object.
+ */
+Object* TemperatureController::create(void* memory, const char* name, uint8_t portId,
+                                      uint8_t option)
+{
+    return new (memory) TemperatureController(name);
 }
 
 /**
@@ -80,6 +96,7 @@ uint16_t TemperatureController::deserialize(Stream* s)
     	s->readBytes((char*) &m_Actuator1, sizeof(m_Actuator1));
     	s->readBytes((char*) &m_RefTemp2, sizeof(m_RefTemp2));
     	s->readBytes((char*) &m_Hysteresis2, sizeof(m_Hysteresis2));
+    	updateThresholds();
     	s->readBytes((char*) &m_Actuator2, sizeof(m_Actuator2));
         return mySize;
     }
@@ -95,24 +112,32 @@ uint16_t TemperatureController::deserialize(Stream* s)
  */
 int8_t TemperatureController::run()
 {
+#ifdef FIXED_POINT_SENSORS
+    int32_t temp;
+#else
     float temp;
+#endif
     Actuator *actuator1, *actuator2;
 
     if (m_Sensor == -1 || (m_Actuator1 == -1 && m_Actuator2 == -1))
         return -1;
 
+#ifdef FIXED_POINT_SENSORS
+    temp = __aquaduino->getSensorMilliValue(m_Sensor);
+#else
     temp = __aquaduino->getSensorValue(m_Sensor);
+#endif
     actuator1 = __aquaduino->getActuator(m_Actuator1);
     actuator2 = __aquaduino->getActuator(m_Actuator2);
 
     if (actuator1)
     {
-        if (temp < m_RefTemp1)
+        if (temp < m_HeatOn)
         {
             actuator1->on();
             m_Heating = 1;
         }
-        else if (m_Heating && (temp > m_RefTemp1 + m_Hysteresis1))
+        else if (m_Heating && (temp > m_HeatOff))
         {
             actuator1->off();
             m_Heating = 0;
@@ -121,12 +146,12 @@ int8_t TemperatureController::run()
 
     if (actuator2)
     {
-        if (temp > m_RefTemp2)
+        if (temp > m_CoolOn)
         {
             actuator2->on();
             m_Cooling = 1;
         }
-        else if (actuator2 && m_Cooling && temp < m_RefTemp2 - m_Hysteresis1)
+        else if (actuator2 && m_Cooling && temp < m_CoolOff)
         {
             actuator2->off();
             m_Cooling = 0;
@@ -136,6 +161,29 @@ int8_t TemperatureController::run()
     return true;
 }
 
+/**
+ * \brief Precomputes the switching thresholds used by run.
+ *
+ * Called whenever a reference temperature or hysteresis changes so that run
+ * compares the sensor reading without any conversion. With
+ * FIXED_POINT_SENSORS the thresholds are kept in milli degrees, rounded as
+ * e.g. 16.06 * 1000 is slightly below 16060.
+ */
+void TemperatureController::updateThresholds()
+{
+#ifdef FIXED_POINT_SENSORS
+    m_HeatOn = lround(m_RefTemp1 * 1000);
+    m_HeatOff = lround((m_RefTemp1 + m_Hysteresis1) * 1000);
+    m_CoolOn = lround(m_RefTemp2 * 1000);
+    m_CoolOff = lround((m_RefTemp2 - m_Hysteresis2) * 1000);
+#else
+    m_HeatOn = m_RefTemp1;
+    m_HeatOff = m_RefTemp1 + m_Hysteresis1;
+    m_CoolOn = m_RefTemp2;
+    m_CoolOff = m_RefTemp2 - m_Hysteresis2;
+#endif
+}
+
 int8_t TemperatureController::getAssignedSensor()
 {
     return m_Sensor;
@@ -155,12 +203,14 @@ double TemperatureController::getRefTempLow()
 double TemperatureController::setRefTempLow(double tempLow)
 {
     m_RefTemp1 = tempLow;
+    updateThresholds();
     return m_RefTemp1;
 }
 
 double TemperatureController::setHeatingHysteresis(double hysteresis)
 {
     m_Hysteresis1 = hysteresis;
+    updateThresholds();
     return m_Hysteresis1;
 }
 
@@ -188,12 +238,14 @@ double TemperatureController::getRefTempHigh()
 double TemperatureController::setRefTempHigh(double tempHigh)
 {
     m_RefTemp2 = tempHigh;
+    updateThresholds();
     return m_RefTemp2;
 }
 
 double TemperatureController::setCoolingHysteresis(double hysteresis)
 {
     m_Hysteresis2 = hysteresis;
+    updateThresholds();
     return m_Hysteresis2;
 }
 
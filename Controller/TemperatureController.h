@@ -23,6 +23,7 @@
 
 #include <Framework/Controller.h>
 #include <Framework/Actuator.h>
+#include <Framework/FrameworkConfig.h>
 
 /**
  * \brief Controller for temperature monitoring
@@ -35,6 +36,8 @@ class TemperatureController: public Controller
 {
 public:
     TemperatureController(const char* name);
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
     virtual ~TemperatureController();
 
     int8_t getAssignedSensor();
@@ -64,6 +67,8 @@ public:
     virtual int8_t run();
 
 private:
+    void updateThresholds();
+
     int8_t m_Sensor;
     double m_RefTemp1;
     double m_Hysteresis1;
@@ -74,6 +79,18 @@ private:
 
     int8_t m_Cooling;
     int8_t m_Heating;
+
+#ifdef FIXED_POINT_SENSORS
+    int32_t m_HeatOn;
+    int32_t m_HeatOff;
+    int32_t m_CoolOn;
+    int32_t m_CoolOff;
+#else
+    float m_HeatOn;
+    float m_HeatOff;
+    float m_CoolOn;
+    float m_CoolOff;
+#endif
 };
 
 #endif /* TEMPERATURECONTROLLER_H_ */
@@ -53,10 +53,9 @@ protected:
     int8_t m_ControlledBy;
     int8_t m_locked;
 
-    virtual ~Actuator();
-
 public:
     Actuator(const char* name);
+    virtual ~Actuator();
 
     void setController(int8_t controller);
     int8_t getController();
@@ -47,15 +47,19 @@
  */
 
 #include <Aquaduino.h>
-#include <Controller/TemperatureController.h>
-#include <Controller/LevelController.h>
-#include <Controller/ClockTimerController.h>
-#include <Actuators/DigitalOutput.h>
-#include <Sensors/DS18S20.h>
-#include <Sensors/DigitalInput.h>
-#include <Sensors/SerialAtlasPH.h>
-#include <Sensors/SerialAtlasEC.h>
-#include <Sensors/SerialAtlasORP.h>
+#include <Framework/ObjectFactory.h>
+#ifdef USE_EXPORTER_XIVELY
+#include <Framework/XivelyExporter.h>
+#endif
+#ifdef USE_EXPORTER_LINEPROTOCOL
+#include <Framework/LineProtocolExporter.h>
+#endif
+#ifdef USE_MQTT
+#include <Framework/MQTTBridge.h>
+#endif
+#ifdef USE_HTTPSERVER
+#include <Framework/HTTPServer.h>
+#endif
 #include <SD.h>
 #include <Time.h>
 #include <EthernetUdp.h>
@@ -79,7 +83,8 @@ Aquaduino::Aquaduino() :
 				168, 1, 1), m_Gateway(192, 168, 1, 1), m_NTPServer(192, 53, 103,
 				108), m_Timezone(TIME_ZONE), m_NTPSyncInterval(5), m_DHCP(0), m_NTP(
 				0), m_Xively(0), m_Controllers(MAX_CONTROLLERS), m_Actuators(
-		MAX_ACTUATORS), m_Sensors(MAX_SENSORS), m_XivelyClient(ethClient) {
+		MAX_ACTUATORS), m_Sensors(MAX_SENSORS), m_Exporter(NULL), m_SampleQueue(
+		SAMPLE_QUEUE_FILE), m_ExportRetry(1), m_MQTTBridge(NULL), m_HTTPServer(NULL) {
 	__aquaduino = this;
 	m_Type = AQUADUINO;
 
@@ -94,6 +99,22 @@ Aquaduino::Aquaduino() :
 	initNetwork();
 	initXively();
 
+#if defined(USE_EXPORTER_XIVELY)
+	m_Exporter = new XivelyExporter(ethClient, m_XivelyFeedName, m_XivelyAPIKey,
+			m_XivelyChannelNames);
+#elif defined(USE_EXPORTER_LINEPROTOCOL)
+	m_Exporter = new LineProtocolExporter(IPAddress(LINEPROTOCOL_HOST),
+			LINEPROTOCOL_PORT);
+#endif
+
+#ifdef USE_MQTT
+	m_MQTTBridge = new MQTTBridge();
+#endif
+
+#ifdef USE_HTTPSERVER
+	m_HTTPServer = new HTTPServer(HTTPSERVER_PORT);
+#endif
+
 #ifdef INTERRUPT_DRIVEN
 	Serial.println("Interrupt triggered mode enabled.");
 	startTimer();
@@ -456,13 +477,11 @@ void Aquaduino::initXively() {
 		Serial.print(i);
 		Serial.print(":");
 		Serial.println(m_XivelyChannelNames[i]);
-		m_XiveleyDatastreams[i] = new XivelyDatastream(m_XivelyChannelNames[i],
-				strlen(m_XivelyChannelNames[i]),
-				DATASTREAM_FLOAT);
 	}
 
-	m_XivelyFeed = new XivelyFeed(atol(m_XivelyFeedName), m_XiveleyDatastreams,
-			getNrOfSensors());
+	m_SampleQueue.init();
+	Serial.print(F("Queued samples: "));
+	Serial.println(m_SampleQueue.size());
 }
 
 /**
@@ -508,6 +527,12 @@ const char* Aquaduino::getXivelyFeed() {
 	return m_XivelyFeedName;
 }
 
+const char* Aquaduino::getXivelyChannelName(int8_t sensor) {
+	if (sensor < 0 || sensor >= MAX_SENSORS)
+		return "";
+	return m_XivelyChannelNames[sensor];
+}
+
 /**
  * \brief Adds a controller to Aquaduino.
  * \param[in] newController The controller to be added.
@@ -759,9 +784,39 @@ unsigned char Aquaduino::getNrOfSensors() {
 	return m_Sensors.getNrOfElements();
 }
 
+/**
+ * \brief Getter for the last reading of a sensor.
+ * \param[in] idx ID of the sensor.
+ *
+ * \returns The value read during the last Aquaduino::readSensors call.
+ */
 double Aquaduino::getSensorValue(int8_t idx) {
 	if (idx >= 0 && idx < MAX_SENSORS)
+#ifdef FIXED_POINT_SENSORS
+		return m_SensorReadings[idx] / 1000.0;
+#else
+		return m_SensorReadings[idx];
+#endif
+	return 0;
+}
+
+/**
+ * \brief Getter for the last reading of a sensor in milli-units.
+ * \param[in] idx ID of the sensor.
+ *
+ * Preferred over Aquaduino::getSensorValue by controllers as no floating
+ * point math is involved when FIXED_POINT_SENSORS is defined.
+ *
+ * \returns The value read during the last Aquaduino::readSensors call
+ * multiplied by 1000.
+ */
+int32_t Aquaduino::getSensorMilliValue(int8_t idx) {
+	if (idx >= 0 && idx < MAX_SENSORS)
+#ifdef FIXED_POINT_SENSORS
 		return m_SensorReadings[idx];
+#else
+		return m_SensorReadings[idx] * 1000;
+#endif
 	return 0;
 }
 
@@ -769,6 +824,15 @@ OneWireHandler* Aquaduino::getOneWireHandler() {
 	return m_OneWireHandler;
 }
 
+/**
+ * \brief Getter for the arena holding controllers, actuators and sensors.
+ *
+ * \returns pointer to the object arena. Allows to query its high-water mark.
+ */
+ObjectArena* Aquaduino::getObjectArena() {
+	return &m_ObjectArena;
+}
+
 /*
  * ============================================================================
  */
@@ -777,7 +841,7 @@ const uint16_t Aquaduino::m_Size = sizeof(m_MAC) + sizeof(uint32_t)
 		+ sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t)
 		+ sizeof(uint32_t) + sizeof(m_NTPSyncInterval) + sizeof(m_DHCP)
 		+ sizeof(m_NTP) + sizeof(m_Timezone) + sizeof(m_Xively)
-		+ sizeof(m_XivelyAPIKey) + sizeof(m_XivelyFeed)
+		+ sizeof(m_XivelyAPIKey) + sizeof(m_XivelyFeedName)
 		+ sizeof(m_XivelyChannelNames);
 
 /**
@@ -820,7 +884,6 @@ uint16_t Aquaduino::deserialize(Stream* s) {
 
 	memset(m_XivelyAPIKey, 0, sizeof(m_XivelyAPIKey));
 	memset(m_XivelyFeedName, 0, sizeof(m_XivelyFeedName));
-	memset(m_XiveleyDatastreams, 0, sizeof(m_XiveleyDatastreams));
 	memset(m_XivelyChannelNames, 0, sizeof(m_XivelyChannelNames));
 
 	if (size >= 7) {
@@ -860,29 +923,24 @@ uint16_t Aquaduino::deserialize(Stream* s) {
 		uint8_t typeId = s->read();
 		uint8_t portId = s->read();
 		uint8_t onValue = s->read();
+		uint16_t mark = m_ObjectArena.getMark();
 		Actuator* actuator;
 		int8_t idx;
 
-		switch (typeId) {
-		case 1:
-			Serial.print(F("Adding Digitaloutput actuator @  Pin: "));
-			Serial.print(portId);
-			Serial.print(" On @ ");
-			Serial.print(onValue == 1 ? 1 : 0);
-			Serial.print(" Off @ ");
-			Serial.println(onValue == 1 ? 0 : 1);
-			actuator = new DigitalOutput(name, onValue == 1 ? 1 : 0,
-					onValue == 1 ? 0 : 1);
-			((DigitalOutput*) actuator)->setPin(portId);
-			break;
-		default:
-			actuator = NULL;
-			break;
-		}
+		Serial.print(F("Adding actuator of type "));
+		Serial.print(typeId);
+		Serial.print(F(" @ Port: "));
+		Serial.println(portId);
+		actuator = (Actuator*) ObjectFactory::create(&m_ObjectArena,
+				FACTORY_ACTUATORS, typeId, name, portId, onValue);
 
 		if ((actuator != NULL)
 				&& (idx = __aquaduino->addActuator(actuator)) != -1) {
 			readConfig(actuator);
+		} else {
+			if (actuator != NULL)
+				actuator->~Actuator();
+			m_ObjectArena.rewind(mark);
 		}
 	}
 
@@ -891,27 +949,20 @@ uint16_t Aquaduino::deserialize(Stream* s) {
 		char name[stringLength];
 		s->readBytes(name, stringLength);
 		uint8_t typeId = s->read();
+		uint16_t mark = m_ObjectArena.getMark();
 		Controller* controller;
 		int8_t idx;
 
-		switch (typeId) {
-		case 1:
-			controller = new LevelController(name);
-			break;
-		case 2:
-			controller = new TemperatureController(name);
-			break;
-		case 3:
-			controller = new ClockTimerController(name);
-			break;
-		default:
-			controller = NULL;
-			break;
-		}
+		controller = (Controller*) ObjectFactory::create(&m_ObjectArena,
+				FACTORY_CONTROLLERS, typeId, name, 0, 0);
 
 		if ((controller != NULL)
 				&& (idx = __aquaduino->addController(controller)) != -1) {
 			readConfig(controller);
+		} else {
+			if (controller != NULL)
+				controller->~Controller();
+			m_ObjectArena.rewind(mark);
 		}
 	}
 
@@ -923,48 +974,35 @@ uint16_t Aquaduino::deserialize(Stream* s) {
 		uint8_t typeId = s->read();
 		uint8_t portId = s->read();
 		s->readBytes(xivelyChannel, xivelyChannelNameLength);
+		uint16_t mark = m_ObjectArena.getMark();
 		Sensor* sensor;
 		int8_t idx;
 
-		switch (typeId) {
-		case 1:
-			Serial.print(F("Adding Digitalinpiut sensor @  Pin: "));
-			Serial.println(portId);
-			sensor = new DigitalInput();
-			((DigitalInput*) sensor)->setPin(portId);
-			((DigitalInput*) sensor)->setName(name);
-			break;
-		case 2:
-			sensor = new DS18S20();
-			Serial.print(F("Adding DS18S20 sensor @  Pin: "));
-			Serial.println(portId);
-			((DS18S20*) sensor)->setPin(portId);
-			((DS18S20*) sensor)->setName(name);
-			m_OneWireHandler->addPin(portId);
-			break;
-		case 3:
-			sensor = new SerialAtlasPH();
-			((SerialAtlasPH*) sensor)->setName(name);
-			break;
-		case 4:
-			sensor = new SerialAtlasEC();
-			((SerialAtlasEC*) sensor)->setName(name);
-			break;
-		case 5:
-			sensor = new SerialAtlasORP();
-			((SerialAtlasORP*) sensor)->setName(name);
-			break;
-		default:
-			sensor = NULL;
-			break;
-		}
+		Serial.print(F("Adding sensor of type "));
+		Serial.print(typeId);
+		Serial.print(F(" @ Port: "));
+		Serial.println(portId);
+		sensor = (Sensor*) ObjectFactory::create(&m_ObjectArena,
+				FACTORY_SENSORS, typeId, name, portId, 0);
 
 		if ((sensor != NULL) && (idx = __aquaduino->addSensor(sensor)) != -1) {
 			memcpy(m_XivelyChannelNames[idx], xivelyChannel,
 					xivelyChannelNameLength);
 			readConfig(sensor);
+		} else {
+			if (sensor != NULL)
+				sensor->~Sensor();
+			m_ObjectArena.rewind(mark);
 		}
 	}
+
+	Serial.print(F("Object arena: "));
+	Serial.print(m_ObjectArena.getUsed());
+	Serial.print(F(" of "));
+	Serial.print(m_ObjectArena.getSize());
+	Serial.print(F(" Bytes used. High-water mark: "));
+	Serial.println(m_ObjectArena.getHighWaterMark());
+
 	s->readBytes((char*) m_MAC, sizeof(m_MAC));
 	Serial.print(F("MAC: "));
 	for (uint8_t i = 0; i < sizeof(m_MAC); i++) {
@@ -1213,19 +1251,29 @@ void Aquaduino::startTimer() {
 	TIMSK5 = _BV(TOIE5);
 }
 
+/**
+ * \brief Reads all sensors
+ *
+ * The OneWire buses are advanced first so that all DS18S20 of a bus read the
+ * result of the same conversion.
+ */
 void Aquaduino::readSensors() {
 	int8_t sensorIdx;
 	Sensor* currentSensor;
 
+	if (m_OneWireHandler != NULL)
+		m_OneWireHandler->run();
+
 	for (sensorIdx = 0; sensorIdx < MAX_SENSORS; sensorIdx++) {
 		currentSensor = m_Sensors.get(sensorIdx);
 		if (currentSensor) {
+#ifdef FIXED_POINT_SENSORS
+			m_SensorReadings[sensorIdx] = currentSensor->readMilli();
+#else
 			m_SensorReadings[sensorIdx] = currentSensor->read();
-			m_XiveleyDatastreams[sensorIdx]->setFloat(
-					m_SensorReadings[sensorIdx]);
+#endif
 		} else {
-			m_SensorReadings[sensorIdx] = 0.0;
-			m_XiveleyDatastreams[sensorIdx]->setFloat(0.0);
+			m_SensorReadings[sensorIdx] = 0;
 		}
 	}
 }
@@ -1241,6 +1289,60 @@ void Aquaduino::executeControllers() {
 	}
 }
 
+/**
+ * \brief Sets the exporter the sensor readings are sent with.
+ * \param[in] exporter The exporter. NULL to stop exporting.
+ *
+ * Samples already queued are sent with the new exporter.
+ */
+void Aquaduino::setExporter(Exporter* exporter) {
+	m_Exporter = exporter;
+	m_ExportRetry = 1;
+}
+
+/**
+ * \brief Getter for the exporter the sensor readings are sent with.
+ *
+ * \returns The exporter. NULL if none is set.
+ */
+Exporter* Aquaduino::getExporter() {
+	return m_Exporter;
+}
+
+/**
+ * \brief Queues the current sensor readings for the exporter.
+ */
+void Aquaduino::queueSample() {
+	Sample sample;
+	int8_t sensorIdx;
+
+	sample.time = now();
+	for (sensorIdx = 0; sensorIdx < MAX_SENSORS; sensorIdx++)
+		sample.values[sensorIdx] = getSensorMilliValue(sensorIdx);
+
+	m_SampleQueue.push(&sample);
+}
+
+/**
+ * \brief Passes the oldest queued samples to the exporter.
+ *
+ * The samples the exporter reports as done are removed from the queue. On
+ * failure they are kept and the export is retried in the next minute. As
+ * long as exports succeed, run calls this method again to catch up with a
+ * backlog.
+ */
+void Aquaduino::exportSamples() {
+	int16_t done;
+
+	done = m_Exporter->exportSamples(&m_SampleQueue,
+			m_Exporter->getBatchSize());
+	if (done >= 0) {
+		m_SampleQueue.pop(done);
+	} else {
+		m_ExportRetry = 0;
+	}
+}
+
 /**
  * \brief Top level run method.
  *
@@ -1256,11 +1358,30 @@ void Aquaduino::run() {
 	executeControllers();
 #endif
 
-	if (isXivelyEnabled() && minute() != curMin) {
-		curMin = minute();
-		Serial.print(F("Sending data to Xively... "));
-		Serial.println(m_XivelyClient.put(*m_XivelyFeed, m_XivelyAPIKey));
+	if (m_Exporter != NULL && m_Exporter->isEnabled()) {
+		if (minute() != curMin) {
+			curMin = minute();
+			queueSample();
+			m_ExportRetry = 1;
+		}
+
+		if (m_ExportRetry
+				&& m_SampleQueue.size() >= m_Exporter->getBatchSize()) {
+			exportSamples();
+		}
+	}
+
+#ifdef USE_MQTT
+	if (m_MQTTBridge != NULL) {
+		m_MQTTBridge->run();
 	}
+#endif
+
+#ifdef USE_HTTPSERVER
+	if (m_HTTPServer != NULL) {
+		m_HTTPServer->run();
+	}
+#endif
 
 	if (m_GUIServer != NULL) {
 		m_GUIServer->run();
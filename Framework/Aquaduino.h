@@ -24,7 +24,6 @@
 #include <Arduino.h>
 #include <Ethernet.h>
 #include <HttpClient.h>
-#include <Xively.h>
 
 #include "Framework/FrameworkConfig.h"
 #include "Framework/Controller.h"
@@ -36,11 +35,16 @@
 #include "Framework/Serializable.h"
 #include "Framework/OneWireHandler.h"
 #include "Framework/GUIServer.h"
+#include "Framework/ObjectArena.h"
+#include "Framework/SampleQueue.h"
+#include "Framework/Exporter.h"
 
 class Controller;
 class Actuator;
 class Sensor;
 class ConfigManager;
+class MQTTBridge;
+class HTTPServer;
 
 /*! \brief Aquaduino main class.
  *
@@ -111,6 +115,7 @@ public:
 
     void setXivelyFeed(const char* feed);
     const char* getXivelyFeed();
+    const char* getXivelyChannelName(int8_t sensor);
 
     int8_t addController(Controller* newController);
     Controller* getController(unsigned int controller);
@@ -138,8 +143,10 @@ public:
     unsigned char getNrOfSensors();
 
     double getSensorValue(int8_t idx);
+    int32_t getSensorMilliValue(int8_t idx);
 
     OneWireHandler* getOneWireHandler();
+    ObjectArena* getObjectArena();
 
     uint16_t serialize(Stream* s);
     uint16_t deserialize(Stream* s);
@@ -158,6 +165,11 @@ public:
     void readSensors();
     void executeControllers();
 
+    void setExporter(Exporter* exporter);
+    Exporter* getExporter();
+    void queueSample();
+    void exportSamples();
+
     void run();
 
 protected:
@@ -177,19 +189,26 @@ private:
     ArrayMap<Controller*> m_Controllers;
     ArrayMap<Actuator*> m_Actuators;
     ArrayMap<Sensor*> m_Sensors;
+    ObjectArena m_ObjectArena;
 
     ConfigManager* m_ConfigManager;
     OneWireHandler* m_OneWireHandler;
     GUIServer* m_GUIServer;
 
-    XivelyDatastream* m_XiveleyDatastreams[MAX_SENSORS];
-    XivelyFeed* m_XivelyFeed;
     EthernetClient ethClient;
-    XivelyClient m_XivelyClient;
+    Exporter* m_Exporter;
+    SampleQueue m_SampleQueue;
+    int8_t m_ExportRetry;
+    MQTTBridge* m_MQTTBridge;
+    HTTPServer* m_HTTPServer;
 
     static const uint16_t m_Size;
 
+#ifdef FIXED_POINT_SENSORS
+    int32_t m_SensorReadings[MAX_SENSORS];
+#else
     double m_SensorReadings[MAX_SENSORS];
+#endif
 };
 
 extern Aquaduino* __aquaduino;
@@ -44,6 +44,7 @@ class Controller: public Object, public Serializable
 {
 public:
     Controller(const char* name);
+    virtual ~Controller();
 
     /**
      * \brief Interface method for triggering the controller.
@@ -53,7 +54,6 @@ public:
     virtual int8_t run() = 0;
 
 protected:
-    virtual ~Controller();
     void allMyActuators(int8_t on);
     void allMyActuators(float dutyCycle);
 
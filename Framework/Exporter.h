@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EXPORTER_H_
+#define EXPORTER_H_
+
+#include <stdint.h>
+#include <Framework/SampleQueue.h>
+
+/**
+ * \brief Interface for sending the sensor readings to a telemetry service.
+ *
+ * Aquaduino::run queues one Sample per minute while the exporter is enabled.
+ * As soon as getBatchSize samples are queued they are passed to exportSamples.
+ * The exporter reads them with SampleQueue::peek and reports how many of them
+ * Aquaduino may remove from the queue.
+ */
+class Exporter
+{
+public:
+    /**
+     * \brief Checks whether samples shall be queued and exported.
+     *
+     * \returns 1 if enabled. 0 otherwise.
+     */
+    virtual int8_t isEnabled() = 0;
+
+    /**
+     * \brief Getter for the number of samples sent at once.
+     *
+     * \returns Number of samples exportSamples is called with.
+     */
+    virtual uint16_t getBatchSize() = 0;
+
+    /**
+     * \brief Sends the oldest samples of the queue.
+     * \param[in] queue Queue holding the samples.
+     * \param[in] count Number of samples to be sent.
+     *
+     * The samples must not be removed from the queue by the exporter.
+     *
+     * \returns Number of samples to be removed from the queue. -1 if the
+     * samples could not be sent and shall be retried later.
+     */
+    virtual int16_t exportSamples(SampleQueue* queue, uint16_t count) = 0;
+};
+
+#endif /* EXPORTER_H_ */
@@ -45,6 +45,31 @@
  */
 #define MAX_CLOCKTIMERS             24
 
+/**
+ * \brief Defines the size in bytes of the static arena holding all
+ * controllers, actuators and sensors created from the configuration.
+ *
+ * The arena is shared by all object types. The high-water mark printed after
+ * reading the configuration helps to right-size this value.
+ */
+#define OBJECT_ARENA_SIZE           3072
+
+/**
+ * \brief Object types registered in the ObjectFactory. Undefine a type to
+ * remove it from the firmware image.
+ */
+#define USE_ACTUATOR_DIGITALOUTPUT
+#define USE_CONTROLLER_LEVEL
+#define USE_CONTROLLER_TEMPERATURE
+#define USE_CONTROLLER_CLOCKTIMER
+#define USE_SENSOR_DIGITALINPUT
+#define USE_SENSOR_DS18S20
+#define USE_SENSOR_SERIALATLASPH
+#define USE_SENSOR_SERIALATLASEC
+#define USE_SENSOR_SERIALATLASORP
+#define USE_SENSOR_FLOW
+#define USE_SENSOR_ANALOGINPUT
+
 /**
  * \brief Defines the maximum number of timers per clocktimer
  */
@@ -81,6 +106,167 @@
  */
 #define XIVELY_FEED_NAME_LENGTH     21
 
+/**
+ * \brief Number of samples of all sensors kept in RAM until the Exporter has
+ * sent them. Older samples are moved to #SAMPLE_QUEUE_FILE on the SD card.
+ */
+#define SAMPLE_QUEUE_SIZE           8
+
+/**
+ * \brief File on the SD card holding the samples that did not fit into RAM.
+ */
+#define SAMPLE_QUEUE_FILE           "samples.dat"
+
+/**
+ * \brief Number of samples (one per minute) uploaded to Xively per request.
+ *
+ * Only used by the XivelyExporter, the LineProtocolExporter sends
+ * #LINEPROTOCOL_BATCH_SIZE samples at once.
+ */
+#define XIVELY_BATCH_SIZE           5
+
+/**
+ * \brief Exporter the sensor readings are sent with. Define exactly one of
+ * them.
+ */
+#define USE_EXPORTER_XIVELY
+#undef USE_EXPORTER_LINEPROTOCOL
+
+/**
+ * \brief Receiver of the LineProtocolExporter given as IPAddress arguments.
+ */
+#define LINEPROTOCOL_HOST           192, 168, 1, 10
+
+/**
+ * \brief UDP port of the receiver of the LineProtocolExporter.
+ */
+#define LINEPROTOCOL_PORT           8089
+
+/**
+ * \brief Local UDP port the LineProtocolExporter sends from.
+ */
+#define LINEPROTOCOL_LOCAL_PORT     8089
+
+/**
+ * \brief Measurement name used by the LineProtocolExporter.
+ */
+#define LINEPROTOCOL_MEASUREMENT    "aquaduino"
+
+/**
+ * \brief Number of samples (one per minute) sent by the LineProtocolExporter
+ * at once.
+ */
+#define LINEPROTOCOL_BATCH_SIZE     1
+
+/**
+ * \brief Enables the MQTTBridge publishing sensor readings and actuator states
+ * to an MQTT broker and receiving actuator commands from it.
+ */
+#undef USE_MQTT
+
+/**
+ * \brief Address of the MQTT broker given as IPAddress arguments.
+ */
+#define MQTT_BROKER                 192, 168, 1, 10
+
+/**
+ * \brief Port of the MQTT broker.
+ */
+#define MQTT_PORT                   1883
+
+/**
+ * \brief Client identifier used at the MQTT broker.
+ */
+#define MQTT_CLIENT_ID              "aquaduino"
+
+/**
+ * \brief First level of all MQTT topics of Aquaduino.
+ */
+#define MQTT_TOPIC_PREFIX           "aquaduino"
+
+/**
+ * \brief MQTT keep alive interval in seconds.
+ */
+#define MQTT_KEEPALIVE              60
+
+/**
+ * \brief Size in bytes of each of the packet buffers of MQTTClient.
+ */
+#define MQTT_BUFFER_SIZE            128
+
+/**
+ * \brief Time in milliseconds the MQTT broker has to accept a connection.
+ */
+#define MQTT_CONNECT_TIMEOUT        5000
+
+/**
+ * \brief Time in milliseconds after which an unacknowledged QoS 1 message is
+ * sent again.
+ */
+#define MQTT_RETRY_INTERVAL         5000
+
+/**
+ * \brief Time in milliseconds between attempts to connect to the MQTT broker.
+ */
+#define MQTT_RECONNECT_INTERVAL     30000
+
+/**
+ * \brief Interval in milliseconds in which changed sensor readings and
+ * actuator states are published.
+ */
+#define MQTT_PUBLISH_INTERVAL       1000
+
+/**
+ * \brief Change in milli-units a sensor reading needs to be published again.
+ */
+#define MQTT_SENSOR_DEADBAND        0
+
+/**
+ * \brief Enables the HTTPServer serving the pages stored on the SD card and
+ * the JSON API. It takes one of the four sockets of the W5100 and needs
+ * #HTTPSERVER_BLOCK_SIZE bytes of stack while sending a page.
+ */
+#undef USE_HTTPSERVER
+
+/**
+ * \brief TCP port of the HTTPServer.
+ */
+#define HTTPSERVER_PORT             80
+
+/**
+ * \brief Folder on the SD card containing the pages. Gzip compressed copies
+ * of the pages are expected in the subfolder gz (see make www).
+ */
+#define HTTPSERVER_ROOT             "/www"
+
+/**
+ * \brief Number of bytes of a page sent per call of HTTPServer::run. Matches
+ * the block size of the SD card.
+ */
+#define HTTPSERVER_BLOCK_SIZE       512
+
+/**
+ * \brief Maximum length of the path of a request.
+ */
+#define HTTPSERVER_PATH_LENGTH      32
+
+/**
+ * \brief Maximum length of a request header line evaluated by the HTTPServer.
+ * Longer lines are truncated.
+ */
+#define HTTPSERVER_LINE_LENGTH      48
+
+/**
+ * \brief Time in milliseconds a client has to send its request headers.
+ */
+#define HTTPSERVER_REQUEST_TIMEOUT  2000
+
+/**
+ * \brief Number of dashboards remembered by the GUIServer as base for the
+ * delta encoding of protocol version 3. Two allow one lost reply.
+ */
+#define GUI_SNAPSHOTS               2
+
 /**
  * \brief Defines the delimiter in URLs to mark the beginning of a subURL
  */
@@ -92,10 +278,133 @@
 #define MAX_ONEWIRE_DEVICES         8
 
 /**
- * \brief Defines the number of temperature values kept in a history to
- * smoothen temperature sensor readings.
+ * \brief Defines the maximum number of OneWire devices kept in the inventory
+ * of OneWireHandler
+ */
+#define MAX_ONEWIRE_INVENTORY       16
+
+/**
+ * \brief Time in milliseconds a temperature conversion broadcast on a OneWire
+ * bus needs to complete at 12 bit resolution. Lower resolutions halve the time
+ * per bit.
+ */
+#define ONEWIRE_CONVERSION_TIME     750
+
+/**
+ * \brief Enables the timer driven OneWire transactions of OneWireAsync. The
+ * slots are clocked by the compare match interrupt of Timer1. PWM on pins 11
+ * and 12 is not available when enabled.
+ */
+#undef ONEWIRE_ASYNC
+
+/**
+ * \brief Size of the transaction buffer of OneWireAsync in bytes. Holds the
+ * bytes sent followed by the bytes received.
+ */
+#define ONEWIRE_ASYNC_BUFFER_SIZE   20
+
+/**
+ * \brief Defines the maximum length of a line received by SerialLineParser
+ * including the terminating null character. Longer lines are dropped.
+ */
+#define SERIAL_LINE_LENGTH          32
+
+/**
+ * \brief Number of commands that can be queued per Atlas Scientific UART
+ */
+#define ATLAS_QUEUE_LENGTH          4
+
+/**
+ * \brief Maximum length of a command sent to an Atlas Scientific circuit
+ * including the terminating null character.
+ */
+#define ATLAS_COMMAND_LENGTH        12
+
+/**
+ * \brief Time in milliseconds to wait for the response of an Atlas
+ * Scientific circuit.
+ */
+#define ATLAS_RESPONSE_TIMEOUT      1500
+
+/**
+ * \brief Time in milliseconds between two readings of an Atlas Scientific
+ * sensor.
+ */
+#define ATLAS_READ_INTERVAL         2000
+
+/**
+ * \brief Time in milliseconds between two temperature compensated readings of
+ * pH and EC sensors.
+ */
+#define ATLAS_TEMPCOMP_INTERVAL     60000
+
+/**
+ * \brief UART (1 - 3) an Atlas Scientific serial port expander is attached
+ * to. 0 if there is none. The channel of the expander is selected by the
+ * pins #ATLAS_EXPANDER_S1, #ATLAS_EXPANDER_S2 and #ATLAS_EXPANDER_S3.
+ */
+#define ATLAS_EXPANDER_UART         0
+#define ATLAS_EXPANDER_S1           22
+#define ATLAS_EXPANDER_S2           23
+#define ATLAS_EXPANDER_S3           24
+
+/**
+ * \brief Maximum window length of the moving average of SensorFilter. The
+ * samples are kept in every sensor object.
+ */
+#define SENSOR_FILTER_WINDOW        10
+
+/**
+ * \brief Maximum window length of the median of SensorFilter. Must not
+ * exceed #SENSOR_FILTER_WINDOW.
+ */
+#define SENSOR_FILTER_MEDIAN_WINDOW 5
+
+/**
+ * \brief Number of edges kept by an interrupt driven DigitalInput.
+ */
+#define DIGITALINPUT_EDGE_BUFFER    8
+
+/**
+ * \brief Time in milliseconds without a pulse after which the pulse rate of
+ * a DigitalInput drops to zero.
+ */
+#define DIGITALINPUT_RATE_TIMEOUT   10000
+
+/**
+ * \brief Interval in milliseconds in which a FlowSensor converts its pulses
+ * to rate and volume.
+ */
+#define FLOW_RATE_INTERVAL          1000
+
+/**
+ * \brief Interval in milliseconds in which a FlowSensor writes its changed
+ * cumulative volume to the configuration.
+ */
+#define FLOW_PERSIST_INTERVAL       3600000UL
+
+/**
+ * \brief Maximum number of AnalogInput sensors converted by the ADC.
+ */
+#define ANALOGINPUT_MAX_INPUTS      4
+
+/**
+ * \brief Additional bits of resolution gained by oversampling an AnalogInput.
+ * 4^n conversions are decimated to one value. Must not exceed 3.
+ */
+#define ANALOGINPUT_OVERSAMPLE_BITS 2
+
+/**
+ * \brief Number of decimated values buffered per AnalogInput.
+ */
+#define ANALOGINPUT_BUFFER          8
+
+/**
+ * \brief Passes sensor readings as integer milli-units instead of double
+ * from the sensors through Aquaduino to the controllers. Undefine to use the
+ * floating point path.
  */
-#define TEMP_HISTORY                10
+#define FIXED_POINT_SENSORS
 
 /**
  * \brief Enables/Disabled Interrupt driven mode. Note concurrent HW accesses
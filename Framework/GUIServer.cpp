@@ -7,42 +7,58 @@
 
 #include <Framework/Aquaduino.h>
 #include <Framework/GUIServer.h>
+#include <Framework/ObjectFactory.h>
 #include <Arduino.h>
+#include <avr/pgmspace.h>
+#ifdef USE_CONTROLLER_CLOCKTIMER
 #include <Controller/ClockTimerController.h>
+#endif
+#ifdef USE_CONTROLLER_TEMPERATURE
 #include <Controller/TemperatureController.h>
+#endif
+#ifdef USE_CONTROLLER_LEVEL
 #include <Controller/LevelController.h>
-#include <Actuators/DigitalOutput.h>
-#include <Sensors/DS18S20.h>
+#endif
+#ifdef USE_SENSOR_DIGITALINPUT
 #include <Sensors/DigitalInput.h>
+#endif
+#ifdef USE_SENSOR_DS18S20
+#include <Sensors/DS18S20.h>
+#endif
+#if defined(USE_SENSOR_SERIALATLASPH) || defined(USE_SENSOR_SERIALATLASEC) \
+	|| defined(USE_SENSOR_SERIALATLASORP)
+#include <Sensors/SerialAtlasSensor.h>
+#endif
+#ifdef USE_SENSOR_FLOW
+#include <Sensors/FlowSensor.h>
+#endif
+#ifdef USE_SENSOR_ANALOGINPUT
+#include <Sensors/AnalogInput.h>
+#endif
 #include <OneWireHandler.h>
 
-enum {
-	GET_VERSION = 0,
-	GET_ALL_SENSORS = 1,
-	GET_SENSOR_DATA = 2,
-	SET_SENSOR_CONFIG = 3,
-	GET_ALL_ACTUATORS = 4,
-	GET_ACTUATOR_DATA = 5,
-	SET_ACTUATOR_DATA = 6,
-	SET_ACTUATOR_CONFIG = 7,
-	GET_ALL_CONTROLLERS = 8,
-	GET_CLOCK_TIMERS = 9,
-	SET_CLOCK_TIMER = 10,
-	GET_TEMPSENSORS_AT_PIN = 11,
-	SET_TEMPSENSOR_AT_PIN = 12,
-	GET_TEMPERATURE_CONTROLLER = 13,
-	SET_TEMPERATURE_CONTROLLER = 14,
-	GET_LEVEL_CONTROLLER = 15,
-	SET_LEVEL_CONTROLLER = 16,
-	RESET_LEVEL_CONTROLLER = 17,
-	SET_LEVEL_CONTROLLER_NAME = 18,
-	SET_TEMPERATURE_CONTROLLER_NAME = 19,
-	GET_DS1820_ADDRESSES = 20,
-	SET_DS1820_ADDRESS = 21
-};
+/*
+ * Highest protocol version. Clients announce the version they support in the
+ * first argument of GET_VERSION. Older clients not doing so get version 2.
+ */
+#define GUI_PROTOCOL_VERSION 3
+
+#if GUI_SNAPSHOTS < 2
+#error "GUI_SNAPSHOTS needs to be at least 2"
+#endif
+
+/*
+ * GET_DASHBOARD keeps one bit per sensor and actuator in 32 bit masks.
+ */
+#if MAX_SENSORS > 32 || MAX_ACTUATORS > 32
+#error "GET_DASHBOARD supports at most 32 sensors and 32 actuators"
+#endif
 
 GUIServer::GUIServer(uint16_t port) {
 	m_Port = port;
+	m_Length = 0;
+	m_Sequence = 0;
+	memset(m_Snapshots, 0, sizeof(m_Snapshots));
 	m_UdpServer.begin(m_Port);
 	Serial.println("GUIServer Start");
 }
@@ -59,7 +75,8 @@ int8_t GUIServer::receiveCommand() {
 	Serial.print(m_UdpServer.available());
 	Serial.print(F(" Bytes available. "));
 	Serial.print(F("Got "));
-	Serial.print(m_UdpServer.read(m_Buffer, sizeof(m_Buffer)));
+	m_Length = m_UdpServer.read(m_Buffer, sizeof(m_Buffer));
+	Serial.print(m_Length);
 	Serial.println(F(" Bytes"));
 	return 1;
 }
@@ -89,7 +106,10 @@ void GUIServer::run() {
 		switch (m_Buffer[1]) {
 		case GET_VERSION:
 			m_UdpServer.write((uint8_t) 0);
-			m_UdpServer.write(2);
+			if (m_Length > 2 && m_Buffer[2] >= GUI_PROTOCOL_VERSION)
+				m_UdpServer.write(GUI_PROTOCOL_VERSION);
+			else
+				m_UdpServer.write(2);
 			break;
 		case GET_ALL_SENSORS:
 			getAllSensors();
@@ -100,6 +120,9 @@ void GUIServer::run() {
 		case SET_SENSOR_CONFIG:
 			setSensorConfig(m_Buffer[2]);
 			break;
+		case GET_SENSOR_FILTER:
+			getSensorFilter(m_Buffer[2]);
+			break;
 		case GET_ALL_ACTUATORS:
 			getAllActuators();
 			break;
@@ -115,47 +138,59 @@ void GUIServer::run() {
 		case GET_ALL_CONTROLLERS:
 			getAllControllers();
 			break;
-		case GET_CLOCK_TIMERS:
-			getClockTimers(m_Buffer[2]);
-			break;
-		case SET_CLOCK_TIMER:
-			setClockTimer(m_Buffer[2]);
-			break;
-		case GET_TEMPERATURE_CONTROLLER:
-			getTemperatureController(m_Buffer[2]);
-			break;
-		case SET_TEMPERATURE_CONTROLLER:
-			setTemperatureController(m_Buffer[2]);
-			break;
-		case SET_TEMPERATURE_CONTROLLER_NAME:
-			setTemperatureControllerName(m_Buffer[2]);
-			break;
-		case GET_LEVEL_CONTROLLER:
-			getLevelController(m_Buffer[2]);
-			break;
-		case SET_LEVEL_CONTROLLER:
-			setLevelController(m_Buffer[2]);
+		case GET_DASHBOARD:
+			getDashboard();
 			break;
-		case RESET_LEVEL_CONTROLLER:
-			resetLevelController(m_Buffer[2]);
-			break;
-		case SET_LEVEL_CONTROLLER_NAME:
-			setLevelControllerName(m_Buffer[2]);
+		case GET_OBJECTS:
+			getObjects();
 			break;
+#ifdef USE_SENSOR_DS18S20
 		case GET_DS1820_ADDRESSES:
 			getDS1820Addresses();
 			break;
-		case SET_DS1820_ADDRESS:
-			setDS1820Address(m_Buffer[2]);
-			break;
-
+#endif
 		default:
+			dispatch(m_Buffer[1], m_Buffer[2]);
 			break;
 		}
 		m_UdpServer.endPacket();
 	}
 
 }
+
+/**
+ * \brief Dispatches type specific requests.
+ * \param[in] method Method ID of the request.
+ * \param[in] objectId ID of the addressed controller, sensor or actuator.
+ *
+ * The handlers are registered together with the types in the ObjectFactory
+ * and looked up by ObjectFactory::lookupHandler. A handler is only called
+ * when the addressed object has the registered type. Otherwise errorcode 10
+ * is returned. A method no type registered gets an empty reply.
+ */
+void GUIServer::dispatch(uint8_t method, uint8_t objectId) {
+	GUIHandlerEntry entry;
+	uint8_t kind;
+	int16_t type;
+	Object* object;
+
+	if (!ObjectFactory::lookupHandler(method, &kind, &type, &entry))
+		return;
+
+	if (kind == FACTORY_CONTROLLERS)
+		object = __aquaduino->getController(objectId);
+	else if (kind == FACTORY_SENSORS)
+		object = __aquaduino->getSensor(objectId);
+	else
+		object = __aquaduino->getActuator(objectId);
+
+	if (object != NULL && object->getType() == type) {
+		(this->*entry.handler)(object, objectId);
+	} else {
+		//errorcode 10
+		m_UdpServer.write((uint8_t) 10);
+	}
+}
 void changeActuatorAssignment(int8_t oldActuatorID, int8_t newActuatorID,
 		int8_t controllerID) {
 	Serial.print("changeActuatorAssignement: ");
@@ -226,8 +261,7 @@ void GUIServer::getSensorData(uint8_t sensorId) {
 		m_UdpServer.write(sensorId);
 
 		//valueAct:float * 1000 -> uint32
-		//write((uint32_t) (__aquaduino->getSensorValue(sensorId) * 1000),&m_UdpServer);
-		uint32_t tmp = __aquaduino->getSensorValue(sensorId) * 1000;
+		uint32_t tmp = __aquaduino->getSensorMilliValue(sensorId);
 		m_UdpServer.write((uint8_t*) &tmp, sizeof(int32_t));
 
 		//lastCalibration:dateTime
@@ -281,6 +315,17 @@ void GUIServer::setSensorConfig(uint8_t sensorId) {
 			//errorcode 100 not implemented yet
 			m_UdpServer.write((uint8_t) 100);
 		}
+		if (type == 6) {
+			//filter mode, filter parameter
+			if (sensor->getFilter()->configure(m_Buffer[4], m_Buffer[5])) {
+				//errorcode 10 -> filter not available
+				m_UdpServer.write((uint8_t) 10);
+				return;
+			}
+			__aquaduino->writeConfig(sensor);
+			//errorcode 0
+			m_UdpServer.write((uint8_t) 0);
+		}
 	} else {
 		//errorcode 10 -> actuator not available
 		m_UdpServer.write((uint8_t) 10);
@@ -289,6 +334,26 @@ void GUIServer::setSensorConfig(uint8_t sensorId) {
 
 }
 
+void GUIServer::getSensorFilter(uint8_t sensorId) {
+	Sensor* sensor = __aquaduino->getSensor(sensorId);
+
+	if (sensor) {
+		//errorcode 0
+		m_UdpServer.write((uint8_t) 0);
+		//sensorId
+		m_UdpServer.write(sensorId);
+		//filter mode
+		m_UdpServer.write(sensor->getFilter()->getMode());
+		//filter parameter
+		m_UdpServer.write(sensor->getFilter()->getParameter());
+		//significant decimals of the value
+		m_UdpServer.write(sensor->getDecimals());
+	} else {
+		//errorcode 10 -> sensor not available
+		m_UdpServer.write((uint8_t) 10);
+	}
+}
+
 ////////////////////////////////
 //Actuator
 ////////////////////////////////
@@ -392,9 +457,7 @@ void GUIServer::setActuatorConfig(uint8_t actuatorId) {
 	}
 }
 void GUIServer::setActuatorData(uint8_t actuatorId) {
-	//Actuator* actuator = __aquaduino->getActuator(actuatorId);
-	DigitalOutput* actuator = (DigitalOutput*) __aquaduino->getActuator(
-			actuatorId);
+	Actuator* actuator = __aquaduino->getActuator(actuatorId);
 
 	if (actuator) {
 		uint8_t locked = m_Buffer[3];
@@ -445,6 +508,228 @@ void GUIServer::getAllControllers() {
 		m_UdpServer.write(controller->getType());
 	}
 }
+///////////////////////////
+//Protocol version 3
+///////////////////////////
+
+/**
+ * \brief Zigzag encoding mapping small negative and positive numbers to
+ * small unsigned numbers.
+ */
+static uint32_t zigzag(int32_t value) {
+	return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+/**
+ * \brief Writes an unsigned LEB128 varint: 7 bits per byte, least
+ * significant group first, MSB set on all but the last byte.
+ * \param[in] value Value to write.
+ */
+void GUIServer::writeVarint(uint32_t value) {
+	uint8_t buffer[5];
+	uint8_t length = 0;
+
+	while (value >= 0x80) {
+		buffer[length++] = (uint8_t) value | 0x80;
+		value >>= 7;
+	}
+	buffer[length++] = value;
+	m_UdpServer.write(buffer, length);
+}
+
+/**
+ * \brief Writes a string as varint length followed by the characters.
+ * \param[in] s String to write.
+ */
+void GUIServer::writeString(const char* s) {
+	uint8_t length = strlen(s);
+
+	writeVarint(length);
+	m_UdpServer.write((const uint8_t*) s, length);
+}
+
+/**
+ * \brief Writes a string stored in PROGMEM as varint length followed by the
+ * characters.
+ * \param[in] s String to write.
+ */
+void GUIServer::writeString(const __FlashStringHelper* s) {
+	writeVarint(strlen_P((PGM_P) s));
+	m_UdpServer.print(s);
+}
+
+/**
+ * \brief Sends the values of all sensors and actuators (protocol version 3).
+ *
+ * Request argument: varint sequence number of the last dashboard the client
+ * received, 0 if none.
+ *
+ * Reply: errorcode, varint sequence number of this dashboard, varint
+ * sequence number of the base or 0, varint presence mask of the sensors,
+ * varint mask of the changed sensors, one zigzag varint per changed sensor,
+ * varint presence mask of the actuators, varint mask of the changed
+ * actuators and one varint per changed actuator.
+ *
+ * If the acknowledged dashboard is one of the last #GUI_SNAPSHOTS sent, only
+ * changes against it are sent. The client applies them to its copy of that
+ * dashboard: a sensor value is the milli-value of the base plus the
+ * difference, an actuator value replaces the one of the base. Otherwise the
+ * base is 0 and the reply holds all values of present objects as difference
+ * to 0. Absent objects have the value 0. Actuator values are on (bit 0),
+ * locked (bit 1) and the duty cycle in per mille (bits 2 and up).
+ *
+ * Worst case with all #MAX_SENSORS (8) and #MAX_ACTUATORS (24) present and
+ * changed, including method and request ID: 2 + 1 errorcode + 3 + 3
+ * sequence numbers + 2 + 2 sensor masks + 8 * 5 sensor differences + 4 + 4
+ * actuator masks + 24 * 2 actuator states (at most 4003) = 109 bytes, which
+ * fits into one datagram.
+ */
+void GUIServer::getDashboard() {
+	uint32_t acked = 0;
+	uint32_t changedSensors = 0;
+	uint32_t changedActuators = 0;
+	GUISnapshot* base = NULL;
+	GUISnapshot* current = NULL;
+	Sensor* sensor;
+	Actuator* actuator;
+	uint16_t state;
+	uint8_t shift = 0;
+	uint8_t i;
+
+	//acknowledged sequence number:varint
+	for (i = 2; i < m_Length && shift < 32; i++, shift += 7) {
+		acked |= (uint32_t) (m_Buffer[i] & 0x7F) << shift;
+		if (!(m_Buffer[i] & 0x80))
+			break;
+	}
+
+	for (i = 0; i < GUI_SNAPSHOTS; i++) {
+		if (acked != 0 && m_Snapshots[i].sequence == acked)
+			base = &m_Snapshots[i];
+	}
+
+	//replace the oldest snapshot except the base
+	for (i = 0; i < GUI_SNAPSHOTS; i++) {
+		if (&m_Snapshots[i] == base)
+			continue;
+		if (current == NULL || m_Snapshots[i].sequence == 0
+				|| (uint16_t) (m_Sequence - m_Snapshots[i].sequence)
+						> (uint16_t) (m_Sequence - current->sequence))
+			current = &m_Snapshots[i];
+		if (current->sequence == 0)
+			break;
+	}
+
+	if (++m_Sequence == 0)
+		m_Sequence = 1;
+	current->sequence = m_Sequence;
+	current->sensors = 0;
+	current->actuators = 0;
+
+	for (i = 0; i < MAX_SENSORS; i++) {
+		sensor = __aquaduino->getSensor(i);
+		current->sensorValues[i] = 0;
+		if (sensor) {
+			current->sensors |= 1UL << i;
+			current->sensorValues[i] = __aquaduino->getSensorMilliValue(i);
+		}
+		if (base == NULL ?
+				sensor != NULL :
+				current->sensorValues[i] != base->sensorValues[i])
+			changedSensors |= 1UL << i;
+	}
+
+	for (i = 0; i < MAX_ACTUATORS; i++) {
+		actuator = __aquaduino->getActuator(i);
+		state = 0;
+		if (actuator) {
+			current->actuators |= 1UL << i;
+			if (actuator->supportsPWM())
+				state = (uint16_t) (actuator->getPWM() * 1000 + 0.5) << 2;
+			if (actuator->isLocked())
+				state |= 2;
+			if (actuator->isOn())
+				state |= 1;
+		}
+		current->actuatorStates[i] = state;
+		if (base == NULL ?
+				actuator != NULL : state != base->actuatorStates[i])
+			changedActuators |= 1UL << i;
+	}
+
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	writeVarint(current->sequence);
+	writeVarint(base ? base->sequence : 0);
+
+	writeVarint(current->sensors);
+	writeVarint(changedSensors);
+	for (i = 0; i < MAX_SENSORS; i++) {
+		if (changedSensors & (1UL << i))
+			writeVarint(
+					zigzag(current->sensorValues[i]
+							- (base ? base->sensorValues[i] : 0)));
+	}
+
+	writeVarint(current->actuators);
+	writeVarint(changedActuators);
+	for (i = 0; i < MAX_ACTUATORS; i++) {
+		if (changedActuators & (1UL << i))
+			writeVarint(current->actuatorStates[i]);
+	}
+}
+
+/**
+ * \brief Sends the metadata of all objects (protocol version 3).
+ *
+ * Reply: errorcode, then varint number of sensors and per sensor its ID,
+ * name, type, unit, significant decimals, filter mode and filter parameter,
+ * varint number of actuators and per actuator its ID, name, type, PWM
+ * support and assigned controller (0xFF if none), varint number of
+ * controllers and per controller its ID, name and type. Strings are varint
+ * length and characters. All other fields are single bytes.
+ *
+ * At the maximum number of objects with names of maximum length the reply
+ * is about 1 KiB and fits into one datagram.
+ */
+void GUIServer::getObjects() {
+	Sensor* sensor;
+	Actuator* actuator;
+	Controller* controller;
+
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+
+	writeVarint(__aquaduino->getNrOfSensors());
+	__aquaduino->resetSensorIterator();
+	while (__aquaduino->getNextSensor(&sensor) != -1) {
+		m_UdpServer.write(__aquaduino->getSensorID(sensor));
+		writeString(sensor->getName());
+		m_UdpServer.write(sensor->getType());
+		writeString(sensor->getUnit());
+		m_UdpServer.write(sensor->getDecimals());
+		m_UdpServer.write(sensor->getFilter()->getMode());
+		m_UdpServer.write(sensor->getFilter()->getParameter());
+	}
+
+	writeVarint(__aquaduino->getNrOfActuators());
+	__aquaduino->resetActuatorIterator();
+	while (__aquaduino->getNextActuator(&actuator) != -1) {
+		m_UdpServer.write(__aquaduino->getActuatorID(actuator));
+		writeString(actuator->getName());
+		m_UdpServer.write(actuator->getType());
+		m_UdpServer.write((uint8_t) (actuator->supportsPWM() ? 1 : 0));
+		m_UdpServer.write(actuator->getController());
+	}
+
+	writeVarint(__aquaduino->getNrOfControllers());
+	__aquaduino->resetControllerIterator();
+	while (__aquaduino->getNextController(&controller) != -1) {
+		m_UdpServer.write(__aquaduino->getControllerID(controller));
+		writeString(controller->getName());
+		m_UdpServer.write(controller->getType());
+	}
+}
 /*
  void GUIServer::setSerialPHConfig(uint8_t sensorId,uint8_t) {
  Sensor* sensor = __aquaduino->getSensor(sensorId);
@@ -462,17 +747,9 @@ void GUIServer::getAllControllers() {
  }
  }*/
 
-void GUIServer::getClockTimers(uint8_t controllerId) {
-	ClockTimerController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_CLOCKTIMER) {
-		controller = (ClockTimerController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+#ifdef USE_CONTROLLER_CLOCKTIMER
+void GUIServer::getClockTimers(Object* object, uint8_t controllerId) {
+	ClockTimerController* controller = (ClockTimerController*) object;
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 	//controllerId
@@ -501,18 +778,9 @@ void GUIServer::getClockTimers(uint8_t controllerId) {
 		i++;
 	}
 }
-void GUIServer::setClockTimer(uint8_t controllerId) {
-	ClockTimerController* controller;
+void GUIServer::setClockTimer(Object* object, uint8_t controllerId) {
+	ClockTimerController* controller = (ClockTimerController*) object;
 	ClockTimer* timer;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_CLOCKTIMER) {
-		controller = (ClockTimerController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
 	if (controller->getClockTimer(m_Buffer[3])) {
 		timer = controller->getClockTimer(m_Buffer[3]);
 	} else {
@@ -559,19 +827,12 @@ void GUIServer::setClockTimer(uint8_t controllerId) {
 
 	return;
 }
+#endif
 ////////////////////////////
 // Temperature Controller
-void GUIServer::getTemperatureController(uint8_t controllerId) {
-	TemperatureController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_TEMPERATURE) {
-		controller = (TemperatureController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+#ifdef USE_CONTROLLER_TEMPERATURE
+void GUIServer::getTemperatureController(Object* object, uint8_t controllerId) {
+	TemperatureController* controller = (TemperatureController*) object;
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 	//Sensor
@@ -593,17 +854,8 @@ void GUIServer::getTemperatureController(uint8_t controllerId) {
 	//coolingActuaor
 	m_UdpServer.write(controller->getCoolingActuator());
 }
-void GUIServer::setTemperatureController(uint8_t controllerId) {
-	TemperatureController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_TEMPERATURE) {
-		controller = (TemperatureController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+void GUIServer::setTemperatureController(Object* object, uint8_t controllerId) {
+	TemperatureController* controller = (TemperatureController*) object;
 	double tmp1 = *((int16_t*) &m_Buffer[3]);
 	//Serial.print("low: ");
 	//Serial.println(tmp1);
@@ -652,36 +904,21 @@ void GUIServer::setTemperatureController(uint8_t controllerId) {
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 }
-void GUIServer::setTemperatureControllerName(uint8_t controllerId) {
-	TemperatureController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_TEMPERATURE) {
-		controller = (TemperatureController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+void GUIServer::setTemperatureControllerName(Object* object,
+		uint8_t controllerId) {
+	TemperatureController* controller = (TemperatureController*) object;
 	controller->setName((char*) &m_Buffer[3]);
 	__aquaduino->writeConfig(controller);
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 }
+#endif
 //////////////////////
 // LevelController
+#ifdef USE_CONTROLLER_LEVEL
 
-void GUIServer::getLevelController(uint8_t controllerId) {
-	LevelController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_LEVEL) {
-		controller = (LevelController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+void GUIServer::getLevelController(Object* object, uint8_t controllerId) {
+	LevelController* controller = (LevelController*) object;
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 	//delayHigh
@@ -711,17 +948,8 @@ void GUIServer::getLevelController(uint8_t controllerId) {
 	m_UdpServer.write(controller->getState());
 
 }
-void GUIServer::setLevelController(uint8_t controllerId) {
-	LevelController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_LEVEL) {
-		controller = (LevelController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+void GUIServer::setLevelController(Object* object, uint8_t controllerId) {
+	LevelController* controller = (LevelController*) object;
 	controller->setDelayHigh(*((int16_t*) &m_Buffer[3]));
 	controller->setDelayLow(*((int16_t*) &m_Buffer[5]));
 	controller->setTimeout(*((int16_t*) &m_Buffer[7]));
@@ -782,88 +1010,237 @@ void GUIServer::setLevelController(uint8_t controllerId) {
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 }
-void GUIServer::setLevelControllerName(uint8_t controllerId) {
-	LevelController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_LEVEL) {
-		controller = (LevelController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+void GUIServer::setLevelControllerName(Object* object, uint8_t controllerId) {
+	LevelController* controller = (LevelController*) object;
 
 	controller->setName((char*) &m_Buffer[3]);
 	__aquaduino->writeConfig(controller);
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 }
-void GUIServer::resetLevelController(uint8_t controllerId) {
-	LevelController* controller;
-	if (__aquaduino->getController(controllerId)->getType()
-			== CONTROLLER_LEVEL) {
-		controller = (LevelController*) __aquaduino->getController(
-				controllerId);
-	} else {
-		//errorcode 10
-		m_UdpServer.write((uint8_t) 10);
-		return;
-	}
+void GUIServer::resetLevelController(Object* object, uint8_t controllerId) {
+	LevelController* controller = (LevelController*) object;
 	controller->reset();
 	//something to save?
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
 }
+#endif
 /////////////////////////////////////
 // Sensor
 /////////////////////////////////////
 //
 // DS1820
+#ifdef USE_SENSOR_DS18S20
+/**
+ * \brief Sends the OneWire device inventory.
+ *
+ * Reply: errorcode, number of devices and per device the pin of its bus, the
+ * 8 byte ROM ID (family code first) and the seconds since it was seen last.
+ */
 void GUIServer::getDS1820Addresses() {
-	/*DS18S20* sensor;
-	 if (__aquaduino->getSensor(sensorId)->getType() == SENSOR_DS18S20) {
-	 sensor = (DS18S20*) __aquaduino->getSensor(sensorId);
-	 } else {
-	 //errorcode 10
-	 m_UdpServer.write((uint8_t) 10);
-	 m_UdpServer.write(__aquaduino->getSensor(sensorId)->getType());
-	 return;
-	 }*/
+	OneWireHandler* onewire = __aquaduino->getOneWireHandler();
+	const OneWireDevice* device;
+	unsigned long age;
+	uint16_t seconds;
+	uint8_t i = 0;
+
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	//num of devices
+	m_UdpServer.write(onewire->getNrOfDevices());
+
+	while ((device = onewire->getDevice(i++)) != NULL) {
+		//pin
+		m_UdpServer.write(onewire->getPin(device->bus));
+		//address
+		m_UdpServer.write(device->address, sizeof(device->address));
+		//seconds since last seen:uint16
+		age = (millis() - device->lastSeen) / 1000;
+		seconds = age > 0xFFFF ? 0xFFFF : age;
+		m_UdpServer.write((uint8_t*) &seconds, sizeof(seconds));
+	}
+}
+void GUIServer::setDS1820Address(Object* object, uint8_t sensorId) {
+	DS18S20* sensor = (DS18S20*) object;
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
-	//
-	OneWireHandler* onewire = __aquaduino->getOneWireHandler();
 	uint8_t addr[8];
-	onewire->findDevice(0, addr, 8);
-
-	//uint8_t addr[8];
-	// sensor->getAddress(addr);
 	uint8_t i = 0;
 	while (i < 8) {
-		m_UdpServer.write(addr[i]);
+		addr[i] = m_Buffer[i + 3];
 		i++;
 	}
+	sensor->setAddress(addr);
+	__aquaduino->writeConfig(sensor);
+
 }
-void GUIServer::setDS1820Address(uint8_t sensorId) {
-	DS18S20* sensor;
-	if (__aquaduino->getSensor(sensorId)->getType() == SENSOR_DS18S20) {
-		sensor = (DS18S20*) __aquaduino->getSensor(sensorId);
+void GUIServer::getDS1820Resolution(Object* object, uint8_t sensorId) {
+	DS18S20* sensor = (DS18S20*) object;
+	uint8_t resolution = sensor->getResolution();
+	uint16_t time = OneWireHandler::getConversionTime(resolution);
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	//sensorId
+	m_UdpServer.write(sensorId);
+	//resolution in bits
+	m_UdpServer.write(resolution);
+	//conversion time in ms:uint16
+	m_UdpServer.write((uint8_t*) &time, sizeof(time));
+}
+void GUIServer::setDS1820Resolution(Object* object, uint8_t sensorId) {
+	DS18S20* sensor = (DS18S20*) object;
+	if (m_Buffer[3] < 9 || m_Buffer[3] > 12) {
+		//errorcode 10 -> resolution not available
+		m_UdpServer.write((uint8_t) 10);
+		return;
+	}
+	sensor->setResolution(m_Buffer[3]);
+	__aquaduino->writeConfig(sensor);
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+}
+#endif
+// Digital Input
+#ifdef USE_SENSOR_DIGITALINPUT
+void GUIServer::getDigitalInputConfig(Object* object, uint8_t sensorId) {
+	DigitalInput* sensor = (DigitalInput*) object;
+	uint32_t tmp;
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	//sensorId
+	m_UdpServer.write(sensorId);
+	//interrupt driven
+	m_UdpServer.write(sensor->isInterruptDriven());
+	//debounce time in ms
+	m_UdpServer.write(sensor->getDebounce());
+	//edges:uint32
+	tmp = sensor->getEdgeCount();
+	m_UdpServer.write((uint8_t*) &tmp, sizeof(tmp));
+	//pulses:uint32
+	tmp = sensor->getPulseCount();
+	m_UdpServer.write((uint8_t*) &tmp, sizeof(tmp));
+	//pulses per minute * 1000:uint32
+	tmp = sensor->getPulseRate();
+	m_UdpServer.write((uint8_t*) &tmp, sizeof(tmp));
+}
+void GUIServer::setDigitalInputConfig(Object* object, uint8_t sensorId) {
+	DigitalInput* sensor = (DigitalInput*) object;
+	if (m_Buffer[3]) {
+		if (sensor->enableInterrupt(m_Buffer[4])) {
+			//errorcode 10 -> pin has no pin change interrupt
+			m_UdpServer.write((uint8_t) 10);
+			return;
+		}
 	} else {
-		//errorcode 10
+		sensor->disableInterrupt();
+	}
+	__aquaduino->writeConfig(sensor);
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+}
+#endif
+// Atlas Scientific
+#if defined(USE_SENSOR_SERIALATLASPH) || defined(USE_SENSOR_SERIALATLASEC) \
+	|| defined(USE_SENSOR_SERIALATLASORP)
+void GUIServer::getSerialAtlasConfig(Object* object, uint8_t sensorId) {
+	SerialAtlasSensor* sensor = (SerialAtlasSensor*) object;
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	//sensorId
+	m_UdpServer.write(sensorId);
+	//probe type
+	m_UdpServer.write(sensor->getProbe());
+	//UART
+	m_UdpServer.write(sensor->getUart());
+	//port expander channel
+	m_UdpServer.write(sensor->getChannel());
+}
+void GUIServer::setSerialAtlasConfig(Object* object, uint8_t sensorId) {
+	SerialAtlasSensor* sensor = (SerialAtlasSensor*) object;
+	if (sensor->setPort(m_Buffer[3], m_Buffer[4])) {
+		//errorcode 10 -> port not available
 		m_UdpServer.write((uint8_t) 10);
-		m_UdpServer.write(__aquaduino->getSensor(sensorId)->getType());
 		return;
 	}
+	__aquaduino->writeConfig(sensor);
 	//errorcode 0
 	m_UdpServer.write((uint8_t) 0);
-	uint8_t addr[8];
-	uint8_t i = 0;
-	while (i < 8) {
-		addr[i] = m_Buffer[i + 3];
-		i++;
+}
+void GUIServer::calibrateSerialAtlas(Object* object, uint8_t sensorId) {
+	SerialAtlasSensor* sensor = (SerialAtlasSensor*) object;
+	m_Buffer[sizeof(m_Buffer) - 1] = 0;
+	if (sensor->calibrate((const char*) &m_Buffer[3])) {
+		//errorcode 10 -> queue full
+		m_UdpServer.write((uint8_t) 10);
+		return;
 	}
-	sensor->setAddress(addr);
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+}
+#endif
+// Flow Sensor
+#ifdef USE_SENSOR_FLOW
+void GUIServer::getFlowSensor(Object* object, uint8_t sensorId) {
+	FlowSensor* sensor = (FlowSensor*) object;
+	uint32_t tmp;
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	//sensorId
+	m_UdpServer.write(sensorId);
+	//micro-units per pulse:uint32
+	tmp = sensor->getCalibration();
+	m_UdpServer.write((uint8_t*) &tmp, sizeof(tmp));
+	//volume in milli-units:uint32
+	tmp = sensor->getVolume();
+	m_UdpServer.write((uint8_t*) &tmp, sizeof(tmp));
+	//pulses:uint32
+	tmp = sensor->getPulseCount();
+	m_UdpServer.write((uint8_t*) &tmp, sizeof(tmp));
+}
+void GUIServer::setFlowSensor(Object* object, uint8_t sensorId) {
+	FlowSensor* sensor = (FlowSensor*) object;
+	//micro-units per pulse:uint32, 0 keeps the calibration
+	uint32_t microPerPulse = *((uint32_t*) &m_Buffer[3]);
+	if (microPerPulse)
+		sensor->setCalibration(microPerPulse);
+	//reset volume:uint8
+	if (m_Buffer[7])
+		sensor->resetVolume();
 	__aquaduino->writeConfig(sensor);
-
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+}
+#endif
+// Analog Input
+#ifdef USE_SENSOR_ANALOGINPUT
+void GUIServer::getAnalogInputConfig(Object* object, uint8_t sensorId) {
+	AnalogInput* sensor = (AnalogInput*) object;
+	float coefficients[ANALOGINPUT_COEFFICIENTS];
+	uint16_t raw = sensor->getRaw();
+	sensor->getCalibration(coefficients);
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
+	//sensorId
+	m_UdpServer.write(sensorId);
+	//ADC channel
+	m_UdpServer.write(sensor->getChannel());
+	//last decimated ADC value:uint16
+	m_UdpServer.write((uint8_t*) &raw, sizeof(raw));
+	//calibration coefficients:float[3]
+	m_UdpServer.write((uint8_t*) coefficients, sizeof(coefficients));
+}
+void GUIServer::setAnalogInputConfig(Object* object, uint8_t sensorId) {
+	AnalogInput* sensor = (AnalogInput*) object;
+	if (sensor->setChannel(m_Buffer[3])) {
+		//errorcode 10 -> channel not available
+		m_UdpServer.write((uint8_t) 10);
+		return;
+	}
+	//calibration coefficients:float[3]
+	sensor->setCalibration((float*) &m_Buffer[4]);
+	__aquaduino->writeConfig(sensor);
+	//errorcode 0
+	m_UdpServer.write((uint8_t) 0);
 }
+#endif
@@ -9,43 +9,140 @@
 #define GUISERVER_H_
 
 #include <EthernetUdp.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/Object.h>
+
+class __FlashStringHelper;
 
 class GUIServer {
 public:
+	enum {
+		GET_VERSION = 0,
+		GET_ALL_SENSORS = 1,
+		GET_SENSOR_DATA = 2,
+		SET_SENSOR_CONFIG = 3,
+		GET_ALL_ACTUATORS = 4,
+		GET_ACTUATOR_DATA = 5,
+		SET_ACTUATOR_DATA = 6,
+		SET_ACTUATOR_CONFIG = 7,
+		GET_ALL_CONTROLLERS = 8,
+		GET_CLOCK_TIMERS = 9,
+		SET_CLOCK_TIMER = 10,
+		GET_TEMPSENSORS_AT_PIN = 11,
+		SET_TEMPSENSOR_AT_PIN = 12,
+		GET_TEMPERATURE_CONTROLLER = 13,
+		SET_TEMPERATURE_CONTROLLER = 14,
+		GET_LEVEL_CONTROLLER = 15,
+		SET_LEVEL_CONTROLLER = 16,
+		RESET_LEVEL_CONTROLLER = 17,
+		SET_LEVEL_CONTROLLER_NAME = 18,
+		SET_TEMPERATURE_CONTROLLER_NAME = 19,
+		GET_DS1820_ADDRESSES = 20,
+		SET_DS1820_ADDRESS = 21,
+		GET_DS1820_RESOLUTION = 22,
+		SET_DS1820_RESOLUTION = 23,
+		GET_SERIAL_ATLAS_CONFIG = 24,
+		SET_SERIAL_ATLAS_CONFIG = 25,
+		CALIBRATE_SERIAL_ATLAS = 26,
+		GET_SENSOR_FILTER = 27,
+		GET_DIGITALINPUT_CONFIG = 28,
+		SET_DIGITALINPUT_CONFIG = 29,
+		GET_FLOW_SENSOR = 30,
+		SET_FLOW_SENSOR = 31,
+		GET_ANALOGINPUT_CONFIG = 32,
+		SET_ANALOGINPUT_CONFIG = 33,
+		//protocol version 3
+		GET_DASHBOARD = 34,
+		GET_OBJECTS = 35
+	};
+
+	typedef void (GUIServer::*GUIHandler)(Object* object, uint8_t objectId);
+
 	GUIServer(uint16_t port);
 
 	void run();
 
+	/*
+	 * Handlers of the type specific requests. They are registered together
+	 * with their types in the ObjectFactory.
+	 */
+	void getClockTimers(Object* object, uint8_t controllerId);
+	void getTemperatureController(Object* object, uint8_t controllerId);
+	void getLevelController(Object* object, uint8_t controllerId);
+	void setClockTimer(Object* object, uint8_t controllerId);
+	void setTemperatureController(Object* object, uint8_t controllerId);
+	void setTemperatureControllerName(Object* object, uint8_t controllerId);
+	void setLevelController(Object* object, uint8_t controllerId);
+	void setLevelControllerName(Object* object, uint8_t controllerId);
+	void resetLevelController(Object* object, uint8_t controllerId);
+	void getDigitalInputConfig(Object* object, uint8_t sensorId);
+	void setDigitalInputConfig(Object* object, uint8_t sensorId);
+	void setDS1820Address(Object* object, uint8_t sensorId);
+	void getDS1820Resolution(Object* object, uint8_t sensorId);
+	void setDS1820Resolution(Object* object, uint8_t sensorId);
+	void getSerialAtlasConfig(Object* object, uint8_t sensorId);
+	void setSerialAtlasConfig(Object* object, uint8_t sensorId);
+	void calibrateSerialAtlas(Object* object, uint8_t sensorId);
+	void getFlowSensor(Object* object, uint8_t sensorId);
+	void setFlowSensor(Object* object, uint8_t sensorId);
+	void getAnalogInputConfig(Object* object, uint8_t sensorId);
+	void setAnalogInputConfig(Object* object, uint8_t sensorId);
+
 protected:
 	virtual ~GUIServer();
 private:
 	int8_t receiveCommand();
 	void getAllSensors();
 	void getSensorData(uint8_t sensorId);
+	void getSensorFilter(uint8_t sensorId);
 	void getAllActuators();
 	void getActuatorData(uint8_t actuatorId);
 	void getAllControllers();
-	void getClockTimers(uint8_t controllerId);
-	void getTemperatureController(uint8_t controllerId);
-	void getLevelController(uint8_t controllerId);
 	void getDS1820Addresses();
 
+	void getDashboard();
+	void getObjects();
+
 	void setSensorConfig(uint8_t sensorId);
 	void setActuatorData(uint8_t actuatorId);
 	void setActuatorConfig(uint8_t actuatorId);
-	void setClockTimer(uint8_t controllerId);
-	void setTemperatureController(uint8_t controllerId);
-	void setTemperatureControllerName(uint8_t controllerId);
-	void setLevelController(uint8_t controllerId);
-	void setLevelControllerName(uint8_t controllerId);
-	void resetLevelController(uint8_t controllerId);
-	void setDS1820Address(uint8_t sensorId);
+
+	void dispatch(uint8_t method, uint8_t objectId);
 
 	void write(uint32_t value, EthernetUDP* udpServer);
+	void writeVarint(uint32_t value);
+	void writeString(const char* s);
+	void writeString(const __FlashStringHelper* s);
+
+	/*
+	 * Values sent with a protocol version 3 dashboard. Bit i of the masks
+	 * marks object i as present. Values of absent objects are 0.
+	 */
+	struct GUISnapshot {
+		uint16_t sequence;
+		uint32_t sensors;
+		uint32_t actuators;
+		int32_t sensorValues[MAX_SENSORS];
+		uint16_t actuatorStates[MAX_ACTUATORS];
+	};
+
+	GUISnapshot m_Snapshots[GUI_SNAPSHOTS];
+	uint16_t m_Sequence;
 
 	uint8_t m_Buffer[50];
+	int16_t m_Length;
 	uint16_t m_Port;
 	EthernetUDP m_UdpServer;
 };
 
+/*
+ * Type specific request handled by a GUIServer method. Lists of entries
+ * terminated by a NULL handler are stored in PROGMEM with the ObjectFactory
+ * entry of the type.
+ */
+struct GUIHandlerEntry {
+	uint8_t method;
+	GUIServer::GUIHandler handler;
+};
+
 #endif /* GUISERVER_H_ */
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Generated by build/compile-templates.py. Do not edit.
+ */
+
+#include "HTMLTemplates.h"
+
+const char mainTemplate[] PROGMEM =
+    "\x7f"
+    "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">\n"
+    "<html"
+    "\x7f"
+    " xmlns=\"http://www.w3.org/1999/xhtml\">\n"
+    "\n"
+    "<style type=\"text/css\" media=\"screen\">\n"
+    ".xbtooltip {\n"
+    "display: none;\n"
+    "position: absolute;\n"
+    "\x7f"
+    "background-color: #3FF;\n"
+    "font-family: Arial, Helvetica, sans-serif;\n"
+    "font-size: small;\n"
+    "border: 1px solid black\n"
+    "}\n"
+    "</style>\n"
+    "\n"
+    "<div i"
+    "\x7f"
+    "d=\"tt1\" class=\"xbtooltip\">\n"
+    "Xively Channel name.<br />\n"
+    "Change takes effect after reset!<br />\n"
+    "</div>\n"
+    "\n"
+    "<script type=\"text/javascr"
+    "\x7f"
+    "ipt\">\n"
+    "(function(window, document, undefined){\n"
+    "var XBTooltip = function( element, userConf, tooltip) {\n"
+    "var config = {\n"
+    "id: userCo"
+    "\x7f"
+    "nf.id|| undefined,\t\n"
+    "className: userConf.className || undefined,\n"
+    "x: userConf.x || 20,\n"
+    "y: userConf.y || 20,\n"
+    "text: userConf.text |"
+    "\x7f"
+    "| undefined,\n"
+    "};\n"
+    "var over = function(event) {\n"
+    "tooltip.style.display = \"block\";\n"
+    "},\n"
+    "out = function(event) {\n"
+    "tooltip.style.display "
+    "\x7f"
+    "= \"none\";\n"
+    "},\n"
+    "move = function(event) {\n"
+    "event = event ? event : window.event;\n"
+    "if ( event.pageX == null && event.clientX != null )"
+    "\x7f"
+    " {\n"
+    "var doc = document.documentElement, body = document.body;\n"
+    "event.pageX = event.clientX + (doc && doc.scrollLeft || body && bo"
+    "\x7f"
+    "dy.scrollLeft || 0) - (doc && doc.clientLeft || body && body.clientLeft || 0);\n"
+    "event.pageY = event.clientY + (doc && doc.scroll"
+    "\x7f"
+    "Top  || body && body.scrollTop  || 0) - (doc && doc.clientTop  || body && body.clientTop  || 0);\n"
+    "}\n"
+    "tooltip.style.top = (event.p"
+    "\x7f"
+    "ageY+config.y) + \"px\";\n"
+    "tooltip.style.left = (event.pageX+config.x) + \"px\";\n"
+    "}\n"
+    "if (tooltip === undefined && config.id) {\n"
+    "tooltip "
+    "\x7f"
+    "= document.getElementById(config.id);\n"
+    "if (tooltip) tooltip = tooltip.parentNode.removeChild(tooltip)\n"
+    "}\n"
+    "if (tooltip === undefine"
+    "\x7f"
+    "d && config.text) {\n"
+    "tooltip = document.createElement(\"div\");\n"
+    "if (config.id) tooltip.id= config.id;\n"
+    "tooltip.innerHTML = config.t"
+    "\x7f"
+    "ext;\n"
+    "}\n"
+    "if (config.className) tooltip.className = config.className;\n"
+    "tooltip = document.body.appendChild(tooltip);\n"
+    "tooltip.style."
+    "\x7f"
+    "position = \"absolute\";\n"
+    "element.onmouseover = over;\n"
+    "element.onmouseout = out;\n"
+    "element.onmousemove = move;\n"
+    "over();\n"
+    "};\n"
+    "window.XBTo"
+    "\x7f"
+    "oltip = window.XBT = XBTooltip;\n"
+    "})(this, this.document);\n"
+    "</script>\n"
+    "\n"
+    "<head>\n"
+    "<meta http-equiv=\"Content-Type\" content=\"text/html; "
+    "\x7f"
+    "charset=utf-8\" />\n"
+    "<title>Aquaduino</title>\n"
+    "</head>\n"
+    "\n"
+    "<body>\n"
+    "<h2>Aquaduino</h2>\n"
+    "<form id=\"form1\" name=\"form1\" method=\"post\" actio"
+    "\x7f"
+    "n=\"\"> \n"
+    "<table border=\"0\">\n"
+    "<tr>\n"
+    "<tr>\n"
+    "<td bgcolor=\"#99CCFF\">\n"
+    "<a href=\"/config\">Configuration</a>\n"
+    "</td>\n"
+    "</tr>\n"
+    "<td bgcolor=\"#99CCFF"
+    "\x2d"
+    "\">\n"
+    "The time is:\n"
+    "</td>\n"
+    "<td bgcolor=\"#99CCFF\">\n"
+    "\x9b" /* HOUR */
+    "\x01"
+    ":"
+    "\x9e" /* MINUTE */
+    "\x01"
+    ":"
+    "\xa8" /* SECOND */
+    "\x02"
+    ", "
+    "\x92" /* DOW */
+    "\x01"
+    " "
+    "\xa6" /* MONTH */
+    "\x01"
+    "/"
+    "\x91" /* DAY */
+    "\x01"
+    "/"
+    "\xb7" /* YEAR */
+    "\x6c"
+    "\n"
+    "</td>\n"
+    "</tr>\n"
+    "</table>\n"
+    "<br>\n"
+    "<table border=\"0\">\n"
+    "<tr>\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "Available Controllers\n"
+    "</th>\n"
+    "</tr>\n"
+    "\x8b" /* CONTROLLERROW */
+    "\x7f"
+    "\n"
+    "</table>\n"
+    "<br>\n"
+    "<table border=\"0\">\n"
+    "<tr>\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "Available Sensors\n"
+    "</th>\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "Value\n"
+    "</th>\n"
+    "<th bg"
+    "\x2c"
+    "color=\"#99CCFF\">\n"
+    "Xively Channel\n"
+    "</th>\n"
+    "</tr>\n"
+    "\xa9" /* SENSORROW */
+    "\x7f"
+    "\n"
+    "</table>\n"
+    "<br>\n"
+    "<table border=\"0\">\n"
+    "<tr>\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "Available Actuators\n"
+    "</th>\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "Assigned to\n"
+    "</th"
+    "\x54"
+    ">\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "Actuator is\n"
+    "</th>\n"
+    "<th bgcolor=\"#99CCFF\">\n"
+    "State\n"
+    "</th>\n"
+    "</tr>\n"
+    "\x80" /* ACTUATORROW */
+    "\x45"
+    "\n"
+    "</table>\n"
+    "<input type=\"submit\" value=\"Apply\">\n"
+    "</form>\n"
+    "</body>\n"
+    "</html>";
+
+const char mainarowTemplate[] PROGMEM =
+    "\x0d"
+    "<tr bgcolor='"
+    "\x84" /* AROWCOLOR */
+    "\x29"
+    "'>\n"
+    "<td>\n"
+    "<label>\n"
+    "<input type=\"text\" name=\""
+    "\x83" /* ANAME */
+    "\x09"
+    "\" value=\""
+    "\x86" /* AVAL */
+    "\x08"
+    "\" size=\""
+    "\x85" /* ASIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\x82" /* AMAXLENGTH */
+    "\x2e"
+    "\"/>\n"
+    "</label>\n"
+    "</td>\n"
+    "<td>\n"
+    "<label>\n"
+    "<select name=\""
+    "\x8e" /* CSELECT */
+    "\x24"
+    "\">\n"
+    "<option value=\"-1\">None</option>\n"
+    "\x8c" /* COPTIONS */
+    "\x35"
+    "\n"
+    "</select>\n"
+    "</label>\n"
+    "</td>\n"
+    "<td>\n"
+    "<label>\n"
+    "<select name=\""
+    "\x9d" /* LSELECT */
+    "\x03"
+    "\">\n"
+    "\x9c" /* LOPTIONS */
+    "\x2d"
+    "\n"
+    "</select>\n"
+    "</label>\n"
+    "</td>\n"
+    "<td>\n"
+    "<select name=\""
+    "\xaf" /* SSELECT */
+    "\x03"
+    "\">\n"
+    "\xad" /* SOPTIONS */
+    "\x1f"
+    "\n"
+    "</select>\n"
+    "</td>\n"
+    "<td>\n"
+    "<a href=\""
+    "\x81" /* ALINK */
+    "\x1c"
+    "\">Configure</a>\n"
+    "</td>\n"
+    "</tr>\n";
+
+const char mainsrowTemplate[] PROGMEM =
+    "\x0d"
+    "<tr bgcolor='"
+    "\xae" /* SROWCOLOR */
+    "\x29"
+    "'>\n"
+    "<td>\n"
+    "<label>\n"
+    "<input type=\"text\" name=\""
+    "\xac" /* SNAME */
+    "\x09"
+    "\" value=\""
+    "\xb1" /* SVAL */
+    "\x08"
+    "\" size=\""
+    "\xb0" /* SSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\xab" /* SMAXLENGTH */
+    "\x18"
+    "\"/>\n"
+    "</label>\n"
+    "</td>\n"
+    "<td>\n"
+    "\xb2" /* SVALUE */
+    "\x19"
+    "\n"
+    "</td>\n"
+    "<td>\n"
+    "<input name=\""
+    "\xb4" /* XCHANNELNAME */
+    "\x35"
+    "\" onmouseover=\"XBT(this, {id:'tt1'})\" for=\"1\" value=\""
+    "\xb6" /* XCHANNELVAL */
+    "\x08"
+    "\" size=\""
+    "\xb5" /* XCHANNELSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\xb3" /* XCHANNELMAXLENGTH */
+    "\x18"
+    "\"/>\n"
+    "</td>\n"
+    "<td>\n"
+    "<a href=\""
+    "\xaa" /* SLINK */
+    "\x1c"
+    "\">Configure</a>\n"
+    "</td>\n"
+    "</tr>\n";
+
+const char maincrowTemplate[] PROGMEM =
+    "\x0d"
+    "<tr bgcolor='"
+    "\x8d" /* CROWCOLOR */
+    "\x29"
+    "'>\n"
+    "<td>\n"
+    "<label>\n"
+    "<input type=\"text\" name=\""
+    "\x89" /* CNAME */
+    "\x09"
+    "\" value=\""
+    "\x90" /* CVAL */
+    "\x08"
+    "\" size=\""
+    "\x8f" /* CSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\x88" /* CMAXLENGTH */
+    "\x21"
+    "\"/>\n"
+    "</label>\n"
+    "</td>\n"
+    "<td>\n"
+    "<a href=\""
+    "\x87" /* CLINK */
+    "\x1c"
+    "\">Configure</a>\n"
+    "</td>\n"
+    "</tr>\n";
+
+const char clockrowTemplate[] PROGMEM =
+    "\x0d"
+    "<tr bgcolor='"
+    "\x8a" /* COLOR */
+    "\x1a"
+    "'> \n"
+    "<td>\n"
+    "On: <input name=\""
+    "\x98" /* HONNAME */
+    "\x09"
+    "\" value=\""
+    "\x9a" /* HONVAL */
+    "\x08"
+    "\" size=\""
+    "\x99" /* HONSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\x97" /* HONMAXLENGTH */
+    "\x10"
+    "\">:<input name=\""
+    "\xa4" /* MONNAME */
+    "\x09"
+    "\" value=\""
+    "\xa7" /* MONVAL */
+    "\x08"
+    "\" size=\""
+    "\xa5" /* MONSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\xa3" /* MONMAXLENGTH */
+    "\x20"
+    "\">\n"
+    "</td>\n"
+    "<td>\n"
+    "Off: <input name=\""
+    "\x94" /* HOFFNAME */
+    "\x09"
+    "\" value=\""
+    "\x96" /* HOFFVAL */
+    "\x08"
+    "\" size=\""
+    "\x95" /* HOFFSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\x93" /* HOFFMAXLENGTH */
+    "\x10"
+    "\">:<input name=\""
+    "\xa0" /* MOFFNAME */
+    "\x09"
+    "\" value=\""
+    "\xa2" /* MOFFVAL */
+    "\x08"
+    "\" size=\""
+    "\xa1" /* MOFFSIZE */
+    "\x0d"
+    "\" maxlength=\""
+    "\x9f" /* MOFFMAXLENGTH */
+    "\x0e"
+    "\">\n"
+    "</td>\n"
+    "</tr>";
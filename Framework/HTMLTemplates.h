@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Generated by build/compile-templates.py. Do not edit.
+ */
+
+#ifndef HTMLTEMPLATES_H_
+#define HTMLTEMPLATES_H_
+
+#include <avr/pgmspace.h>
+
+/**
+ * \brief Placeholders of the compiled templates.
+ */
+enum
+{
+    TEMPLATE_ACTUATORROW,
+    TEMPLATE_ALINK,
+    TEMPLATE_AMAXLENGTH,
+    TEMPLATE_ANAME,
+    TEMPLATE_AROWCOLOR,
+    TEMPLATE_ASIZE,
+    TEMPLATE_AVAL,
+    TEMPLATE_CLINK,
+    TEMPLATE_CMAXLENGTH,
+    TEMPLATE_CNAME,
+    TEMPLATE_COLOR,
+    TEMPLATE_CONTROLLERROW,
+    TEMPLATE_COPTIONS,
+    TEMPLATE_CROWCOLOR,
+    TEMPLATE_CSELECT,
+    TEMPLATE_CSIZE,
+    TEMPLATE_CVAL,
+    TEMPLATE_DAY,
+    TEMPLATE_DOW,
+    TEMPLATE_HOFFMAXLENGTH,
+    TEMPLATE_HOFFNAME,
+    TEMPLATE_HOFFSIZE,
+    TEMPLATE_HOFFVAL,
+    TEMPLATE_HONMAXLENGTH,
+    TEMPLATE_HONNAME,
+    TEMPLATE_HONSIZE,
+    TEMPLATE_HONVAL,
+    TEMPLATE_HOUR,
+    TEMPLATE_LOPTIONS,
+    TEMPLATE_LSELECT,
+    TEMPLATE_MINUTE,
+    TEMPLATE_MOFFMAXLENGTH,
+    TEMPLATE_MOFFNAME,
+    TEMPLATE_MOFFSIZE,
+    TEMPLATE_MOFFVAL,
+    TEMPLATE_MONMAXLENGTH,
+    TEMPLATE_MONNAME,
+    TEMPLATE_MONSIZE,
+    TEMPLATE_MONTH,
+    TEMPLATE_MONVAL,
+    TEMPLATE_SECOND,
+    TEMPLATE_SENSORROW,
+    TEMPLATE_SLINK,
+    TEMPLATE_SMAXLENGTH,
+    TEMPLATE_SNAME,
+    TEMPLATE_SOPTIONS,
+    TEMPLATE_SROWCOLOR,
+    TEMPLATE_SSELECT,
+    TEMPLATE_SSIZE,
+    TEMPLATE_SVAL,
+    TEMPLATE_SVALUE,
+    TEMPLATE_XCHANNELMAXLENGTH,
+    TEMPLATE_XCHANNELNAME,
+    TEMPLATE_XCHANNELSIZE,
+    TEMPLATE_XCHANNELVAL,
+    TEMPLATE_YEAR
+};
+
+/**
+ * \brief Compiled HTML/main.htm.
+ */
+extern const char mainTemplate[] PROGMEM;
+
+/**
+ * \brief Compiled HTML/mainarow.htm.
+ */
+extern const char mainarowTemplate[] PROGMEM;
+
+/**
+ * \brief Compiled HTML/mainsrow.htm.
+ */
+extern const char mainsrowTemplate[] PROGMEM;
+
+/**
+ * \brief Compiled HTML/maincrow.htm.
+ */
+extern const char maincrowTemplate[] PROGMEM;
+
+/**
+ * \brief Compiled HTML/clockrow.htm.
+ */
+extern const char clockrowTemplate[] PROGMEM;
+
+#endif /* HTMLTEMPLATES_H_ */
@@ -0,0 +1,931 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "HTTPServer.h"
+#include <Aquaduino.h>
+#include <BufferedPrint.h>
+#include <Framework/HTMLTemplates.h>
+#include <Framework/TemplateRenderer.h>
+#include <Framework/util.h>
+#include <Time.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+    HTTPSERVER_IDLE, HTTPSERVER_REQUEST, HTTPSERVER_RESPONSE, HTTPSERVER_RENDER
+};
+
+/*
+ * Page served for requests of a folder.
+ */
+#define HTTPSERVER_INDEX "main.htm"
+
+/**
+ * \brief Determines the media type of a file by its extension.
+ * \param[in] name Name of the file.
+ *
+ * \returns The media type to be sent as Content-Type.
+ */
+static const __FlashStringHelper* contentType(const char* name)
+{
+    const char* extension = strrchr(name, '.');
+
+    if (extension == NULL)
+        return F("application/octet-stream");
+    extension++;
+    if (strcasecmp_P(extension, PSTR("htm")) == 0
+        || strcasecmp_P(extension, PSTR("html")) == 0)
+        return F("text/html");
+    if (strcasecmp_P(extension, PSTR("css")) == 0)
+        return F("text/css");
+    if (strcasecmp_P(extension, PSTR("js")) == 0)
+        return F("application/javascript");
+    if (strcasecmp_P(extension, PSTR("json")) == 0)
+        return F("application/json");
+    if (strcasecmp_P(extension, PSTR("png")) == 0)
+        return F("image/png");
+    if (strcasecmp_P(extension, PSTR("jpg")) == 0)
+        return F("image/jpeg");
+    if (strcasecmp_P(extension, PSTR("gif")) == 0)
+        return F("image/gif");
+    if (strcasecmp_P(extension, PSTR("ico")) == 0)
+        return F("image/x-icon");
+    return F("application/octet-stream");
+}
+
+/**
+ * \brief Prints a string as JSON string literal.
+ * \param[in] out Destination.
+ * \param[in] s String to print.
+ */
+static void printJSONString(Print& out, const char* s)
+{
+    out.print('"');
+    for (; *s != 0; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            out.print('\\');
+        if ((uint8_t) *s >= ' ')
+            out.print(*s);
+    }
+    out.print('"');
+}
+
+/**
+ * \brief Prints a string as HTML text or attribute value.
+ * \param[in] out Destination.
+ * \param[in] s String to print.
+ */
+static void printHTML(Print& out, const char* s)
+{
+    for (; *s != 0; s++)
+    {
+        switch (*s)
+        {
+        case '&':
+            out.print(F("&amp;"));
+            break;
+        case '<':
+            out.print(F("&lt;"));
+            break;
+        case '>':
+            out.print(F("&gt;"));
+            break;
+        case '"':
+            out.print(F("&quot;"));
+            break;
+        case '\'':
+            out.print(F("&#39;"));
+            break;
+        default:
+            out.print(*s);
+        }
+    }
+}
+
+/**
+ * \brief Prints a number with at least two digits.
+ * \param[in] out Destination.
+ * \param[in] value Number to print.
+ */
+static void printTwoDigits(Print& out, int value)
+{
+    if (value < 10)
+        out.print('0');
+    out.print(value);
+}
+
+/**
+ * \brief Prints the opening tag of a select option.
+ * \param[in] out Destination.
+ * \param[in] value Value of the option.
+ * \param[in] selected Non-zero if the option is selected.
+ */
+static void printOption(Print& out, int value, int8_t selected)
+{
+    out.print(F("<option value=\""));
+    out.print(value);
+    out.print(selected ? F("\" selected>") : F("\">"));
+}
+
+/**
+ * \brief Gets the object listed in a row of the main page.
+ * \param[in] placeholder TEMPLATE_CONTROLLERROW, TEMPLATE_SENSORROW or
+ *                        TEMPLATE_ACTUATORROW.
+ * \param[in] index Index of the object.
+ *
+ * \returns The object or NULL if there is none at this index.
+ */
+static Object* getRowObject(uint8_t placeholder, int8_t index)
+{
+    switch (placeholder)
+    {
+    case TEMPLATE_CONTROLLERROW:
+        return __aquaduino->getController(index);
+    case TEMPLATE_SENSORROW:
+        return __aquaduino->getSensor(index);
+    case TEMPLATE_ACTUATORROW:
+        return __aquaduino->getActuator(index);
+    }
+    return NULL;
+}
+
+/**
+ * \brief Constructor
+ * \param[in] port TCP port to listen on.
+ *
+ * The network needs to be initialized already.
+ */
+HTTPServer::HTTPServer(uint16_t port) :
+        m_Server(port), m_Template(NULL), m_Row(0), m_State(HTTPSERVER_IDLE),
+        m_Start(0), m_Method(0), m_Gzip(0), m_LineLength(0), m_Lines(0)
+{
+    m_Path[0] = 0;
+    m_IfNoneMatch[0] = 0;
+    m_Server.begin();
+}
+
+/**
+ * \brief Processes the current connection or accepts a new one.
+ *
+ * Needs to be called periodically. Reads the request headers received so far,
+ * sends the next block of a page or renders the next part of the main page.
+ */
+void HTTPServer::run()
+{
+    switch (m_State)
+    {
+    case HTTPSERVER_IDLE:
+        m_Client = m_Server.available();
+        if (!m_Client)
+            return;
+        m_State = HTTPSERVER_REQUEST;
+        m_Start = millis();
+        m_Method = 0;
+        m_Gzip = 0;
+        m_Path[0] = 0;
+        m_IfNoneMatch[0] = 0;
+        m_LineLength = 0;
+        m_Lines = 0;
+        readRequest();
+        break;
+    case HTTPSERVER_REQUEST:
+        readRequest();
+        break;
+    case HTTPSERVER_RESPONSE:
+        sendBlock();
+        break;
+    case HTTPSERVER_RENDER:
+        renderBlock();
+        break;
+    }
+}
+
+/**
+ * \brief Reads the received part of the request headers.
+ *
+ * The request is handled as soon as the empty line terminating the headers
+ * arrived. A message body is ignored. Clients not completing their headers
+ * within #HTTPSERVER_REQUEST_TIMEOUT milliseconds are disconnected.
+ */
+void HTTPServer::readRequest()
+{
+    uint8_t buffer[32];
+    int length;
+    int i;
+
+    while (m_State == HTTPSERVER_REQUEST
+           && (length = m_Client.read(buffer, sizeof(buffer))) > 0)
+    {
+        for (i = 0; i < length && m_State == HTTPSERVER_REQUEST; i++)
+        {
+            if (buffer[i] == '\n')
+            {
+                m_Line[m_LineLength] = 0;
+                parseLine();
+                m_LineLength = 0;
+            }
+            else if (buffer[i] != '\r'
+                     && m_LineLength < sizeof(m_Line) - 1)
+            {
+                m_Line[m_LineLength++] = buffer[i];
+            }
+        }
+    }
+
+    if (m_State == HTTPSERVER_REQUEST
+        && (!m_Client.connected()
+            || millis() - m_Start >= HTTPSERVER_REQUEST_TIMEOUT))
+        close();
+}
+
+/**
+ * \brief Evaluates the request line or a header line.
+ *
+ * Only the method and path of the request line as well as the headers
+ * Accept-Encoding and If-None-Match are of interest.
+ */
+void HTTPServer::parseLine()
+{
+    char* value;
+    uint8_t length;
+
+    if (m_Lines++ == 0)
+    {
+        if (strncmp_P(m_Line, PSTR("GET "), 4) == 0)
+            m_Method = 'G';
+        else if (strncmp_P(m_Line, PSTR("HEAD "), 5) == 0)
+            m_Method = 'H';
+        else if (strncmp_P(m_Line, PSTR("POST "), 5) == 0)
+            m_Method = 'P';
+
+        value = strchr(m_Line, ' ');
+        if (value == NULL)
+            return;
+        value++;
+        length = strcspn(value, " ?");
+        if (value[length] != 0 && length < sizeof(m_Path))
+        {
+            memcpy(m_Path, value, length);
+            m_Path[length] = 0;
+        }
+    }
+    else if (m_Line[0] == 0)
+    {
+        handleRequest();
+    }
+    else if (strncasecmp_P(m_Line, PSTR("Accept-Encoding:"), 16) == 0)
+    {
+        m_Gzip = strstr_P(m_Line, PSTR("gzip")) != NULL;
+    }
+    else if (strncasecmp_P(m_Line, PSTR("If-None-Match:"), 14) == 0)
+    {
+        value = &m_Line[14];
+        while (*value == ' ')
+            value++;
+        if (strncmp_P(value, PSTR("W/"), 2) == 0)
+            value += 2;
+        strncpy(m_IfNoneMatch, value, sizeof(m_IfNoneMatch) - 1);
+        m_IfNoneMatch[sizeof(m_IfNoneMatch) - 1] = 0;
+    }
+}
+
+/**
+ * \brief Dispatches a completely received request.
+ */
+void HTTPServer::handleRequest()
+{
+    if (m_Method == 0)
+        sendError(501, F("Not Implemented"));
+    else if (m_Path[0] != '/' || strstr_P(m_Path, PSTR("..")) != NULL)
+        sendError(400, F("Bad Request"));
+    else if (strncmp_P(m_Path, PSTR("/api/"), 5) == 0)
+        serveAPI();
+    else if (m_Method == 'P')
+        sendError(405, F("Method Not Allowed"));
+    else if (strcmp_P(m_Path, PSTR("/")) == 0
+             || strcmp_P(m_Path, PSTR("/" HTTPSERVER_INDEX)) == 0)
+        serveMain();
+    else
+        serveFile();
+}
+
+/**
+ * \brief Starts sending a page from the SD card.
+ *
+ * Sends the response headers. The content follows block by block with the
+ * next calls of run.
+ */
+void HTTPServer::serveFile()
+{
+    char name[sizeof(HTTPSERVER_ROOT) + sizeof("/gz") + sizeof(m_Path)
+              + sizeof(HTTPSERVER_INDEX)];
+    char etag[HTTPSERVER_ETAG_LENGTH + 1];
+    dir_t entry;
+    uint8_t* field;
+    uint32_t hash = 2166136261UL;
+    uint32_t size;
+    int8_t gzip;
+    uint8_t i;
+
+    for (gzip = m_Gzip; gzip >= 0; gzip--)
+    {
+        strcpy_P(name, PSTR(HTTPSERVER_ROOT));
+        if (gzip)
+            strcat_P(name, PSTR("/gz"));
+        strcat(name, m_Path);
+        if (name[strlen(name) - 1] == '/')
+            strcat_P(name, PSTR(HTTPSERVER_INDEX));
+
+        m_File = SD.open(name);
+        if (m_File && !m_File.isDirectory())
+            break;
+        m_File.close();
+    }
+
+    if (gzip < 0)
+    {
+        sendError(404, F("Not Found"));
+        return;
+    }
+
+    /*
+     * FNV-1a hash of the directory entry from the first cluster up to the
+     * size, which includes the time of the last write. Copying a new version
+     * of a page to the card changes it without reading the file.
+     */
+    size = m_File.size();
+    etag[0] = 0;
+    if (m_File.dirEntry(&entry))
+    {
+        field = (uint8_t*) &entry.firstClusterHigh;
+        for (i = 0; i < (uint8_t*) (&entry + 1) - field; i++)
+            hash = (hash ^ field[i]) * 16777619UL;
+        etag[0] = '"';
+        ultoa(hash, &etag[1], 16);
+        strcat_P(etag, PSTR("\""));
+    }
+
+    BufferedPrint out(m_Client);
+
+    if (etag[0] != 0 && strcmp(m_IfNoneMatch, etag) == 0)
+    {
+        sendStatus(out, 304, F("Not Modified"));
+        out.print(F("ETag: "));
+        out.println(etag);
+        out.println();
+        out.flush();
+        m_File.close();
+        close();
+        return;
+    }
+
+    sendStatus(out, 200, F("OK"));
+    out.print(F("Content-Type: "));
+    out.println(contentType(name));
+    out.print(F("Content-Length: "));
+    out.println(size);
+    if (gzip)
+        out.print(F("Content-Encoding: gzip\r\n"));
+    out.print(F("Vary: Accept-Encoding\r\n"));
+    out.print(F("Cache-Control: no-cache\r\n"));
+    if (etag[0] != 0)
+    {
+        out.print(F("ETag: "));
+        out.println(etag);
+    }
+    out.println();
+    out.flush();
+
+    if (m_Method == 'H')
+    {
+        m_File.close();
+        close();
+        return;
+    }
+
+    m_State = HTTPSERVER_RESPONSE;
+}
+
+/**
+ * \brief Sends the next block of the current page.
+ *
+ * The connection is closed after the last block.
+ */
+void HTTPServer::sendBlock()
+{
+    uint8_t block[HTTPSERVER_BLOCK_SIZE];
+    int length;
+
+    length = m_File.read(block, sizeof(block));
+    if (length > 0)
+        m_Client.write(block, length);
+
+    if (length < (int) sizeof(block) || !m_Client.connected())
+    {
+        m_File.close();
+        close();
+    }
+}
+
+/**
+ * \brief Starts rendering the main page.
+ *
+ * The page is generated on the fly and thus sent without Content-Length and
+ * entity tag.
+ */
+void HTTPServer::serveMain()
+{
+    BufferedPrint out(m_Client);
+
+    sendStatus(out, 200, F("OK"));
+    out.print(F("Content-Type: text/html\r\n"));
+    out.print(F("Cache-Control: no-store\r\n\r\n"));
+    out.flush();
+
+    if (m_Method == 'H')
+    {
+        close();
+        return;
+    }
+
+    m_Template = mainTemplate;
+    m_Row = 0;
+    m_State = HTTPSERVER_RENDER;
+}
+
+/**
+ * \brief Renders the next part of the main page.
+ *
+ * Rendering stops after #HTTPSERVER_BLOCK_SIZE characters of the template or
+ * after a row. The connection is closed when the page is complete.
+ */
+void HTTPServer::renderBlock()
+{
+    BufferedPrint out(m_Client);
+
+    m_Template = renderTemplate(out, m_Template, HTTPSERVER_BLOCK_SIZE,
+                                &HTTPServer::templateValue, this);
+    out.flush();
+
+    if (m_Template == NULL || !m_Client.connected())
+        close();
+}
+
+/**
+ * \brief Callback of renderTemplate.
+ * \param[in] out Destination.
+ * \param[in] placeholder Placeholder to print.
+ * \param[in] context The HTTPServer rendering the page.
+ *
+ * \returns See TemplateValue.
+ */
+int8_t HTTPServer::templateValue(Print& out, uint8_t placeholder,
+                                 void* context)
+{
+    return ((HTTPServer*) context)->printValue(out, placeholder);
+}
+
+/**
+ * \brief Prints the value of a placeholder of the main page.
+ * \param[in] out Destination.
+ * \param[in] placeholder Placeholder to print.
+ *
+ * The placeholders of the rows refer to the object at m_Row.
+ *
+ * \returns Non-zero after a row was printed, 0 otherwise.
+ */
+int8_t HTTPServer::printValue(Print& out, uint8_t placeholder)
+{
+    Controller* controller;
+    Actuator* actuator;
+    Sensor* sensor;
+    int8_t i;
+
+    switch (placeholder)
+    {
+    case TEMPLATE_CONTROLLERROW:
+    case TEMPLATE_SENSORROW:
+    case TEMPLATE_ACTUATORROW:
+        return printRows(out, placeholder);
+    case TEMPLATE_HOUR:
+        printTwoDigits(out, hour());
+        break;
+    case TEMPLATE_MINUTE:
+        printTwoDigits(out, minute());
+        break;
+    case TEMPLATE_SECOND:
+        printTwoDigits(out, second());
+        break;
+    case TEMPLATE_DOW:
+        out.print(dayShortStr(weekday()));
+        break;
+    case TEMPLATE_MONTH:
+        printTwoDigits(out, month());
+        break;
+    case TEMPLATE_DAY:
+        printTwoDigits(out, day());
+        break;
+    case TEMPLATE_YEAR:
+        out.print(year());
+        break;
+    case TEMPLATE_CROWCOLOR:
+        out.print(m_Row & 1 ? COLOR_CONTROLLER_ROW2 : COLOR_CONTROLLER_ROW1);
+        break;
+    case TEMPLATE_CNAME:
+        out.print('C');
+        out.print(m_Row);
+        break;
+    case TEMPLATE_CVAL:
+        controller = __aquaduino->getController(m_Row);
+        printHTML(out, controller->getName());
+        break;
+    case TEMPLATE_CLINK:
+        controller = __aquaduino->getController(m_Row);
+        out.print(controller->getURL());
+        break;
+    case TEMPLATE_SROWCOLOR:
+        out.print(m_Row & 1 ? COLOR_SENSOR_ROW2 : COLOR_SENSOR_ROW1);
+        break;
+    case TEMPLATE_SNAME:
+        out.print('S');
+        out.print(m_Row);
+        break;
+    case TEMPLATE_SVAL:
+        sensor = __aquaduino->getSensor(m_Row);
+        printHTML(out, sensor->getName());
+        break;
+    case TEMPLATE_SVALUE:
+        printMilli(out, __aquaduino->getSensorMilliValue(m_Row));
+        break;
+    case TEMPLATE_SLINK:
+        sensor = __aquaduino->getSensor(m_Row);
+        out.print(sensor->getURL());
+        break;
+    case TEMPLATE_XCHANNELNAME:
+        out.print('X');
+        out.print(m_Row);
+        break;
+    case TEMPLATE_XCHANNELVAL:
+        printHTML(out, __aquaduino->getXivelyChannelName(m_Row));
+        break;
+    case TEMPLATE_XCHANNELSIZE:
+        out.print(XIVELY_CHANNEL_NAME_LENGTH);
+        break;
+    case TEMPLATE_XCHANNELMAXLENGTH:
+        out.print(XIVELY_CHANNEL_NAME_LENGTH - 1);
+        break;
+    case TEMPLATE_AROWCOLOR:
+        out.print(m_Row & 1 ? COLOR_ACTUATOR_ROW2 : COLOR_ACTUATOR_ROW1);
+        break;
+    case TEMPLATE_ANAME:
+        out.print('A');
+        out.print(m_Row);
+        break;
+    case TEMPLATE_AVAL:
+        actuator = __aquaduino->getActuator(m_Row);
+        printHTML(out, actuator->getName());
+        break;
+    case TEMPLATE_ALINK:
+        actuator = __aquaduino->getActuator(m_Row);
+        out.print(actuator->getURL());
+        break;
+    case TEMPLATE_CSELECT:
+        out.print(F("AC"));
+        out.print(m_Row);
+        break;
+    case TEMPLATE_COPTIONS:
+        actuator = __aquaduino->getActuator(m_Row);
+        for (i = 0; i < MAX_CONTROLLERS; i++)
+        {
+            controller = __aquaduino->getController(i);
+            if (controller == NULL)
+                continue;
+            printOption(out, i, actuator->getController() == i);
+            printHTML(out, controller->getName());
+            out.print(F("</option>"));
+        }
+        break;
+    case TEMPLATE_LSELECT:
+        out.print(F("AL"));
+        out.print(m_Row);
+        break;
+    case TEMPLATE_LOPTIONS:
+        actuator = __aquaduino->getActuator(m_Row);
+        printOption(out, 0, !actuator->isLocked());
+        out.print(F("Unlocked</option>"));
+        printOption(out, 1, actuator->isLocked());
+        out.print(F("Locked</option>"));
+        break;
+    case TEMPLATE_SSELECT:
+        out.print(F("AS"));
+        out.print(m_Row);
+        break;
+    case TEMPLATE_SOPTIONS:
+        actuator = __aquaduino->getActuator(m_Row);
+        printOption(out, 0, !actuator->isOn());
+        out.print(F("Off</option>"));
+        printOption(out, 1, actuator->isOn());
+        out.print(F("On</option>"));
+        break;
+    case TEMPLATE_CSIZE:
+    case TEMPLATE_SSIZE:
+    case TEMPLATE_ASIZE:
+        out.print(AQUADUINO_STRING_LENGTH);
+        break;
+    case TEMPLATE_CMAXLENGTH:
+    case TEMPLATE_SMAXLENGTH:
+    case TEMPLATE_AMAXLENGTH:
+        out.print(AQUADUINO_STRING_LENGTH - 1);
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Prints the next row of a list of the main page.
+ * \param[in] out Destination.
+ * \param[in] placeholder TEMPLATE_CONTROLLERROW, TEMPLATE_SENSORROW or
+ *                        TEMPLATE_ACTUATORROW.
+ *
+ * Rendering is suspended after each row so the list is spread over several
+ * calls of run.
+ *
+ * \returns Non-zero if a row was printed. 0 when the list is complete.
+ */
+int8_t HTTPServer::printRows(Print& out, uint8_t placeholder)
+{
+    const char* row;
+    int8_t count;
+
+    switch (placeholder)
+    {
+    case TEMPLATE_CONTROLLERROW:
+        row = maincrowTemplate;
+        count = MAX_CONTROLLERS;
+        break;
+    case TEMPLATE_SENSORROW:
+        row = mainsrowTemplate;
+        count = MAX_SENSORS;
+        break;
+    default:
+        row = mainarowTemplate;
+        count = MAX_ACTUATORS;
+        break;
+    }
+
+    while (m_Row < count && getRowObject(placeholder, m_Row) == NULL)
+        m_Row++;
+
+    if (m_Row == count)
+    {
+        m_Row = 0;
+        return 0;
+    }
+
+    renderTemplate(out, row, 0xFFFF, &HTTPServer::templateValue, this);
+    m_Row++;
+    return 1;
+}
+
+/**
+ * \brief Answers a request of the JSON API.
+ */
+void HTTPServer::serveAPI()
+{
+    const char* resource = &m_Path[5];
+    char* end;
+    Actuator* actuator = NULL;
+    long id = -1;
+
+    if (strncmp_P(resource, PSTR("actuators/"), 10) == 0)
+    {
+        id = strtol(&resource[10], &end, 10);
+        if (end != &resource[10] && 0 <= id && id < MAX_ACTUATORS)
+            actuator = __aquaduino->getActuator(id);
+        if (actuator == NULL)
+        {
+            sendError(404, F("Not Found"));
+            return;
+        }
+        resource = end;
+    }
+
+    if (m_Method == 'P')
+    {
+        if (actuator == NULL)
+        {
+            sendError(405, F("Method Not Allowed"));
+            return;
+        }
+        if (strcmp_P(resource, PSTR("/on")) == 0)
+            actuator->on();
+        else if (strcmp_P(resource, PSTR("/off")) == 0)
+            actuator->off();
+        else
+        {
+            sendError(404, F("Not Found"));
+            return;
+        }
+    }
+    else if ((actuator != NULL && resource[0] != 0)
+             || (actuator == NULL
+                 && strcmp_P(resource, PSTR("sensors")) != 0
+                 && strcmp_P(resource, PSTR("actuators")) != 0
+                 && strcmp_P(resource, PSTR("controllers")) != 0))
+    {
+        sendError(404, F("Not Found"));
+        return;
+    }
+
+    BufferedPrint out(m_Client);
+
+    sendStatus(out, 200, F("OK"));
+    out.print(F("Content-Type: application/json\r\n"));
+    out.print(F("Cache-Control: no-store\r\n\r\n"));
+
+    if (m_Method != 'H')
+    {
+        if (actuator != NULL)
+            sendActuator(out, id);
+        else if (resource[0] == 's')
+            sendSensors(out);
+        else if (resource[0] == 'a')
+            sendActuators(out);
+        else
+            sendControllers(out);
+    }
+
+    out.flush();
+    close();
+}
+
+/**
+ * \brief Prints all sensors as JSON array.
+ * \param[in] out Destination.
+ */
+void HTTPServer::sendSensors(Print& out)
+{
+    Sensor* sensor;
+    int8_t first = 1;
+    int8_t i;
+
+    out.print('[');
+    for (i = 0; i < MAX_SENSORS; i++)
+    {
+        sensor = __aquaduino->getSensor(i);
+        if (sensor == NULL)
+            continue;
+        if (!first)
+            out.print(',');
+        first = 0;
+        out.print(F("{\"id\":"));
+        out.print(i);
+        out.print(F(",\"name\":"));
+        printJSONString(out, sensor->getName());
+        out.print(F(",\"type\":"));
+        out.print(sensor->getType());
+        out.print(F(",\"value\":"));
+        printMilli(out, __aquaduino->getSensorMilliValue(i));
+        out.print('}');
+    }
+    out.print(']');
+}
+
+/**
+ * \brief Prints all actuators as JSON array.
+ * \param[in] out Destination.
+ */
+void HTTPServer::sendActuators(Print& out)
+{
+    int8_t first = 1;
+    int8_t i;
+
+    out.print('[');
+    for (i = 0; i < MAX_ACTUATORS; i++)
+    {
+        if (__aquaduino->getActuator(i) == NULL)
+            continue;
+        if (!first)
+            out.print(',');
+        first = 0;
+        sendActuator(out, i);
+    }
+    out.print(']');
+}
+
+/**
+ * \brief Prints an actuator as JSON object.
+ * \param[in] out Destination.
+ * \param[in] id ID of an existing actuator.
+ */
+void HTTPServer::sendActuator(Print& out, int8_t id)
+{
+    Actuator* actuator = __aquaduino->getActuator(id);
+
+    out.print(F("{\"id\":"));
+    out.print(id);
+    out.print(F(",\"name\":"));
+    printJSONString(out, actuator->getName());
+    out.print(F(",\"type\":"));
+    out.print(actuator->getType());
+    out.print(F(",\"on\":"));
+    out.print(actuator->isOn() ? F("true") : F("false"));
+    if (actuator->supportsPWM())
+    {
+        out.print(F(",\"pwm\":"));
+        out.print(actuator->getPWM(), 3);
+    }
+    out.print(F(",\"controller\":"));
+    out.print(actuator->getController());
+    out.print('}');
+}
+
+/**
+ * \brief Prints all controllers as JSON array.
+ * \param[in] out Destination.
+ */
+void HTTPServer::sendControllers(Print& out)
+{
+    Controller* controller;
+    int8_t first = 1;
+    int8_t i;
+
+    out.print('[');
+    for (i = 0; i < MAX_CONTROLLERS; i++)
+    {
+        controller = __aquaduino->getController(i);
+        if (controller == NULL)
+            continue;
+        if (!first)
+            out.print(',');
+        first = 0;
+        out.print(F("{\"id\":"));
+        out.print(i);
+        out.print(F(",\"name\":"));
+        printJSONString(out, controller->getName());
+        out.print(F(",\"type\":"));
+        out.print(controller->getType());
+        out.print('}');
+    }
+    out.print(']');
+}
+
+/**
+ * \brief Prints the status line and the headers common to all responses.
+ * \param[in] out Destination.
+ * \param[in] status Status code.
+ * \param[in] reason Reason phrase of the status code.
+ */
+void HTTPServer::sendStatus(Print& out, uint16_t status,
+                            const __FlashStringHelper* reason)
+{
+    out.print(F("HTTP/1.1 "));
+    out.print(status);
+    out.print(' ');
+    out.println(reason);
+    out.print(F("Connection: close\r\n"));
+}
+
+/**
+ * \brief Sends a response without content and closes the connection.
+ * \param[in] status Status code.
+ * \param[in] reason Reason phrase of the status code.
+ */
+void HTTPServer::sendError(uint16_t status, const __FlashStringHelper* reason)
+{
+    BufferedPrint out(m_Client);
+
+    sendStatus(out, status, reason);
+    out.print(F("Content-Length: 0\r\n\r\n"));
+    out.flush();
+    close();
+}
+
+/**
+ * \brief Closes the current connection.
+ */
+void HTTPServer::close()
+{
+    m_Client.stop();
+    m_State = HTTPSERVER_IDLE;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HTTPSERVER_H_
+#define HTTPSERVER_H_
+
+#include <Arduino.h>
+#include <EthernetServer.h>
+#include <EthernetClient.h>
+#include <SD.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Length of an entity tag including the quotes.
+ */
+#define HTTPSERVER_ETAG_LENGTH 10
+
+/**
+ * \brief Minimal HTTP/1.1 server for the pages on the SD card and a JSON API.
+ *
+ * The main page is rendered from the templates compiled into PROGMEM (see
+ * HTMLTemplates.h) with one row per controller, sensor and actuator. All
+ * other pages are looked up in #HTTPSERVER_ROOT. Clients accepting gzip get the
+ * compressed copy from the subfolder gz when there is one. It is sent as is
+ * with Content-Encoding gzip, so no compression happens on the ATmega. The
+ * entity tag of a page is a hash of its size and first block. Requests with a
+ * matching If-None-Match header are answered with 304 Not Modified.
+ *
+ * The JSON API consists of:
+ * - GET /api/sensors: id, name, type and reading of all sensors.
+ * - GET /api/actuators: id, name, type, state, duty cycle and controller of
+ *   all actuators.
+ * - GET /api/controllers: id, name and type of all controllers.
+ * - POST /api/actuators/<id>/on and POST /api/actuators/<id>/off: Switch an
+ *   actuator and return its new state.
+ *
+ * Only one connection is served at a time and every response closes it. Each
+ * call of run does a bounded amount of work: it reads the request headers
+ * received so far, sends one block of #HTTPSERVER_BLOCK_SIZE bytes of a
+ * page or renders about one row of the main page. This keeps the loop of the controllers running while a page is
+ * transferred.
+ */
+class HTTPServer
+{
+public:
+    HTTPServer(uint16_t port);
+
+    void run();
+
+private:
+    void readRequest();
+    void parseLine();
+    void handleRequest();
+    void serveFile();
+    void sendBlock();
+    void serveMain();
+    void renderBlock();
+    static int8_t templateValue(Print& out, uint8_t placeholder,
+                                void* context);
+    int8_t printValue(Print& out, uint8_t placeholder);
+    int8_t printRows(Print& out, uint8_t placeholder);
+    void serveAPI();
+    void sendSensors(Print& out);
+    void sendActuators(Print& out);
+    void sendActuator(Print& out, int8_t id);
+    void sendControllers(Print& out);
+    void sendStatus(Print& out, uint16_t status,
+                    const __FlashStringHelper* reason);
+    void sendError(uint16_t status, const __FlashStringHelper* reason);
+    void close();
+
+    EthernetServer m_Server;
+    EthernetClient m_Client;
+    File m_File;
+    const char* m_Template;
+    int8_t m_Row;
+    uint8_t m_State;
+    unsigned long m_Start;
+    char m_Method;
+    int8_t m_Gzip;
+    char m_Path[HTTPSERVER_PATH_LENGTH];
+    char m_IfNoneMatch[HTTPSERVER_ETAG_LENGTH + 1];
+    char m_Line[HTTPSERVER_LINE_LENGTH];
+    uint8_t m_LineLength;
+    uint8_t m_Lines;
+};
+
+#endif /* HTTPSERVER_H_ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LineProtocolExporter.h"
+#include <Aquaduino.h>
+#include <Time.h>
+#include <Framework/util.h>
+
+/**
+ * \brief Constructor
+ * \param[in] host Address of the receiver.
+ * \param[in] port UDP port of the receiver.
+ *
+ * The exporter starts enabled.
+ */
+LineProtocolExporter::LineProtocolExporter(const IPAddress& host,
+                                           uint16_t port) :
+        m_Host(host), m_Port(port), m_Enabled(1)
+{
+}
+
+/**
+ * \brief Changes the receiver.
+ * \param[in] host Address of the receiver.
+ * \param[in] port UDP port of the receiver.
+ */
+void LineProtocolExporter::setDestination(const IPAddress& host, uint16_t port)
+{
+    m_Host = host;
+    m_Port = port;
+}
+
+/**
+ * \brief Enables the export.
+ */
+void LineProtocolExporter::enable()
+{
+    m_Enabled = 1;
+}
+
+/**
+ * \brief Disables the export.
+ */
+void LineProtocolExporter::disable()
+{
+    m_Enabled = 0;
+}
+
+/**
+ * \brief Checks whether the export is enabled.
+ *
+ * \returns 1 if enabled. 0 otherwise.
+ */
+int8_t LineProtocolExporter::isEnabled()
+{
+    return m_Enabled;
+}
+
+/**
+ * \brief Getter for the number of samples sent at once.
+ *
+ * \returns #LINEPROTOCOL_BATCH_SIZE
+ */
+uint16_t LineProtocolExporter::getBatchSize()
+{
+    return LINEPROTOCOL_BATCH_SIZE;
+}
+
+/**
+ * \brief Sends one datagram per sample.
+ * \param[in] queue Queue holding the samples.
+ * \param[in] count Number of samples to be sent.
+ *
+ * \returns Number of samples sent. -1 if not even the first one could be
+ * sent.
+ */
+int16_t LineProtocolExporter::exportSamples(SampleQueue* queue, uint16_t count)
+{
+    Sample sample;
+    Sensor* sensor;
+    uint32_t utc;
+    uint16_t sent;
+    int8_t sensorIdx;
+
+    if (!m_Udp.begin(LINEPROTOCOL_LOCAL_PORT))
+        return -1;
+
+    for (sent = 0; sent < count; sent++)
+    {
+        if (queue->peek(sent, &sample) != 0)
+            break;
+        if (!m_Udp.beginPacket(m_Host, m_Port))
+            break;
+
+        utc = sample.time
+                - (int32_t) __aquaduino->getTimezone() * SECS_PER_HOUR;
+        for (sensorIdx = 0; sensorIdx < MAX_SENSORS; sensorIdx++)
+        {
+            sensor = __aquaduino->getSensor(sensorIdx);
+            if (sensor == NULL || sensor->getName()[0] == 0)
+                continue;
+            m_Udp.print(F(LINEPROTOCOL_MEASUREMENT ",sensor="));
+            printEscaped(sensor->getName());
+            m_Udp.print(F(" value="));
+            printMilli(m_Udp, sample.values[sensorIdx]);
+            m_Udp.print(' ');
+            m_Udp.print(utc);
+            m_Udp.print(F("000000000\n"));
+        }
+
+        if (!m_Udp.endPacket())
+            break;
+    }
+
+    m_Udp.stop();
+
+    return sent > 0 ? sent : -1;
+}
+
+/**
+ * \brief Prints a tag value escaping spaces, commas and equal signs.
+ * \param[in] s The tag value.
+ */
+void LineProtocolExporter::printEscaped(const char* s)
+{
+    for (; *s; s++)
+    {
+        if (*s == ' ' || *s == ',' || *s == '=')
+            m_Udp.print('\\');
+        m_Udp.print(*s);
+    }
+}
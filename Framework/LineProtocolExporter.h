@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINEPROTOCOLEXPORTER_H_
+#define LINEPROTOCOLEXPORTER_H_
+
+#include <Arduino.h>
+#include <EthernetUdp.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/Exporter.h>
+
+/**
+ * \brief Exporter sending samples in InfluxDB line protocol via UDP.
+ *
+ * Each sample becomes one datagram with one line per sensor:
+ *
+ *     aquaduino,sensor=Temperature value=25.125 1398945600000000000
+ *
+ * The measurement is #LINEPROTOCOL_MEASUREMENT, the tag is the name of the
+ * sensor and the timestamp is given in nanoseconds UTC as expected by the UDP
+ * listener of InfluxDB. Any UDP receiver can be used to check the output,
+ * e.g. "nc -ul 8089" on a PC in the same network.
+ *
+ * UDP gives no feedback, so samples are only kept when they can not be
+ * handed to the Ethernet controller.
+ */
+class LineProtocolExporter: public Exporter
+{
+public:
+    LineProtocolExporter(const IPAddress& host, uint16_t port);
+
+    void setDestination(const IPAddress& host, uint16_t port);
+    void enable();
+    void disable();
+
+    int8_t isEnabled();
+    uint16_t getBatchSize();
+    int16_t exportSamples(SampleQueue* queue, uint16_t count);
+
+private:
+    void printEscaped(const char* s);
+
+    EthernetUDP m_Udp;
+    IPAddress m_Host;
+    uint16_t m_Port;
+    int8_t m_Enabled;
+};
+
+#endif /* LINEPROTOCOLEXPORTER_H_ */
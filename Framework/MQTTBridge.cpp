@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MQTTBridge.h"
+#include <Aquaduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MQTT_STATUS_TOPIC   MQTT_TOPIC_PREFIX "/status"
+#define MQTT_SENSOR_TOPIC   MQTT_TOPIC_PREFIX "/sensor/"
+#define MQTT_ACTUATOR_TOPIC MQTT_TOPIC_PREFIX "/actuator/"
+#define MQTT_COMMAND_SUFFIX "/set"
+
+/*
+ * Room for the longest topic, i.e. a command topic.
+ */
+#define MQTT_TOPIC_LENGTH   (sizeof(MQTT_ACTUATOR_TOPIC) \
+                             + AQUADUINO_STRING_LENGTH \
+                             + sizeof(MQTT_COMMAND_SUFFIX))
+
+/**
+ * \brief Constructor
+ *
+ * The first connection is attempted with the first call of run.
+ */
+MQTTBridge::MQTTBridge() :
+        m_Client(m_EthClient), m_Online(0),
+        m_LastConnect(millis() - MQTT_RECONNECT_INTERVAL), m_LastPublish(0)
+{
+    m_Client.setCallback(&MQTTBridge::handleMessage);
+}
+
+/**
+ * \brief Getter for the state of the connection to the broker.
+ *
+ * \returns MQTT_DISCONNECTED, MQTT_CONNECTING or MQTT_CONNECTED.
+ */
+uint8_t MQTTBridge::getState()
+{
+    return m_Client.getState();
+}
+
+/**
+ * \brief Processes the connection to the broker.
+ *
+ * Needs to be called periodically. Only the attempt to connect blocks until
+ * the TCP connection is established or has failed.
+ */
+void MQTTBridge::run()
+{
+    unsigned long now = millis();
+
+    m_Client.run();
+
+    switch (m_Client.getState())
+    {
+    case MQTT_DISCONNECTED:
+        m_Online = 0;
+        if (now - m_LastConnect >= MQTT_RECONNECT_INTERVAL)
+        {
+            m_LastConnect = now;
+            m_Client.connect(IPAddress(MQTT_BROKER), MQTT_PORT,
+                             MQTT_CLIENT_ID, MQTT_KEEPALIVE,
+                             MQTT_STATUS_TOPIC, "offline");
+        }
+        break;
+    case MQTT_CONNECTED:
+        if (!m_Online)
+        {
+            m_Online = 1;
+            m_Client.subscribe(MQTT_ACTUATOR_TOPIC "+" MQTT_COMMAND_SUFFIX, 1);
+            m_Client.publish(MQTT_STATUS_TOPIC, "online", 0, 1);
+            m_LastPublish = now;
+            publishChanges(1);
+        }
+        else if (now - m_LastPublish >= MQTT_PUBLISH_INTERVAL)
+        {
+            m_LastPublish = now;
+            publishChanges(0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * \brief Publishes the readings and states that changed.
+ * \param[in] all Non-zero to publish all of them.
+ *
+ * Values that could not be published are tried again next time.
+ */
+void MQTTBridge::publishChanges(int8_t all)
+{
+    char topic[MQTT_TOPIC_LENGTH];
+    char payload[14];
+    Sensor* sensor;
+    Actuator* actuator;
+    int32_t value;
+    int32_t diff;
+    uint32_t magnitude;
+    int8_t state;
+    int8_t i;
+
+    for (i = 0; i < MAX_SENSORS; i++)
+    {
+        sensor = __aquaduino->getSensor(i);
+        if (sensor == NULL || sensor->getName()[0] == 0)
+            continue;
+
+        value = __aquaduino->getSensorMilliValue(i);
+        diff = value - m_Sensors[i];
+        if (diff < 0)
+            diff = -diff;
+        if (!all && diff <= MQTT_SENSOR_DEADBAND)
+            continue;
+
+        magnitude = value < 0 ? -value : value;
+        snprintf(payload, sizeof(payload), "%s%lu.%03lu", value < 0 ? "-" : "",
+                 magnitude / 1000, magnitude % 1000);
+        strcpy(topic, MQTT_SENSOR_TOPIC);
+        strcat(topic, sensor->getName());
+        if (m_Client.publish(topic, payload, 0, 1) == 0)
+            m_Sensors[i] = value;
+    }
+
+    for (i = 0; i < MAX_ACTUATORS; i++)
+    {
+        actuator = __aquaduino->getActuator(i);
+        if (actuator == NULL || actuator->getName()[0] == 0)
+            continue;
+
+        state = actuator->isOn() ? 1 : 0;
+        if (!all && state == m_Actuators[i])
+            continue;
+
+        strcpy(topic, MQTT_ACTUATOR_TOPIC);
+        strcat(topic, actuator->getName());
+        if (m_Client.publish(topic, state ? "ON" : "OFF", 0, 1) == 0)
+            m_Actuators[i] = state;
+    }
+}
+
+/**
+ * \brief Executes commands received on the actuator command topics.
+ * \param[in] topic Topic of the message.
+ * \param[in] payload Zero terminated payload.
+ * \param[in] length Length of the payload.
+ *
+ * The new state is published with the next check for changes.
+ */
+void MQTTBridge::handleMessage(const char* topic, const uint8_t* payload,
+                               uint16_t length)
+{
+    const char* command = (const char*) payload;
+    const uint8_t prefixLength = sizeof(MQTT_ACTUATOR_TOPIC) - 1;
+    const uint8_t suffixLength = sizeof(MQTT_COMMAND_SUFFIX) - 1;
+    uint16_t topicLength = strlen(topic);
+    uint16_t nameLength;
+    Actuator* actuator;
+    float dutyCycle;
+    int8_t i;
+
+    if (topicLength <= prefixLength + suffixLength
+        || strncmp(topic, MQTT_ACTUATOR_TOPIC, prefixLength) != 0
+        || strcmp(&topic[topicLength - suffixLength], MQTT_COMMAND_SUFFIX)
+                != 0)
+        return;
+
+    topic += prefixLength;
+    nameLength = topicLength - prefixLength - suffixLength;
+
+    for (i = 0; i < MAX_ACTUATORS; i++)
+    {
+        actuator = __aquaduino->getActuator(i);
+        if (actuator == NULL || strlen(actuator->getName()) != nameLength
+            || strncmp(actuator->getName(), topic, nameLength) != 0)
+            continue;
+
+        if (strcasecmp(command, "ON") == 0)
+        {
+            actuator->on();
+        }
+        else if (strcasecmp(command, "OFF") == 0)
+        {
+            actuator->off();
+        }
+        else if (length > 0)
+        {
+            dutyCycle = atof(command);
+            if (actuator->supportsPWM())
+                actuator->setPWM(dutyCycle);
+            else if (dutyCycle > 0)
+                actuator->on();
+            else
+                actuator->off();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MQTTBRIDGE_H_
+#define MQTTBRIDGE_H_
+
+#include <Arduino.h>
+#include <EthernetClient.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/MQTTClient.h>
+
+/**
+ * \brief Connects sensors and actuators of Aquaduino to an MQTT broker.
+ *
+ * The following topics below #MQTT_TOPIC_PREFIX are used:
+ *
+ * - status: "online" while connected, "offline" as will (retained).
+ * - sensor/<name>: Reading with three decimals (retained). Published on
+ *   connect and when it changed by more than #MQTT_SENSOR_DEADBAND.
+ * - actuator/<name>: "ON" or "OFF" (retained). Published on connect and when
+ *   the state changed.
+ * - actuator/<name>/set: Commands subscribed with QoS 1. "ON" and "OFF" call
+ *   Actuator::on and Actuator::off. A number sets the PWM duty cycle (0..1) of
+ *   actuators supporting PWM and switches the others on when greater than 0.
+ *
+ * Changes are checked every #MQTT_PUBLISH_INTERVAL milliseconds. When the
+ * connection is lost a new one is attempted every #MQTT_RECONNECT_INTERVAL
+ * milliseconds. A broker on the build host (e.g. mosquitto) can be watched
+ * with mosquitto_sub -v -t 'aquaduino/#'.
+ */
+class MQTTBridge
+{
+public:
+    MQTTBridge();
+
+    uint8_t getState();
+    void run();
+
+private:
+    static void handleMessage(const char* topic, const uint8_t* payload,
+                              uint16_t length);
+    void publishChanges(int8_t all);
+
+    EthernetClient m_EthClient;
+    MQTTClient m_Client;
+    int8_t m_Online;
+    unsigned long m_LastConnect;
+    unsigned long m_LastPublish;
+    int32_t m_Sensors[MAX_SENSORS];
+    int8_t m_Actuators[MAX_ACTUATORS];
+};
+
+#endif /* MQTTBRIDGE_H_ */
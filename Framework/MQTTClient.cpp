@@ -0,0 +1,565 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MQTTClient.h"
+#include <string.h>
+
+/*
+ * Control packet types in the upper nibble of the fixed header.
+ */
+#define MQTT_CONNECT     0x10
+#define MQTT_CONNACK     0x20
+#define MQTT_PUBLISH     0x30
+#define MQTT_PUBACK      0x40
+#define MQTT_SUBSCRIBE   0x80
+#define MQTT_SUBACK      0x90
+#define MQTT_PINGREQ     0xC0
+#define MQTT_PINGRESP    0xD0
+#define MQTT_DISCONNECT  0xE0
+
+#define MQTT_DUP         0x08
+
+/*
+ * Space reserved in front of the variable header for the fixed header, i.e.
+ * the packet type and up to 4 bytes of remaining length.
+ */
+#define MQTT_HEADER_SPACE 5
+
+/*
+ * States of the receiver.
+ */
+enum
+{
+    RX_HEADER,
+    RX_LENGTH,
+    RX_BODY
+};
+
+/**
+ * \brief Constructor
+ * \param[in] client Client used for the connection to the broker.
+ */
+MQTTClient::MQTTClient(Client& client) :
+        m_Client(&client), m_Callback(NULL), m_State(MQTT_DISCONNECTED),
+        m_KeepAlive(0), m_PacketId(0), m_LastSent(0), m_LastReceived(0),
+        m_RxState(RX_HEADER), m_RxHeader(0), m_RxShift(0), m_RxLength(0),
+        m_RxPos(0), m_InFlightId(0), m_InFlightStart(0), m_InFlightLength(0),
+        m_InFlightSent(0)
+{
+}
+
+/**
+ * \brief Sets the callback for messages on subscribed topics.
+ * \param[in] callback The callback. NULL to ignore messages.
+ */
+void MQTTClient::setCallback(MQTTCallback callback)
+{
+    m_Callback = callback;
+}
+
+/**
+ * \brief Opens the connection to the broker and sends CONNECT.
+ * \param[in] broker Address of the broker.
+ * \param[in] port Port of the broker.
+ * \param[in] clientId Client identifier.
+ * \param[in] keepAlive Keep alive interval in seconds.
+ * \param[in] willTopic Topic of the will or NULL for none.
+ * \param[in] willMessage Retained message published by the broker when the
+ *                        connection is lost.
+ *
+ * Opening the TCP connection blocks. The client is connected once the broker
+ * accepted the connection, which is checked by getState. A QoS 1 message
+ * still in flight is sent again then.
+ *
+ * \returns 0 when CONNECT was sent. -1 otherwise.
+ */
+int8_t MQTTClient::connect(const IPAddress& broker, uint16_t port,
+                           const char* clientId, uint16_t keepAlive,
+                           const char* willTopic, const char* willMessage)
+{
+    uint16_t pos = MQTT_HEADER_SPACE;
+    uint16_t start;
+    uint8_t flags = 0x02;
+
+    close();
+
+    if (m_Client->connect(broker, port) != 1)
+        return -1;
+
+    pos = putString(m_TxBuffer, pos, "MQTT");
+    m_TxBuffer[pos++] = 4;
+    if (willTopic != NULL)
+        flags |= 0x04 | 0x20;
+    m_TxBuffer[pos++] = flags;
+    m_TxBuffer[pos++] = keepAlive >> 8;
+    m_TxBuffer[pos++] = keepAlive & 0xFF;
+    pos = putString(m_TxBuffer, pos, clientId);
+    if (willTopic != NULL)
+    {
+        pos = putString(m_TxBuffer, pos, willTopic);
+        pos = putString(m_TxBuffer, pos, willMessage);
+    }
+    if (pos > sizeof(m_TxBuffer))
+    {
+        close();
+        return -1;
+    }
+
+    start = finishPacket(m_TxBuffer, MQTT_CONNECT, pos);
+    m_KeepAlive = keepAlive;
+    m_State = MQTT_CONNECTING;
+    m_LastReceived = millis();
+    if (send(&m_TxBuffer[start], pos - start) != 0)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * \brief Sends DISCONNECT and closes the connection.
+ *
+ * A QoS 1 message still in flight is kept.
+ */
+void MQTTClient::disconnect()
+{
+    if (m_State == MQTT_CONNECTED)
+        sendShort(MQTT_DISCONNECT, 0);
+    close();
+}
+
+/**
+ * \brief Getter for the connection state.
+ *
+ * \returns MQTT_DISCONNECTED, MQTT_CONNECTING or MQTT_CONNECTED.
+ */
+uint8_t MQTTClient::getState()
+{
+    return m_State;
+}
+
+/**
+ * \brief Publishes a message.
+ * \param[in] topic Topic of the message.
+ * \param[in] payload Payload of the message.
+ * \param[in] length Length of the payload.
+ * \param[in] qos 0 or 1.
+ * \param[in] retain Non-zero to have the broker retain the message.
+ *
+ * A QoS 1 message is kept and retransmitted, also after a reconnect, until
+ * the broker acknowledges it.
+ *
+ * \returns 0 on success. -1 if not connected, the packet does not fit into
+ * the buffer, another QoS 1 message is still in flight or sending a QoS 0
+ * message failed.
+ */
+int8_t MQTTClient::publish(const char* topic, const uint8_t* payload,
+                           uint16_t length, uint8_t qos, int8_t retain)
+{
+    uint8_t* buffer = qos ? m_InFlight : m_TxBuffer;
+    uint16_t pos = MQTT_HEADER_SPACE;
+    uint16_t start;
+    uint16_t packetId = 0;
+    uint8_t header = MQTT_PUBLISH;
+
+    if (m_State != MQTT_CONNECTED || qos > 1)
+        return -1;
+    if (qos && m_InFlightId != 0)
+        return -1;
+    if (pos + 2 + strlen(topic) + 2 + length > MQTT_BUFFER_SIZE)
+        return -1;
+
+    pos = putString(buffer, pos, topic);
+    if (qos)
+    {
+        packetId = nextPacketId();
+        buffer[pos++] = packetId >> 8;
+        buffer[pos++] = packetId & 0xFF;
+        header |= qos << 1;
+    }
+    memcpy(&buffer[pos], payload, length);
+    pos += length;
+    if (retain)
+        header |= 0x01;
+
+    start = finishPacket(buffer, header, pos);
+    if (qos)
+    {
+        m_InFlightId = packetId;
+        m_InFlightStart = start;
+        m_InFlightLength = pos - start;
+        m_InFlightSent = millis();
+        // If this fails the message is sent again after reconnecting
+        send(&buffer[start], pos - start);
+        // Retransmissions are marked as duplicates
+        buffer[start] |= MQTT_DUP;
+        return 0;
+    }
+
+    return send(&buffer[start], pos - start);
+}
+
+/**
+ * \brief Publishes a string message.
+ * \param[in] topic Topic of the message.
+ * \param[in] payload Zero terminated payload.
+ * \param[in] qos 0 or 1.
+ * \param[in] retain Non-zero to have the broker retain the message.
+ *
+ * \returns See the other publish method.
+ */
+int8_t MQTTClient::publish(const char* topic, const char* payload,
+                           uint8_t qos, int8_t retain)
+{
+    return publish(topic, (const uint8_t*) payload, strlen(payload), qos,
+                   retain);
+}
+
+/**
+ * \brief Checks whether a QoS 1 message still waits for its acknowledge.
+ *
+ * \returns 1 if a message is in flight. 0 otherwise.
+ */
+int8_t MQTTClient::isPublishPending()
+{
+    return m_InFlightId != 0;
+}
+
+/**
+ * \brief Subscribes to a topic filter.
+ * \param[in] topicFilter Topic filter, may contain wildcards.
+ * \param[in] qos Maximum QoS of the messages delivered, 0 or 1.
+ *
+ * \returns 0 on success. -1 if not connected, the packet does not fit into
+ * the buffer or sending failed.
+ */
+int8_t MQTTClient::subscribe(const char* topicFilter, uint8_t qos)
+{
+    uint16_t pos = MQTT_HEADER_SPACE;
+    uint16_t start;
+    uint16_t packetId;
+
+    if (m_State != MQTT_CONNECTED || qos > 1)
+        return -1;
+    if (pos + 2 + 2 + strlen(topicFilter) + 1 > MQTT_BUFFER_SIZE)
+        return -1;
+
+    packetId = nextPacketId();
+    m_TxBuffer[pos++] = packetId >> 8;
+    m_TxBuffer[pos++] = packetId & 0xFF;
+    pos = putString(m_TxBuffer, pos, topicFilter);
+    m_TxBuffer[pos++] = qos;
+
+    start = finishPacket(m_TxBuffer, MQTT_SUBSCRIBE | 0x02, pos);
+    return send(&m_TxBuffer[start], pos - start);
+}
+
+/**
+ * \brief Processes the connection.
+ *
+ * Handles the received bytes, sends a ping when nothing was sent within the
+ * keep alive interval and retransmits the message in flight. The connection
+ * is closed when the broker does not answer CONNECT within
+ * #MQTT_CONNECT_TIMEOUT milliseconds or nothing is received for one and a
+ * half keep alive intervals.
+ */
+void MQTTClient::run()
+{
+    unsigned long now;
+
+    if (m_State == MQTT_DISCONNECTED)
+        return;
+
+    if (!m_Client->connected())
+    {
+        close();
+        return;
+    }
+
+    while (m_Client->available() > 0 && m_State != MQTT_DISCONNECTED)
+        receive(m_Client->read());
+
+    if (m_State == MQTT_DISCONNECTED)
+        return;
+
+    now = millis();
+    if (m_State == MQTT_CONNECTING)
+    {
+        if (now - m_LastReceived > MQTT_CONNECT_TIMEOUT)
+            close();
+        return;
+    }
+
+    if (m_KeepAlive != 0)
+    {
+        if (now - m_LastReceived > m_KeepAlive * 1500UL)
+        {
+            close();
+            return;
+        }
+        if (now - m_LastSent >= m_KeepAlive * 1000UL)
+            sendShort(MQTT_PINGREQ, 0);
+    }
+
+    if (m_InFlightId != 0 && now - m_InFlightSent >= MQTT_RETRY_INTERVAL)
+    {
+        m_InFlightSent = now;
+        send(&m_InFlight[m_InFlightStart], m_InFlightLength);
+    }
+}
+
+/**
+ * \brief Appends a length prefixed string.
+ * \param[in] buffer Packet buffer.
+ * \param[in] pos Position to write to.
+ * \param[in] s Zero terminated string.
+ *
+ * Nothing is written beyond #MQTT_BUFFER_SIZE. The returned position then
+ * exceeds it though.
+ *
+ * \returns The position behind the string.
+ */
+uint16_t MQTTClient::putString(uint8_t* buffer, uint16_t pos, const char* s)
+{
+    uint16_t length = strlen(s);
+
+    if (pos + 2 + length <= MQTT_BUFFER_SIZE)
+    {
+        buffer[pos] = length >> 8;
+        buffer[pos + 1] = length & 0xFF;
+        memcpy(&buffer[pos + 2], s, length);
+    }
+
+    return pos + 2 + length;
+}
+
+/**
+ * \brief Writes the fixed header in front of the variable header.
+ * \param[in] buffer Packet buffer. The variable header starts at
+ *                   #MQTT_HEADER_SPACE.
+ * \param[in] header Packet type and flags.
+ * \param[in] length End of the packet in the buffer.
+ *
+ * \returns Start of the packet in the buffer.
+ */
+uint16_t MQTTClient::finishPacket(uint8_t* buffer, uint8_t header,
+                                  uint16_t length)
+{
+    uint8_t encoded[4];
+    uint8_t count = 0;
+    uint16_t remaining = length - MQTT_HEADER_SPACE;
+    uint16_t start;
+
+    do
+    {
+        encoded[count] = remaining & 0x7F;
+        remaining >>= 7;
+        if (remaining > 0)
+            encoded[count] |= 0x80;
+        count++;
+    } while (remaining > 0);
+
+    start = MQTT_HEADER_SPACE - 1 - count;
+    buffer[start] = header;
+    memcpy(&buffer[start + 1], encoded, count);
+
+    return start;
+}
+
+/**
+ * \brief Writes a packet to the connection.
+ * \param[in] packet The packet.
+ * \param[in] length Length of the packet.
+ *
+ * The connection is closed if not the whole packet could be written.
+ *
+ * \returns 0 on success. -1 otherwise.
+ */
+int8_t MQTTClient::send(const uint8_t* packet, uint16_t length)
+{
+    if (m_Client->write(packet, length) != length)
+    {
+        close();
+        return -1;
+    }
+    m_LastSent = millis();
+    return 0;
+}
+
+/**
+ * \brief Sends a packet without payload.
+ * \param[in] header Packet type and flags.
+ * \param[in] packetId Packet identifier. 0 to send no variable header.
+ *
+ * \returns 0 on success. -1 otherwise.
+ */
+int8_t MQTTClient::sendShort(uint8_t header, uint16_t packetId)
+{
+    uint8_t packet[4];
+
+    packet[0] = header;
+    if (packetId == 0)
+    {
+        packet[1] = 0;
+        return send(packet, 2);
+    }
+    packet[1] = 2;
+    packet[2] = packetId >> 8;
+    packet[3] = packetId & 0xFF;
+    return send(packet, 4);
+}
+
+/**
+ * \brief Gets the next packet identifier.
+ *
+ * \returns Packet identifier other than 0.
+ */
+uint16_t MQTTClient::nextPacketId()
+{
+    if (++m_PacketId == 0)
+        m_PacketId = 1;
+    return m_PacketId;
+}
+
+/**
+ * \brief Feeds a received byte to the packet parser.
+ * \param[in] c The received byte.
+ *
+ * A remaining length of more than four bytes is malformed and closes the
+ * connection.
+ */
+void MQTTClient::receive(uint8_t c)
+{
+    switch (m_RxState)
+    {
+    case RX_HEADER:
+        m_RxHeader = c;
+        m_RxLength = 0;
+        m_RxShift = 0;
+        m_RxPos = 0;
+        m_RxState = RX_LENGTH;
+        break;
+    case RX_LENGTH:
+        m_RxLength |= (uint32_t) (c & 0x7F) << m_RxShift;
+        m_RxShift += 7;
+        if (c & 0x80)
+        {
+            // The remaining length has at most four bytes
+            if (m_RxShift == 28)
+                close();
+            break;
+        }
+        if (m_RxLength > 0)
+        {
+            m_RxState = RX_BODY;
+            break;
+        }
+        handlePacket();
+        m_RxState = RX_HEADER;
+        break;
+    case RX_BODY:
+        if (m_RxPos < MQTT_BUFFER_SIZE)
+            m_RxBuffer[m_RxPos] = c;
+        m_RxPos++;
+        if (m_RxPos == m_RxLength)
+        {
+            handlePacket();
+            m_RxState = RX_HEADER;
+        }
+        break;
+    }
+}
+
+/**
+ * \brief Handles a completely received packet.
+ */
+void MQTTClient::handlePacket()
+{
+    uint16_t topicLength;
+    uint16_t payload;
+    uint16_t packetId;
+    uint8_t qos;
+    int8_t complete = m_RxLength <= MQTT_BUFFER_SIZE;
+
+    m_LastReceived = millis();
+
+    switch (m_RxHeader & 0xF0)
+    {
+    case MQTT_CONNACK:
+        if (m_State != MQTT_CONNECTING)
+            break;
+        if (m_RxLength < 2 || m_RxBuffer[1] != 0)
+        {
+            // Refused by the broker
+            close();
+            break;
+        }
+        m_State = MQTT_CONNECTED;
+        if (m_InFlightId != 0)
+        {
+            m_InFlightSent = millis();
+            send(&m_InFlight[m_InFlightStart], m_InFlightLength);
+        }
+        break;
+    case MQTT_PUBLISH:
+        if (m_RxLength < 2)
+            break;
+        qos = (m_RxHeader >> 1) & 0x03;
+        topicLength = (m_RxBuffer[0] << 8) | m_RxBuffer[1];
+        // A topic beyond the packet or the buffer would wrap payload
+        if (topicLength > m_RxLength - 2 || topicLength > MQTT_BUFFER_SIZE)
+            break;
+        payload = 2 + topicLength;
+        if (qos)
+        {
+            if (payload + 2U > m_RxLength || payload + 2U > MQTT_BUFFER_SIZE)
+                break;
+            packetId = (m_RxBuffer[payload] << 8) | m_RxBuffer[payload + 1];
+            payload += 2;
+            sendShort(MQTT_PUBACK, packetId);
+        }
+        if (!complete || payload > m_RxLength || m_Callback == NULL)
+            break;
+        // Move the topic to the start to zero terminate it in place
+        memmove(m_RxBuffer, &m_RxBuffer[2], topicLength);
+        m_RxBuffer[topicLength] = 0;
+        m_RxBuffer[m_RxLength] = 0;
+        m_Callback((const char*) m_RxBuffer, &m_RxBuffer[payload],
+                   m_RxLength - payload);
+        break;
+    case MQTT_PUBACK:
+        if (m_RxLength >= 2
+            && ((m_RxBuffer[0] << 8) | m_RxBuffer[1]) == m_InFlightId)
+            m_InFlightId = 0;
+        break;
+    default:
+        // SUBACK and PINGRESP only need to be received
+        break;
+    }
+}
+
+/**
+ * \brief Closes the connection without sending DISCONNECT.
+ */
+void MQTTClient::close()
+{
+    m_Client->stop();
+    m_State = MQTT_DISCONNECTED;
+    m_RxState = RX_HEADER;
+}
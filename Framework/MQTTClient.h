@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MQTTCLIENT_H_
+#define MQTTCLIENT_H_
+
+#include <Arduino.h>
+#include <Client.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief States of MQTTClient.
+ */
+enum
+{
+    MQTT_DISCONNECTED,
+    MQTT_CONNECTING,
+    MQTT_CONNECTED
+};
+
+/**
+ * \brief Callback for messages received on subscribed topics.
+ * \param[in] topic Zero terminated topic.
+ * \param[in] payload Payload. A zero byte follows the payload.
+ * \param[in] length Length of the payload.
+ */
+typedef void (*MQTTCallback)(const char* topic, const uint8_t* payload,
+                             uint16_t length);
+
+/**
+ * \brief Minimal MQTT 3.1.1 client.
+ *
+ * Supports publishing and subscribing with QoS 0 and 1, retained messages,
+ * a will and the keep alive mechanism. Packets are assembled in static
+ * buffers of #MQTT_BUFFER_SIZE bytes and written in one piece. Received
+ * packets that do not fit are dropped, only QoS 1 messages are still
+ * acknowledged.
+ *
+ * Apart from opening the TCP connection nothing blocks. run needs to be
+ * called periodically. It processes the received bytes, sends the keep alive
+ * pings and retransmits an unacknowledged QoS 1 message every
+ * #MQTT_RETRY_INTERVAL milliseconds. Only one outgoing QoS 1 message can be
+ * in flight at a time.
+ */
+class MQTTClient
+{
+public:
+    MQTTClient(Client& client);
+
+    void setCallback(MQTTCallback callback);
+
+    int8_t connect(const IPAddress& broker, uint16_t port,
+                   const char* clientId, uint16_t keepAlive,
+                   const char* willTopic = NULL,
+                   const char* willMessage = NULL);
+    void disconnect();
+    uint8_t getState();
+
+    int8_t publish(const char* topic, const uint8_t* payload, uint16_t length,
+                   uint8_t qos, int8_t retain);
+    int8_t publish(const char* topic, const char* payload, uint8_t qos,
+                   int8_t retain);
+    int8_t isPublishPending();
+    int8_t subscribe(const char* topicFilter, uint8_t qos);
+
+    void run();
+
+private:
+    static uint16_t putString(uint8_t* buffer, uint16_t pos,
+                              const char* s);
+    uint16_t finishPacket(uint8_t* buffer, uint8_t header, uint16_t length);
+    int8_t send(const uint8_t* packet, uint16_t length);
+    int8_t sendShort(uint8_t header, uint16_t packetId);
+    uint16_t nextPacketId();
+    void receive(uint8_t c);
+    void handlePacket();
+    void close();
+
+    Client* m_Client;
+    MQTTCallback m_Callback;
+    uint8_t m_State;
+    uint16_t m_KeepAlive;
+    uint16_t m_PacketId;
+    unsigned long m_LastSent;
+    unsigned long m_LastReceived;
+
+    uint8_t m_RxState;
+    uint8_t m_RxHeader;
+    uint8_t m_RxShift;
+    uint32_t m_RxLength;
+    uint32_t m_RxPos;
+    uint8_t m_RxBuffer[MQTT_BUFFER_SIZE + 1];
+
+    uint8_t m_TxBuffer[MQTT_BUFFER_SIZE];
+
+    uint16_t m_InFlightId;
+    uint16_t m_InFlightStart;
+    uint16_t m_InFlightLength;
+    unsigned long m_InFlightSent;
+    uint8_t m_InFlight[MQTT_BUFFER_SIZE];
+};
+
+#endif /* MQTTCLIENT_H_ */
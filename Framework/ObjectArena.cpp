@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ObjectArena.h"
+
+/**
+ * \brief Constructor
+ *
+ * Starts with an empty arena.
+ */
+ObjectArena::ObjectArena() :
+        m_Used(0), m_HighWaterMark(0)
+{
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+ObjectArena::ObjectArena(const ObjectArena&)
+{
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+ObjectArena::ObjectArena(ObjectArena&)
+{
+}
+
+/**
+ * \brief Allocates a block from the arena.
+ * \param[in] size Number of bytes requested.
+ *
+ * The block is aligned to the size of a pointer.
+ *
+ * \returns Pointer to the block or NULL when the arena is exhausted.
+ */
+void* ObjectArena::allocate(size_t size)
+{
+    uint16_t start = (m_Used + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    if (size > sizeof(m_Pool) || start > sizeof(m_Pool) - size)
+        return NULL;
+
+    m_Used = start + size;
+    if (m_Used > m_HighWaterMark)
+        m_HighWaterMark = m_Used;
+
+    return &m_Pool[start];
+}
+
+/**
+ * \brief Gets the current fill level to rewind to later on.
+ *
+ * \returns The current fill level in bytes.
+ */
+uint16_t ObjectArena::getMark()
+{
+    return m_Used;
+}
+
+/**
+ * \brief Releases everything allocated after a mark was taken.
+ * \param[in] mark Mark returned by ObjectArena::getMark.
+ *
+ * Objects located behind the mark are not destructed. The caller has to make
+ * sure they are no longer referenced.
+ */
+void ObjectArena::rewind(uint16_t mark)
+{
+    if (mark < m_Used)
+        m_Used = mark;
+}
+
+/**
+ * \brief Getter for the size of the arena.
+ *
+ * \returns Size of the arena in bytes.
+ */
+uint16_t ObjectArena::getSize()
+{
+    return sizeof(m_Pool);
+}
+
+/**
+ * \brief Getter for the current fill level.
+ *
+ * \returns Number of bytes currently allocated.
+ */
+uint16_t ObjectArena::getUsed()
+{
+    return m_Used;
+}
+
+/**
+ * \brief Getter for the high-water mark.
+ *
+ * \returns Highest number of bytes ever allocated from this arena.
+ */
+uint16_t ObjectArena::getHighWaterMark()
+{
+    return m_HighWaterMark;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBJECTARENA_H_
+#define OBJECTARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Static arena for the objects created from the configuration.
+ *
+ * Sensors, actuators and controllers live as long as Aquaduino itself. They
+ * are therefore placement constructed into one statically allocated block of
+ * #OBJECT_ARENA_SIZE bytes instead of the heap. The arena is shared by all
+ * object types. Thus the number of objects a firmware image can hold is only
+ * limited by the arena size and the slot limits #MAX_ACTUATORS,
+ * #MAX_CONTROLLERS and #MAX_SENSORS.
+ *
+ * Allocation is a simple bump of the fill level. Memory is only given back by
+ * rewinding to a mark taken earlier. The highest fill level ever reached is
+ * kept as high-water mark to allow right-sizing #OBJECT_ARENA_SIZE.
+ */
+class ObjectArena
+{
+public:
+    ObjectArena();
+
+    void* allocate(size_t size);
+
+    uint16_t getMark();
+    void rewind(uint16_t mark);
+
+    uint16_t getSize();
+    uint16_t getUsed();
+    uint16_t getHighWaterMark();
+
+private:
+    ObjectArena(const ObjectArena&);
+    ObjectArena(ObjectArena&);
+
+    uint8_t m_Pool[OBJECT_ARENA_SIZE];
+    uint16_t m_Used;
+    uint16_t m_HighWaterMark;
+};
+
+#endif /* OBJECTARENA_H_ */
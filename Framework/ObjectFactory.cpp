@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ObjectFactory.h"
+#include <avr/pgmspace.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/GUIServer.h>
+
+#ifdef USE_ACTUATOR_DIGITALOUTPUT
+#include <Actuators/DigitalOutput.h>
+#endif
+#ifdef USE_CONTROLLER_LEVEL
+#include <Controller/LevelController.h>
+#endif
+#ifdef USE_CONTROLLER_TEMPERATURE
+#include <Controller/TemperatureController.h>
+#endif
+#ifdef USE_CONTROLLER_CLOCKTIMER
+#include <Controller/ClockTimerController.h>
+#endif
+#ifdef USE_SENSOR_DIGITALINPUT
+#include <Sensors/DigitalInput.h>
+#endif
+#ifdef USE_SENSOR_DS18S20
+#include <Sensors/DS18S20.h>
+#endif
+#if defined(USE_SENSOR_SERIALATLASPH) || defined(USE_SENSOR_SERIALATLASEC) \
+    || defined(USE_SENSOR_SERIALATLASORP)
+#include <Sensors/SerialAtlasSensor.h>
+#endif
+#ifdef USE_SENSOR_FLOW
+#include <Sensors/FlowSensor.h>
+#endif
+#ifdef USE_SENSOR_ANALOGINPUT
+#include <Sensors/AnalogInput.h>
+#endif
+
+/*
+ * GUIServer requests of the types. A request is only passed to objects of the
+ * type it is registered for.
+ */
+#ifdef USE_CONTROLLER_LEVEL
+static const GUIHandlerEntry levelControllerHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_LEVEL_CONTROLLER, &GUIServer::getLevelController },
+      { GUIServer::SET_LEVEL_CONTROLLER, &GUIServer::setLevelController },
+      { GUIServer::RESET_LEVEL_CONTROLLER, &GUIServer::resetLevelController },
+      { GUIServer::SET_LEVEL_CONTROLLER_NAME,
+        &GUIServer::setLevelControllerName },
+      { 0, NULL } };
+#endif
+
+#ifdef USE_CONTROLLER_TEMPERATURE
+static const GUIHandlerEntry temperatureControllerHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_TEMPERATURE_CONTROLLER,
+        &GUIServer::getTemperatureController },
+      { GUIServer::SET_TEMPERATURE_CONTROLLER,
+        &GUIServer::setTemperatureController },
+      { GUIServer::SET_TEMPERATURE_CONTROLLER_NAME,
+        &GUIServer::setTemperatureControllerName },
+      { 0, NULL } };
+#endif
+
+#ifdef USE_CONTROLLER_CLOCKTIMER
+static const GUIHandlerEntry clockTimerControllerHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_CLOCK_TIMERS, &GUIServer::getClockTimers },
+      { GUIServer::SET_CLOCK_TIMER, &GUIServer::setClockTimer },
+      { 0, NULL } };
+#endif
+
+#ifdef USE_SENSOR_DIGITALINPUT
+static const GUIHandlerEntry digitalInputHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_DIGITALINPUT_CONFIG, &GUIServer::getDigitalInputConfig },
+      { GUIServer::SET_DIGITALINPUT_CONFIG, &GUIServer::setDigitalInputConfig },
+      { 0, NULL } };
+#endif
+
+#ifdef USE_SENSOR_DS18S20
+static const GUIHandlerEntry ds18s20Handlers[] PROGMEM =
+    {
+      { GUIServer::SET_DS1820_ADDRESS, &GUIServer::setDS1820Address },
+      { GUIServer::GET_DS1820_RESOLUTION, &GUIServer::getDS1820Resolution },
+      { GUIServer::SET_DS1820_RESOLUTION, &GUIServer::setDS1820Resolution },
+      { 0, NULL } };
+#endif
+
+#if defined(USE_SENSOR_SERIALATLASPH) || defined(USE_SENSOR_SERIALATLASEC) \
+    || defined(USE_SENSOR_SERIALATLASORP)
+static const GUIHandlerEntry serialAtlasSensorHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_SERIAL_ATLAS_CONFIG, &GUIServer::getSerialAtlasConfig },
+      { GUIServer::SET_SERIAL_ATLAS_CONFIG, &GUIServer::setSerialAtlasConfig },
+      { GUIServer::CALIBRATE_SERIAL_ATLAS, &GUIServer::calibrateSerialAtlas },
+      { 0, NULL } };
+#endif
+
+#ifdef USE_SENSOR_FLOW
+static const GUIHandlerEntry flowSensorHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_FLOW_SENSOR, &GUIServer::getFlowSensor },
+      { GUIServer::SET_FLOW_SENSOR, &GUIServer::setFlowSensor },
+      { 0, NULL } };
+#endif
+
+#ifdef USE_SENSOR_ANALOGINPUT
+static const GUIHandlerEntry analogInputHandlers[] PROGMEM =
+    {
+      { GUIServer::GET_ANALOGINPUT_CONFIG, &GUIServer::getAnalogInputConfig },
+      { GUIServer::SET_ANALOGINPUT_CONFIG, &GUIServer::setAnalogInputConfig },
+      { 0, NULL } };
+#endif
+
+/*
+ * The type IDs are the ones used by Aquaduino-Config in aqua.cfg.
+ */
+static const ObjectFactoryEntry actuatorFactories[] PROGMEM =
+    {
+#ifdef USE_ACTUATOR_DIGITALOUTPUT
+      { 1, ACTUATOR_DIGITALOUTPUT, sizeof(DigitalOutput),
+        &DigitalOutput::create, NULL },
+#endif
+      { 0, OBJECT, 0, NULL, NULL } };
+
+static const ObjectFactoryEntry controllerFactories[] PROGMEM =
+    {
+#ifdef USE_CONTROLLER_LEVEL
+      { 1, CONTROLLER_LEVEL, sizeof(LevelController),
+        &LevelController::create, levelControllerHandlers },
+#endif
+#ifdef USE_CONTROLLER_TEMPERATURE
+      { 2, CONTROLLER_TEMPERATURE, sizeof(TemperatureController),
+        &TemperatureController::create, temperatureControllerHandlers },
+#endif
+#ifdef USE_CONTROLLER_CLOCKTIMER
+      { 3, CONTROLLER_CLOCKTIMER, sizeof(ClockTimerController),
+        &ClockTimerController::create, clockTimerControllerHandlers },
+#endif
+      { 0, OBJECT, 0, NULL, NULL } };
+
+static const ObjectFactoryEntry sensorFactories[] PROGMEM =
+    {
+#ifdef USE_SENSOR_DIGITALINPUT
+      { 1, SENSOR_DIGITALINPUT, sizeof(DigitalInput), &DigitalInput::create,
+        digitalInputHandlers },
+#endif
+#ifdef USE_SENSOR_DS18S20
+      { 2, SENSOR_DS18S20, sizeof(DS18S20), &DS18S20::create,
+        ds18s20Handlers },
+#endif
+#ifdef USE_SENSOR_SERIALATLASPH
+      { 3, SENSOR_SERIALINPUT, sizeof(SerialAtlasSensor),
+        &SerialAtlasSensor::createPH, serialAtlasSensorHandlers },
+#endif
+#ifdef USE_SENSOR_SERIALATLASEC
+      { 4, SENSOR_SERIALINPUT, sizeof(SerialAtlasSensor),
+        &SerialAtlasSensor::createEC, serialAtlasSensorHandlers },
+#endif
+#ifdef USE_SENSOR_SERIALATLASORP
+      { 5, SENSOR_SERIALINPUT, sizeof(SerialAtlasSensor),
+        &SerialAtlasSensor::createORP, serialAtlasSensorHandlers },
+#endif
+#ifdef USE_SENSOR_FLOW
+      { 6, SENSOR_FLOW, sizeof(FlowSensor), &FlowSensor::create,
+        flowSensorHandlers },
+#endif
+#ifdef USE_SENSOR_ANALOGINPUT
+      { 7, SENSOR_ANALOGINPUT, sizeof(AnalogInput), &AnalogInput::create,
+        analogInputHandlers },
+#endif
+      { 0, OBJECT, 0, NULL, NULL } };
+
+/**
+ * \brief Constructor
+ *
+ * Private & Empty.
+ */
+ObjectFactory::ObjectFactory()
+{
+}
+
+/**
+ * \brief Getter for the factory table of a kind of objects.
+ * \param[in] kind One of FACTORY_ACTUATORS, FACTORY_CONTROLLERS or
+ *                 FACTORY_SENSORS.
+ *
+ * \returns The table in PROGMEM. NULL for an unknown kind.
+ */
+const ObjectFactoryEntry* ObjectFactory::getTable(uint8_t kind)
+{
+    switch (kind)
+    {
+    case FACTORY_ACTUATORS:
+        return actuatorFactories;
+    case FACTORY_CONTROLLERS:
+        return controllerFactories;
+    case FACTORY_SENSORS:
+        return sensorFactories;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * \brief Looks up the factory entry of a type.
+ * \param[in] kind One of FACTORY_ACTUATORS, FACTORY_CONTROLLERS or
+ *                 FACTORY_SENSORS.
+ * \param[in] configId Type ID as stored in aqua.cfg.
+ * \param[out] entry The entry is copied from PROGMEM to this location.
+ *
+ * \returns 1 if the type is registered. 0 otherwise.
+ */
+int8_t ObjectFactory::lookup(uint8_t kind, uint8_t configId,
+                             ObjectFactoryEntry* entry)
+{
+    const ObjectFactoryEntry* table = getTable(kind);
+
+    if (table == NULL)
+        return 0;
+
+    for (;; table++)
+    {
+        memcpy_P(entry, table, sizeof(ObjectFactoryEntry));
+        if (entry->create == NULL)
+            return 0;
+        if (entry->configId == configId)
+            return 1;
+    }
+}
+
+/**
+ * \brief Creates an object in the given arena.
+ * \param[in] arena Arena providing the memory of the object.
+ * \param[in] kind One of FACTORY_ACTUATORS, FACTORY_CONTROLLERS or
+ *                 FACTORY_SENSORS.
+ * \param[in] configId Type ID as stored in aqua.cfg.
+ * \param[in] name Name of the object.
+ * \param[in] portId Port the object is attached to.
+ * \param[in] option Type specific option.
+ *
+ * Exactly the size registered for the type is taken from the arena.
+ *
+ * \returns The created object. NULL if the type is not available or the arena
+ * is exhausted.
+ */
+Object* ObjectFactory::create(ObjectArena* arena, uint8_t kind,
+                              uint8_t configId, const char* name,
+                              uint8_t portId, uint8_t option)
+{
+    ObjectFactoryEntry entry;
+    void* memory;
+
+    if (!lookup(kind, configId, &entry))
+        return NULL;
+
+    memory = arena->allocate(entry.size);
+    if (memory == NULL)
+        return NULL;
+
+    return entry.create(memory, name, portId, option);
+}
+
+/**
+ * \brief Looks up the GUIServer handler of a type specific request.
+ * \param[in] method Method ID of the request.
+ * \param[out] kind Kind of the objects the request addresses.
+ * \param[out] type Type the addressed object needs to have.
+ * \param[out] handler The entry is copied from PROGMEM to this location.
+ *
+ * \returns 1 if a type registered the request. 0 otherwise.
+ */
+int8_t ObjectFactory::lookupHandler(uint8_t method, uint8_t* kind,
+                                    int16_t* type, GUIHandlerEntry* handler)
+{
+    const ObjectFactoryEntry* table;
+    const GUIHandlerEntry* handlers;
+    ObjectFactoryEntry entry;
+    uint8_t k = FACTORY_ACTUATORS;
+
+    for (; k <= FACTORY_SENSORS; k++)
+    {
+        for (table = getTable(k);; table++)
+        {
+            memcpy_P(&entry, table, sizeof(ObjectFactoryEntry));
+            if (entry.create == NULL)
+                break;
+
+            for (handlers = entry.handlers; handlers != NULL; handlers++)
+            {
+                memcpy_P(handler, handlers, sizeof(GUIHandlerEntry));
+                if (handler->handler == NULL)
+                    break;
+                if (handler->method == method)
+                {
+                    *kind = k;
+                    *type = entry.type;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBJECTFACTORY_H_
+#define OBJECTFACTORY_H_
+
+#include <stdint.h>
+#include <Framework/Object.h>
+#include <Framework/ObjectArena.h>
+
+struct GUIHandlerEntry;
+
+/**
+ * \brief Kinds of objects that can be created from the configuration.
+ */
+enum
+{
+    FACTORY_ACTUATORS,
+    FACTORY_CONTROLLERS,
+    FACTORY_SENSORS
+};
+
+/**
+ * \brief Placement constructor registered by a concrete class.
+ * \param[in] memory Memory of at least ObjectFactoryEntry::size bytes.
+ * \param[in] name Name of the object.
+ * \param[in] portId Port the object is attached to.
+ * \param[in] option Type specific option (e.g. on value of an actuator).
+ *
+ * \returns The constructed object.
+ */
+typedef Object* (*ObjectCreator)(void* memory, const char* name,
+                                 uint8_t portId, uint8_t option);
+
+/**
+ * \brief Entry of the factory tables stored in PROGMEM.
+ */
+struct ObjectFactoryEntry
+{
+    /**
+     * \brief Type ID used in aqua.cfg.
+     */
+    uint8_t configId;
+
+    /**
+     * \brief Type returned by Object::getType of the instances.
+     */
+    int16_t type;
+
+    /**
+     * \brief Size of an instance in bytes.
+     */
+    uint16_t size;
+
+    /**
+     * \brief Placement constructor of the class.
+     */
+    ObjectCreator create;
+
+    /**
+     * \brief GUIServer requests specific to the type. List in PROGMEM
+     * terminated by a NULL handler. NULL if there are none.
+     */
+    const GUIHandlerEntry* handlers;
+};
+
+/**
+ * \brief Creates actuators, controllers and sensors by their configuration
+ * type ID.
+ *
+ * The available types are registered in PROGMEM tables in ObjectFactory.cpp.
+ * Each concrete class provides a static create method which is listed there
+ * together with its type, its size and the GUIServer requests handling it.
+ * Types can be removed from the build by undefining the corresponding USE_*
+ * switch in FrameworkConfig.h.
+ */
+class ObjectFactory
+{
+public:
+    static int8_t lookup(uint8_t kind, uint8_t configId,
+                         ObjectFactoryEntry* entry);
+    static Object* create(ObjectArena* arena, uint8_t kind, uint8_t configId,
+                          const char* name, uint8_t portId, uint8_t option);
+    static int8_t lookupHandler(uint8_t method, uint8_t* kind, int16_t* type,
+                                GUIHandlerEntry* handler);
+
+private:
+    ObjectFactory();
+    static const ObjectFactoryEntry* getTable(uint8_t kind);
+};
+
+#endif /* OBJECTFACTORY_H_ */
@@ -34,7 +34,9 @@ enum
     CONTROLLER_CLOCKTIMER,
     SENSOR_DIGITALINPUT,
     SENSOR_DS18S20,
-    SENSOR_SERIALINPUT
+    SENSOR_SERIALINPUT,
+    SENSOR_FLOW,
+    SENSOR_ANALOGINPUT
 };
 
 #endif /* OBJECTTYPES_H_ */
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "OneWireAsync.h"
+#include <Arduino.h>
+#include <OneWire.h>
+#include <avr/interrupt.h>
+
+/**
+ * \brief Timer1 ticks per microsecond at a prescaler of 8
+ */
+#define TICKS_PER_US (F_CPU / 8000000UL)
+
+/**
+ * \brief Phases of the interrupt state machine
+ */
+enum
+{
+    PHASE_RESET_LOW,
+    PHASE_RESET_RELEASE,
+    PHASE_RESET_SAMPLE,
+    PHASE_SLOT,
+    PHASE_WRITE0_RELEASE
+};
+
+/*
+ * Driver owning Timer1 for the current transaction.
+ */
+static OneWireAsync* activeDriver = NULL;
+
+/**
+ * \brief Default constructor
+ */
+OneWireAsync::OneWireAsync() :
+        m_BaseReg(NULL), m_BitMask(0), m_TxBits(0), m_Bits(0), m_Bit(0),
+        m_Flags(0), m_Phase(PHASE_SLOT), m_Presence(0), m_Busy(0),
+        m_EndTime(0)
+{
+    memset(m_Buffer, 0, sizeof(m_Buffer));
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+OneWireAsync::OneWireAsync(const OneWireAsync&)
+{
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+OneWireAsync::OneWireAsync(OneWireAsync&)
+{
+}
+
+/**
+ * \brief Starts a transaction
+ * \param[in] pin Pin of the bus
+ * \param[in] tx Bytes to be sent
+ * \param[in] txLength Number of bytes to be sent
+ * \param[in] rxLength Number of bytes to be received after sending
+ * \param[in] flags ONEWIRE_ASYNC_RESET to start with a reset.
+ *                  ONEWIRE_ASYNC_POWER to drive the bus high at the end for
+ *                  parasite powered devices.
+ *
+ * \returns 0 when the transaction was started. -1 when a transaction is
+ * still running or the buffer is too small.
+ */
+int8_t OneWireAsync::start(uint8_t pin, const uint8_t* tx, uint8_t txLength,
+                           uint8_t rxLength, uint8_t flags)
+{
+    uint8_t oldSREG;
+
+    if (txLength + rxLength > sizeof(m_Buffer))
+        return -1;
+    if (activeDriver != NULL && activeDriver->isBusy())
+        return -1;
+
+    memcpy(m_Buffer, tx, txLength);
+    memset(&m_Buffer[txLength], 0, rxLength);
+    m_BaseReg = PIN_TO_BASEREG(pin);
+    m_BitMask = PIN_TO_BITMASK(pin);
+    m_TxBits = txLength * 8;
+    m_Bits = (txLength + rxLength) * 8;
+    m_Bit = 0;
+    m_Flags = flags;
+    m_Presence = 0;
+    m_Phase = (flags & ONEWIRE_ASYNC_RESET) ? PHASE_RESET_LOW : PHASE_SLOT;
+    m_Busy = 1;
+    activeDriver = this;
+
+    oldSREG = SREG;
+    cli();
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS11); // CTC mode, clk/8
+    TCNT1 = 0;
+    OCR1A = 10 * TICKS_PER_US;
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 |= _BV(OCIE1A);
+    SREG = oldSREG;
+
+    return 0;
+}
+
+/**
+ * \brief Checks whether a transaction is running
+ *
+ * \returns 1 while the transaction is running. 0 otherwise.
+ */
+uint8_t OneWireAsync::isBusy()
+{
+    return m_Busy;
+}
+
+/**
+ * \brief Getter for the presence pulse of the last transaction
+ *
+ * \returns 1 when a device answered the reset. 0 otherwise.
+ */
+uint8_t OneWireAsync::getPresence()
+{
+    return m_Presence;
+}
+
+/**
+ * \brief Fetches the bytes received by the last transaction
+ * \param[out] rx Buffer for the received bytes
+ * \param[in] size Size of the buffer
+ *
+ * \returns Number of bytes copied. -1 while the transaction is running.
+ */
+int8_t OneWireAsync::getResult(uint8_t* rx, uint8_t size)
+{
+    uint8_t length;
+
+    if (m_Busy)
+        return -1;
+
+    length = (m_Bits - m_TxBits) / 8;
+    if (length > size)
+        length = size;
+    memcpy(rx, &m_Buffer[m_TxBits / 8], length);
+    return length;
+}
+
+/**
+ * \brief Getter for the end of the last transaction
+ *
+ * \returns Value of millis() when the last transaction completed.
+ */
+unsigned long OneWireAsync::getEndTime()
+{
+    unsigned long time;
+    uint8_t oldSREG = SREG;
+
+    cli();
+    time = m_EndTime;
+    SREG = oldSREG;
+    return time;
+}
+
+/**
+ * \brief Programs the next compare match
+ * \param[in] us Time in microseconds relative to the last compare match
+ *
+ * Timer1 is cleared on compare match. Thus the time already spent in the
+ * interrupt counts towards the interval. If it is already exceeded the next
+ * match is scheduled immediately.
+ */
+void OneWireAsync::schedule(uint16_t us)
+{
+    uint16_t ticks = us * TICKS_PER_US;
+
+    if (TCNT1 + 4 >= ticks)
+        ticks = TCNT1 + 4;
+    OCR1A = ticks;
+}
+
+/**
+ * \brief Ends the transaction and stops Timer1
+ */
+void OneWireAsync::finish()
+{
+    if (m_Flags & ONEWIRE_ASYNC_POWER)
+    {
+        DIRECT_WRITE_HIGH(m_BaseReg, m_BitMask);
+        DIRECT_MODE_OUTPUT(m_BaseReg, m_BitMask);
+    }
+    TIMSK1 &= ~_BV(OCIE1A);
+    TCCR1B = 0;
+    m_EndTime = millis();
+    m_Busy = 0;
+}
+
+/**
+ * \brief Advances the transaction by one phase
+ *
+ * Called from the compare match interrupt of Timer1. Slots are 70 µs long.
+ * The low time of a 1 and the sampling of a read slot are busy waited as they
+ * are shorter than 15 µs. The low time of a 0 and the reset pulse are timed
+ * by the timer.
+ */
+void OneWireAsync::handleInterrupt()
+{
+    volatile uint8_t* reg = m_BaseReg;
+    uint8_t mask = m_BitMask;
+    uint8_t* byte;
+    uint8_t bit;
+
+    switch (m_Phase)
+    {
+    case PHASE_RESET_LOW:
+        DIRECT_WRITE_LOW(reg, mask);
+        DIRECT_MODE_OUTPUT(reg, mask);
+        m_Phase = PHASE_RESET_RELEASE;
+        schedule(480);
+        break;
+    case PHASE_RESET_RELEASE:
+        DIRECT_MODE_INPUT(reg, mask);
+        m_Phase = PHASE_RESET_SAMPLE;
+        schedule(70);
+        break;
+    case PHASE_RESET_SAMPLE:
+        m_Presence = !DIRECT_READ(reg, mask);
+        m_Phase = PHASE_SLOT;
+        schedule(410);
+        break;
+    case PHASE_WRITE0_RELEASE:
+        DIRECT_MODE_INPUT(reg, mask);
+        m_Phase = PHASE_SLOT;
+        schedule(10);
+        break;
+    default:
+        if (m_Bit == m_Bits)
+        {
+            finish();
+            break;
+        }
+
+        byte = &m_Buffer[m_Bit >> 3];
+        bit = 1 << (m_Bit & 7);
+        DIRECT_WRITE_LOW(reg, mask);
+        DIRECT_MODE_OUTPUT(reg, mask);
+        if (m_Bit < m_TxBits)
+        {
+            if (*byte & bit)
+            {
+                delayMicroseconds(6);
+                DIRECT_MODE_INPUT(reg, mask);
+                schedule(70);
+            }
+            else
+            {
+                m_Phase = PHASE_WRITE0_RELEASE;
+                schedule(60);
+            }
+        }
+        else
+        {
+            delayMicroseconds(3);
+            DIRECT_MODE_INPUT(reg, mask);
+            delayMicroseconds(10);
+            if (DIRECT_READ(reg, mask))
+                *byte |= bit;
+            schedule(70);
+        }
+        m_Bit++;
+        break;
+    }
+}
+
+#ifdef ONEWIRE_ASYNC
+ISR(TIMER1_COMPA_vect)
+{
+    if (activeDriver != NULL)
+        activeDriver->handleInterrupt();
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ONEWIREASYNC_H_
+#define ONEWIREASYNC_H_
+
+#include <stdint.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Flags of a OneWireAsync transaction
+ */
+enum
+{
+    ONEWIRE_ASYNC_RESET = 1, ONEWIRE_ASYNC_POWER = 2
+};
+
+/**
+ * \brief Timer driven OneWire transactions
+ *
+ * OneWire::reset(), OneWire::write_bit() and OneWire::read_bit() busy wait for
+ * the complete slot. A scratchpad read blocks the CPU for several
+ * milliseconds. OneWireAsync clocks the slots from the compare match interrupt
+ * of Timer1 instead. Only the parts of a slot shorter than 15 µs are busy
+ * waited inside the interrupt. The time in between is left to the main loop
+ * and other interrupts.
+ *
+ * A transaction consists of an optional reset, the bytes to send and the
+ * number of bytes to receive afterwards. It is started by
+ * OneWireAsync::start and runs in the background. Its result is fetched by
+ * OneWireAsync::getResult once OneWireAsync::isBusy returns 0. As there is
+ * only one timer there is only one transaction at a time for all buses.
+ */
+class OneWireAsync
+{
+public:
+    OneWireAsync();
+
+    int8_t start(uint8_t pin, const uint8_t* tx, uint8_t txLength,
+                 uint8_t rxLength, uint8_t flags);
+    uint8_t isBusy();
+    uint8_t getPresence();
+    int8_t getResult(uint8_t* rx, uint8_t size);
+    unsigned long getEndTime();
+
+    void handleInterrupt();
+
+private:
+    OneWireAsync(const OneWireAsync&);
+    OneWireAsync(OneWireAsync&);
+
+    void schedule(uint16_t us);
+    void finish();
+
+    volatile uint8_t* m_BaseReg;
+    uint8_t m_BitMask;
+    uint8_t m_Buffer[ONEWIRE_ASYNC_BUFFER_SIZE];
+    uint16_t m_TxBits;
+    uint16_t m_Bits;
+    uint16_t m_Bit;
+    uint8_t m_Flags;
+    uint8_t m_Phase;
+    uint8_t m_Presence;
+    volatile uint8_t m_Busy;
+    volatile unsigned long m_EndTime;
+};
+
+#endif /* ONEWIREASYNC_H_ */
@@ -28,6 +28,23 @@ OneWireHandler::OneWireHandler()
     memset(m_OneWires, 0, sizeof(m_OneWires));
     memset(m_Used, 0, sizeof(m_Used));
     memset(m_Pins, 0, sizeof(m_Pins));
+    memset(m_State, ONEWIRE_IDLE, sizeof(m_State));
+    memset(m_Conversion, 0, sizeof(m_Conversion));
+    memset(m_Parasite, 0, sizeof(m_Parasite));
+    memset(m_ConversionTime, 0, sizeof(m_ConversionTime));
+    memset(m_ConversionStart, 0, sizeof(m_ConversionStart));
+    memset(m_Devices, 0, sizeof(m_Devices));
+    m_NrOfDevices = 0;
+    memset(m_Resolutions, 0, sizeof(m_Resolutions));
+    m_NrOfResolutions = 0;
+    m_SearchBus = 0;
+#ifdef ONEWIRE_ASYNC
+    m_AsyncBus = 0;
+    memset(m_AsyncAddress, 0, sizeof(m_AsyncAddress));
+    m_AsyncPending = 0;
+    m_AsyncPoll = 0;
+    memset(m_ReadRequested, 0, sizeof(m_ReadRequested));
+#endif
 }
 
 /**
@@ -38,7 +55,14 @@ OneWireHandler::~OneWireHandler()
 }
 
 /**
- * \brief
+ * \brief Registers a OneWire bus
+ * \param[in] pin Pin the bus is attached to
+ *
+ * New buses are checked for parasite powered devices using Read Power Supply.
+ * Registering a pin again returns the existing bus. Each registration needs
+ * to be released by OneWireHandler::removePin.
+ *
+ * \returns Index of the bus. -1 if all buses are in use.
  */
 int8_t OneWireHandler::addPin(uint8_t pin)
 {
@@ -46,12 +70,24 @@ int8_t OneWireHandler::addPin(uint8_t pin)
 
     for (; i < MAX_ONEWIRE_DEVICES; i++)
     {
-        if (m_Pins[i] == pin)
+        if (m_OneWires[i] != NULL && m_Pins[i] == pin)
+        {
+            m_Used[i]++;
             return i;
+        }
+    }
+
+    for (i = 0; i < MAX_ONEWIRE_DEVICES; i++)
+    {
         if (m_OneWires[i] == NULL)
         {
             m_Pins[i] = pin;
+            m_Used[i] = 1;
             m_OneWires[i] = new OneWire(pin);
+            m_OneWires[i]->reset();
+            m_OneWires[i]->skip();
+            m_OneWires[i]->write(0xB4); // Read Power Supply
+            m_Parasite[i] = !m_OneWires[i]->read_bit();
             return i;
         }
     }
@@ -60,46 +96,311 @@ int8_t OneWireHandler::addPin(uint8_t pin)
 }
 
 /**
- * \brief Scans for OneWire devices
- * \param[in] idx Index of OneWire object to be used
- * \param[out] address Buffer where this method stores the address of the
- * device found
- * \param[in] size Size of the buffer. Needs to be at least 8 bytes.
+ * \brief Releases a registration of a OneWire bus
+ * \param[in] idx Index returned by OneWireHandler::addPin
  *
- * \returns 1 when device found. 0 otherwise
+ * The bus is deleted together with its inventory entries when the last
+ * registration is released.
  */
-int8_t OneWireHandler::findDevice(uint8_t idx, uint8_t *address, uint8_t size)
+void OneWireHandler::removePin(uint8_t idx)
 {
-    if (m_OneWires[idx] == NULL || size < 8)
-        return 0;
+    uint8_t i = 0;
 
-    if (!m_OneWires[idx]->search(address))
+    if (idx >= MAX_ONEWIRE_DEVICES || m_OneWires[idx] == NULL
+        || --m_Used[idx] > 0)
+        return;
+
+#ifdef ONEWIRE_ASYNC
+    while (m_Async.isBusy())
+        ;
+    if (m_AsyncBus == idx)
     {
-        m_OneWires[idx]->reset_search();
-        return 0;
+        m_AsyncPending = 0;
+        m_AsyncPoll = 0;
     }
+    m_ReadRequested[idx] = 0;
+#endif
 
-    if (OneWire::crc8(address, 7) != address[7])
+    delete m_OneWires[idx];
+    m_OneWires[idx] = NULL;
+    m_State[idx] = ONEWIRE_IDLE;
+    m_Parasite[idx] = 0;
+    m_ConversionTime[idx] = 0;
+
+    while (i < m_NrOfDevices)
     {
-        return 0;
+        if (m_Devices[i].bus == idx)
+            m_Devices[i] = m_Devices[--m_NrOfDevices];
+        else
+            i++;
+    }
+
+    i = 0;
+    while (i < m_NrOfResolutions)
+    {
+        if (m_Resolutions[i].bus == idx)
+            m_Resolutions[i] = m_Resolutions[--m_NrOfResolutions];
+        else
+            i++;
+    }
+
+    while (m_OneWires[m_SearchBus] == NULL)
+    {
+        m_SearchBus = (m_SearchBus + 1) % MAX_ONEWIRE_DEVICES;
+        if (m_SearchBus == idx)
+            break;
     }
-    return 1;
 }
 
 /**
- * \brief Issue OneWire read command to given address
+ * \brief Drives the conversion state machines of all buses
+ *
+ * Idle buses get a broadcast conversion command. Buses whose conversion
+ * is complete are marked as converted and their conversion counter is
+ * incremented. Completion is detected by a read slot on externally powered
+ * buses and by the conversion time otherwise. A converted bus starts the next
+ * conversion on the following call so that all devices can read their
+ * scratchpad in between. Right before that the bus currently enumerated does
+ * one search step, so no search traffic falls into a conversion. Other
+ * commands sent to a converting bus restart its conversion, see
+ * OneWireHandler::restartConversion.
+ *
+ * In asynchronous mode a bus stays in the starting state until the conversion
+ * command is sent. The read slots polling externally powered buses are
+ * transactions of one byte. A converted bus waits until no device requested
+ * its scratchpad during the last pass and no transaction is running. A
+ * scratchpad not fetched by its device within one pass is dropped.
+ */
+void OneWireHandler::run()
+{
+    uint8_t i = 0;
+    uint16_t time;
+#ifdef ONEWIRE_ASYNC
+    uint8_t ready;
+#endif
+
+#ifdef ONEWIRE_ASYNC
+    if (m_AsyncPending && !m_Async.isBusy() && ++m_AsyncPending > 2)
+        m_AsyncPending = 0;
+#endif
+
+    for (; i < MAX_ONEWIRE_DEVICES; i++)
+    {
+        if (m_OneWires[i] == NULL)
+            continue;
+
+        switch (m_State[i])
+        {
+#ifdef ONEWIRE_ASYNC
+        case ONEWIRE_STARTING:
+            if (m_Async.isBusy())
+                break;
+            m_ConversionStart[i] = m_Async.getEndTime();
+            m_State[i] = ONEWIRE_CONVERTING;
+            break;
+#endif
+        case ONEWIRE_CONVERTING:
+            time = m_ConversionTime[i];
+            if (time == 0)
+                time = getConversionTime(12);
+#ifdef ONEWIRE_ASYNC
+            ready = 0;
+            if (m_AsyncPoll && m_AsyncBus == i)
+            {
+                if (m_Async.isBusy())
+                    break;
+                m_AsyncPoll = 0;
+                m_Async.getResult(&ready, 1);
+            }
+            else if (!m_Parasite[i] && !m_AsyncPending && !m_AsyncPoll
+                     && m_Async.start(m_Pins[i], NULL, 0, 1, 0) == 0)
+            {
+                m_AsyncBus = i;
+                m_AsyncPoll = 1;
+            }
+            if (ready || millis() - m_ConversionStart[i] >= time)
+#else
+            if ((!m_Parasite[i] && m_OneWires[i]->read_bit())
+                || millis() - m_ConversionStart[i] >= time)
+#endif
+            {
+                m_Conversion[i]++;
+                m_State[i] = ONEWIRE_CONVERTED;
+            }
+            break;
+        default:
+#ifdef ONEWIRE_ASYNC
+            if (m_ReadRequested[i] || m_AsyncPending || m_AsyncPoll
+                || m_Async.isBusy())
+            {
+                m_ReadRequested[i] = 0;
+                break;
+            }
+#endif
+            if (i == m_SearchBus)
+                discover(i);
+            startConversion(i);
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Getter for the conversion counter of a bus
  * \param[in] idx Index of OneWire object to be used
- * \param[in] addr The address of the OneWire device to read from
+ *
+ * \returns Number of conversions completed on the bus (wrapping). Devices
+ * compare it against the value seen on their last read to detect new data.
  */
-void OneWireHandler::issueReadCommand(uint8_t idx, uint8_t* addr)
+uint8_t OneWireHandler::getConversion(uint8_t idx)
 {
-    int8_t i = 0;
-    if (m_OneWires[idx] == NULL)
+    if (idx >= MAX_ONEWIRE_DEVICES)
+        return 0;
+    return m_Conversion[idx];
+}
+
+/**
+ * \brief Issues a conversion to all devices on a bus
+ * \param[in] idx Index of OneWire object to be used
+ */
+void OneWireHandler::startConversion(uint8_t idx)
+{
+#ifdef ONEWIRE_ASYNC
+    const uint8_t command[] = { 0xCC, 0x44 }; // skip ROM, start conversion
+
+    m_Async.start(m_Pins[idx], command, sizeof(command), 0,
+                  ONEWIRE_ASYNC_RESET
+                  | (m_Parasite[idx] ? ONEWIRE_ASYNC_POWER : 0));
+    m_AsyncBus = idx;
+    m_State[idx] = ONEWIRE_STARTING;
+#else
+    m_OneWires[idx]->reset();
+    m_OneWires[idx]->skip();
+    m_OneWires[idx]->write(0x44, m_Parasite[idx]); // start conversion, with parasite power on at the end
+    m_ConversionStart[idx] = millis();
+    m_State[idx] = ONEWIRE_CONVERTING;
+#endif
+}
+
+/**
+ * \brief Issues the conversion of a bus again after other traffic on it
+ * \param[in] idx Index of OneWire object to be used
+ *
+ * Once another command was sent during a conversion the read slots no longer
+ * report its status but read 1 at once. The reset also drops the strong
+ * pullup parasite powered devices convert with. A bus that is converting
+ * therefore starts over. The conversion command is sent blocking as the bus
+ * was just used blocking.
+ */
+void OneWireHandler::restartConversion(uint8_t idx)
+{
+    if (m_State[idx] != ONEWIRE_STARTING && m_State[idx] != ONEWIRE_CONVERTING)
         return;
 
+#ifdef ONEWIRE_ASYNC
+    if (m_AsyncBus == idx)
+        m_AsyncPoll = 0;
+#endif
     m_OneWires[idx]->reset();
-    m_OneWires[idx]->select(addr);
-    m_OneWires[idx]->write(0x44, 1); // start conversion, with parasite power on at the end
+    m_OneWires[idx]->skip();
+    m_OneWires[idx]->write(0x44, m_Parasite[idx]);
+    m_ConversionStart[idx] = millis();
+    m_State[idx] = ONEWIRE_CONVERTING;
+}
+
+/**
+ * \brief Does one search step on a bus
+ * \param[in] idx Index of OneWire object to be used
+ *
+ * A device found with a valid CRC is added to the inventory. When the search
+ * of the bus is complete the next registered bus is enumerated.
+ */
+void OneWireHandler::discover(uint8_t idx)
+{
+    uint8_t address[8];
+
+    if (m_OneWires[idx]->search(address))
+    {
+        if (OneWire::crc8(address, 7) == address[7])
+            updateInventory(idx, address);
+        return;
+    }
+
+    m_OneWires[idx]->reset_search();
+    do
+    {
+        m_SearchBus = (m_SearchBus + 1) % MAX_ONEWIRE_DEVICES;
+    } while (m_OneWires[m_SearchBus] == NULL && m_SearchBus != idx);
+}
+
+/**
+ * \brief Adds or refreshes an inventory entry
+ * \param[in] idx Index of the bus the device was found on
+ * \param[in] address ROM ID of the device
+ *
+ * When the inventory is full the entry seen least recently is replaced.
+ */
+void OneWireHandler::updateInventory(uint8_t idx, uint8_t* address)
+{
+    uint8_t i = 0;
+    uint8_t oldest = 0;
+    unsigned long now = millis();
+
+    for (; i < m_NrOfDevices; i++)
+    {
+        if (m_Devices[i].bus == idx
+            && memcmp(m_Devices[i].address, address, 8) == 0)
+            break;
+        if (now - m_Devices[i].lastSeen > now - m_Devices[oldest].lastSeen)
+            oldest = i;
+    }
+
+    if (i == m_NrOfDevices)
+    {
+        if (m_NrOfDevices < MAX_ONEWIRE_INVENTORY)
+            m_NrOfDevices++;
+        else
+            i = oldest;
+        memcpy(m_Devices[i].address, address, 8);
+        m_Devices[i].bus = idx;
+    }
+    m_Devices[i].lastSeen = now;
+}
+
+/**
+ * \brief Getter for the pin of a bus
+ * \param[in] idx Index of OneWire object
+ *
+ * \returns Pin the bus is attached to.
+ */
+uint8_t OneWireHandler::getPin(uint8_t idx)
+{
+    if (idx >= MAX_ONEWIRE_DEVICES)
+        return 0;
+    return m_Pins[idx];
+}
+
+/**
+ * \brief Getter for the number of devices in the inventory
+ *
+ * \returns Number of inventory entries.
+ */
+uint8_t OneWireHandler::getNrOfDevices()
+{
+    return m_NrOfDevices;
+}
+
+/**
+ * \brief Getter for an inventory entry
+ * \param[in] i Index of the entry
+ *
+ * \returns The entry. NULL if the index is out of range.
+ */
+const OneWireDevice* OneWireHandler::getDevice(uint8_t i)
+{
+    if (i >= m_NrOfDevices)
+        return NULL;
+    return &m_Devices[i];
 }
 
 /**
@@ -108,13 +409,72 @@ void OneWireHandler::issueReadCommand(uint8_t idx, uint8_t* addr)
  * \param[in] addr Address of the OneWire device
  * \param[out] data Buffer for the data
  * \param[in] size Size of the buffer. Needs to be at least 12 Bytes.
+ *
+ * In asynchronous mode the first call starts the transfer. The scratchpad is
+ * returned by the first call after the transfer completed. Otherwise a
+ * conversion running on the bus is restarted afterwards.
+ *
+ * \returns 0 when the CRC of the scratchpad is valid. -1 otherwise. 1 while
+ * the transfer is pending in asynchronous mode.
  */
 int8_t OneWireHandler::read(uint8_t idx, uint8_t* addr, uint8_t* data, uint8_t size)
 {
-    int8_t i = 0;
+#ifdef ONEWIRE_ASYNC
+    uint8_t command[10];
+#else
+    int8_t retval;
+#endif
 
-    if (m_OneWires[idx] == NULL || size < 12)
-        return 0;
+    if (idx >= MAX_ONEWIRE_DEVICES || m_OneWires[idx] == NULL || size < 12)
+        return -1;
+
+#ifdef ONEWIRE_ASYNC
+    m_ReadRequested[idx] = 1;
+    if (m_Async.isBusy() || m_AsyncPoll)
+        return 1;
+
+    if (m_AsyncPending)
+    {
+        if (m_AsyncBus != idx || memcmp(m_AsyncAddress, addr, 8) != 0)
+            return 1;
+        m_AsyncPending = 0;
+        m_Async.getResult(data, 9);
+        if (OneWire::crc8(data, 8) == data[8])
+            return 0;
+        else
+            return -1;
+    }
+
+    command[0] = 0x55; // Match ROM
+    memcpy(&command[1], addr, 8);
+    command[9] = 0xBE; // Read Scratchpad
+    if (m_Async.start(m_Pins[idx], command, sizeof(command), 9,
+                      ONEWIRE_ASYNC_RESET) == 0)
+    {
+        m_AsyncBus = idx;
+        memcpy(m_AsyncAddress, addr, 8);
+        m_AsyncPending = 1;
+    }
+    return 1;
+#else
+    retval = readScratchpad(idx, addr, data);
+    restartConversion(idx);
+    return retval;
+#endif
+}
+
+/**
+ * \brief Reads the scratchpad of the OneWire device blocking.
+ * \param[in] idx Index of OneWire object to be used
+ * \param[in] addr Address of the OneWire device
+ * \param[out] data Buffer for the data. Needs to be at least 9 Bytes.
+ *
+ * \returns 0 when the CRC of the scratchpad is valid. -1 otherwise.
+ */
+int8_t OneWireHandler::readScratchpad(uint8_t idx, uint8_t* addr,
+                                      uint8_t* data)
+{
+    int8_t i = 0;
 
     m_OneWires[idx]->reset();
     m_OneWires[idx]->select(addr);
@@ -130,3 +490,143 @@ int8_t OneWireHandler::read(uint8_t idx, uint8_t* addr, uint8_t* data, uint8_t s
     else
         return -1;
 }
+
+/**
+ * \brief Writes the resolution to the scratchpad of a DS18B20 or DS1822
+ * \param[in] idx Index of OneWire object to be used
+ * \param[in] addr Address of the OneWire device
+ * \param[in] resolution Resolution in bits. Valid values are 9 to 12.
+ *
+ * The alarm bytes TH and TL are preserved. The DS18S20 has a fixed resolution
+ * and is left untouched. The resolution of the device is remembered until it
+ * is released by OneWireHandler::removeResolution. The conversion time of the
+ * bus is the one of the highest resolution remembered for it. Buses without
+ * any configured device use the 12 bit conversion time. So does a bus with a
+ * device that could not be configured. A conversion running on the bus is
+ * restarted.
+ *
+ * \returns 0 on success. -1 otherwise.
+ */
+int8_t OneWireHandler::setResolution(uint8_t idx, uint8_t* addr,
+                                     uint8_t resolution)
+{
+    uint8_t data[12];
+    uint8_t i = 0;
+    int8_t retval = 0;
+
+    if (resolution < 9 || resolution > 12 || idx >= MAX_ONEWIRE_DEVICES
+        || m_OneWires[idx] == NULL)
+        return -1;
+
+#ifdef ONEWIRE_ASYNC
+    while (m_Async.isBusy())
+        ;
+#endif
+
+    if (addr[0] == 0x10)
+        resolution = 12;
+    else
+    {
+        if (readScratchpad(idx, addr, data))
+        {
+            resolution = 12;
+            retval = -1;
+        }
+        else
+        {
+            m_OneWires[idx]->reset();
+            m_OneWires[idx]->select(addr);
+            m_OneWires[idx]->write(0x4E); // Write Scratchpad
+            m_OneWires[idx]->write(data[2]);
+            m_OneWires[idx]->write(data[3]);
+            m_OneWires[idx]->write(((resolution - 9) << 5) | 0x1F);
+        }
+        restartConversion(idx);
+    }
+
+    for (; i < m_NrOfResolutions; i++)
+    {
+        if (m_Resolutions[i].bus == idx
+            && memcmp(m_Resolutions[i].address, addr, 8) == 0)
+            break;
+    }
+
+    if (i < MAX_SENSORS)
+    {
+        if (i == m_NrOfResolutions)
+        {
+            m_NrOfResolutions++;
+            memcpy(m_Resolutions[i].address, addr, 8);
+            m_Resolutions[i].bus = idx;
+        }
+        m_Resolutions[i].resolution = resolution;
+        updateConversionTime(idx);
+    }
+    else if (getConversionTime(resolution) > m_ConversionTime[idx])
+        m_ConversionTime[idx] = getConversionTime(resolution);
+
+    return retval;
+}
+
+/**
+ * \brief Forgets the resolution of a device
+ * \param[in] idx Index of OneWire object the device is attached to
+ * \param[in] addr Address of the OneWire device
+ *
+ * Called when the device is no longer read or changes its address. The
+ * conversion time of the bus is recalculated from the remaining devices.
+ */
+void OneWireHandler::removeResolution(uint8_t idx, uint8_t* addr)
+{
+    uint8_t i = 0;
+
+    for (; i < m_NrOfResolutions; i++)
+    {
+        if (m_Resolutions[i].bus == idx
+            && memcmp(m_Resolutions[i].address, addr, 8) == 0)
+        {
+            m_Resolutions[i] = m_Resolutions[--m_NrOfResolutions];
+            updateConversionTime(idx);
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Recalculates the conversion time of a bus
+ * \param[in] idx Index of OneWire object
+ *
+ * The conversion time is the one of the highest resolution of all devices
+ * registered for the bus. 0 if there is none.
+ */
+void OneWireHandler::updateConversionTime(uint8_t idx)
+{
+    uint8_t i = 0;
+    uint16_t time;
+
+    m_ConversionTime[idx] = 0;
+    for (; i < m_NrOfResolutions; i++)
+    {
+        if (m_Resolutions[i].bus != idx)
+            continue;
+        time = getConversionTime(m_Resolutions[i].resolution);
+        if (time > m_ConversionTime[idx])
+            m_ConversionTime[idx] = time;
+    }
+}
+
+/**
+ * \brief Calculates the conversion time of a resolution
+ * \param[in] resolution Resolution in bits (9 - 12)
+ *
+ * \returns Conversion time in milliseconds rounded up, i.e. 94, 188, 376 or
+ * 751 ms.
+ */
+uint16_t OneWireHandler::getConversionTime(uint8_t resolution)
+{
+    if (resolution > 12)
+        resolution = 12;
+    else if (resolution < 9)
+        resolution = 9;
+    return (ONEWIRE_CONVERSION_TIME >> (12 - resolution)) + 1;
+}
@@ -23,9 +23,85 @@
 
 #include <OneWire.h>
 #include <Framework/FrameworkConfig.h>
+#ifdef ONEWIRE_ASYNC
+#include <Framework/OneWireAsync.h>
+#endif
+
+/**
+ * \brief States of the conversion state machine of a OneWire bus
+ */
+enum
+{
+    ONEWIRE_IDLE, ONEWIRE_STARTING, ONEWIRE_CONVERTING, ONEWIRE_CONVERTED
+};
+
+/**
+ * \brief Entry of the OneWire device inventory
+ */
+struct OneWireDevice
+{
+    /**
+     * \brief ROM ID of the device. The first byte is the family code.
+     */
+    uint8_t address[8];
+
+    /**
+     * \brief Index of the bus the device was found on
+     */
+    uint8_t bus;
+
+    /**
+     * \brief Value of millis() when the device answered the last search
+     */
+    unsigned long lastSeen;
+};
+
+/**
+ * \brief Resolution of a device registered by OneWireHandler::setResolution
+ */
+struct OneWireResolution
+{
+    /**
+     * \brief ROM ID of the device
+     */
+    uint8_t address[8];
+
+    /**
+     * \brief Index of the bus the device is attached to
+     */
+    uint8_t bus;
+
+    /**
+     * \brief Resolution the device converts at in bits
+     */
+    uint8_t resolution;
+};
 
 /**
  * \brief Muxing and Demuxing of multiple OneWire devices
+ *
+ * Temperature conversions are not triggered per device. Instead each bus runs
+ * a small state machine driven by OneWireHandler::run. It broadcasts a single
+ * Skip ROM + Convert T command to all devices on the bus and waits until the
+ * conversion is complete. Afterwards the devices may read their scratchpad
+ * once. Each completed conversion increments a per bus counter which allows
+ * the devices to detect fresh values.
+ *
+ * Buses without parasite powered devices are polled with read slots. They
+ * answer 1 as soon as the slowest device finished. Parasite powered buses need
+ * the strong pullup during the conversion and therefore wait for the
+ * conversion time of the highest resolution configured on the bus.
+ *
+ * In between two conversions one search step is done on one bus at a time.
+ * All buses are enumerated round robin this way without blocking the control
+ * loop. The devices found are kept in an inventory of #MAX_ONEWIRE_INVENTORY
+ * entries together with the time they were seen last.
+ *
+ * With #ONEWIRE_ASYNC defined the conversion commands, the read slots polling
+ * for the end of the conversion and the scratchpad reads are clocked in the
+ * background by OneWireAsync. The conversion time is counted from the end of
+ * the transfer of the conversion command. OneWireHandler::read starts the
+ * transfer and returns 1 until the scratchpad of the device arrived.
  */
 class OneWireHandler
 {
@@ -34,17 +110,51 @@ public:
     virtual ~OneWireHandler();
 
     int8_t addPin(uint8_t pin);
-    int8_t findDevice(uint8_t idx, uint8_t *address, uint8_t size);
-    void issueReadCommand(uint8_t idx, uint8_t* addr);
+    void removePin(uint8_t idx);
+    void run();
+    uint8_t getConversion(uint8_t idx);
     int8_t read(uint8_t idx, uint8_t* addr, uint8_t* data, uint8_t size);
+    int8_t setResolution(uint8_t idx, uint8_t* addr, uint8_t resolution);
+    void removeResolution(uint8_t idx, uint8_t* addr);
+
+    uint8_t getPin(uint8_t idx);
+    uint8_t getNrOfDevices();
+    const OneWireDevice* getDevice(uint8_t i);
+
+    static uint16_t getConversionTime(uint8_t resolution);
 
 private:
     OneWireHandler(const OneWireHandler&);
     OneWireHandler(OneWireHandler&);
 
+    void startConversion(uint8_t idx);
+    void restartConversion(uint8_t idx);
+    int8_t readScratchpad(uint8_t idx, uint8_t* addr, uint8_t* data);
+    void discover(uint8_t idx);
+    void updateInventory(uint8_t idx, uint8_t* address);
+    void updateConversionTime(uint8_t idx);
+
     OneWire* m_OneWires[MAX_ONEWIRE_DEVICES];
     uint8_t m_Pins[MAX_ONEWIRE_DEVICES];
     uint8_t m_Used[MAX_ONEWIRE_DEVICES];
+    uint8_t m_State[MAX_ONEWIRE_DEVICES];
+    uint8_t m_Conversion[MAX_ONEWIRE_DEVICES];
+    uint8_t m_Parasite[MAX_ONEWIRE_DEVICES];
+    uint16_t m_ConversionTime[MAX_ONEWIRE_DEVICES];
+    unsigned long m_ConversionStart[MAX_ONEWIRE_DEVICES];
+    OneWireDevice m_Devices[MAX_ONEWIRE_INVENTORY];
+    uint8_t m_NrOfDevices;
+    OneWireResolution m_Resolutions[MAX_SENSORS];
+    uint8_t m_NrOfResolutions;
+    uint8_t m_SearchBus;
+#ifdef ONEWIRE_ASYNC
+    OneWireAsync m_Async;
+    uint8_t m_AsyncBus;
+    uint8_t m_AsyncAddress[8];
+    uint8_t m_AsyncPending;
+    uint8_t m_AsyncPoll;
+    uint8_t m_ReadRequested[MAX_ONEWIRE_DEVICES];
+#endif
 };
 
 #endif /* ONEWIREHANDLER_H_ */
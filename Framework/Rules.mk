@@ -13,9 +13,17 @@ d		:= $(dir)
 # Local variables
 
 OBJS_$(d)	:= $(d)/Actuator.o $(d)/Controller.o \
-		       $(d)/GUIServer.o $(d)/NTPSync.o $(d)/Object.o \
-		       $(d)/OneWireHandler.o $(d)/SDConfigManager.o \
-		       $(d)/Sensor.o $(d)/util.o $(d)/Aquaduino.o
+		       $(d)/GUIServer.o $(d)/HTMLTemplates.o \
+		       $(d)/HTTPServer.o $(d)/LineProtocolExporter.o \
+		       $(d)/MQTTBridge.o $(d)/MQTTClient.o \
+		       $(d)/NTPSync.o $(d)/Object.o \
+		       $(d)/ObjectArena.o $(d)/ObjectFactory.o \
+		       $(d)/OneWireAsync.o $(d)/OneWireHandler.o \
+		       $(d)/SampleBatch.o $(d)/SampleQueue.o \
+		       $(d)/SDConfigManager.o $(d)/Sensor.o \
+		       $(d)/SensorFilter.o $(d)/SerialLineParser.o \
+		       $(d)/TemplateRenderer.o $(d)/util.o \
+		       $(d)/XivelyExporter.o $(d)/Aquaduino.o
 DEPS_$(d)	:= $(OBJS_$(d):%=%.d)
 CLEAN		:= $(CLEAN) $(OBJS_$(d)) $(DEPS_$(d))
 
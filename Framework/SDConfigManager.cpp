@@ -192,7 +192,8 @@ uint16_t SDConfigManager::writeConfig(Sensor* sensor)
 		SD.remove(path);
 	configFile = SD.open(path, FILE_WRITE);
 	configFile.write((uint8_t*) sensor->getName(), AQUADUINO_STRING_LENGTH);
-	if (sensor->serialize(&configFile))
+	if (sensor->serialize(&configFile)
+			&& sensor->getFilter()->serialize(&configFile))
 		Serial.println(F(" OK!"));
 	else
 		Serial.println(F(" Failed!"));
@@ -349,8 +350,11 @@ uint16_t SDConfigManager::readConfig(Sensor* sensor)
 		configFile = SD.open(path, FILE_READ);
 		configFile.read(name, AQUADUINO_STRING_LENGTH);
 		sensor->setName(name);
-		if (sensor->deserialize(&configFile))
+		if (sensor->deserialize(&configFile)) {
+			//filter configuration is missing in older files
+			sensor->getFilter()->deserialize(&configFile);
 			Serial.println(F(" OK!"));
+		}
 		else
 			Serial.println(F(" Failed!"));
 		configFile.close();
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SampleBatch.h"
+#include <Arduino.h>
+#include <Time.h>
+#include <Framework/util.h>
+
+/**
+ * \brief Constructor
+ * \param[in] queue Queue holding the samples.
+ * \param[in] count Number of samples taken from the front of the queue. At
+ *                  most #XIVELY_BATCH_SIZE.
+ * \param[in] channels Xively channel names indexed by sensor ID.
+ * \param[in] timezone Offset of the sample timestamps to UTC in hours.
+ *
+ * The samples are copied up to the first one that can not be read from the
+ * queue.
+ */
+SampleBatch::SampleBatch(SampleQueue* queue, uint16_t count,
+                         char (*channels)[XIVELY_CHANNEL_NAME_LENGTH],
+                         int8_t timezone) :
+        m_Count(0), m_Channels(channels), m_Timezone(timezone)
+{
+    if (count > XIVELY_BATCH_SIZE)
+        count = XIVELY_BATCH_SIZE;
+    while (m_Count < count && queue->peek(m_Count, &m_Samples[m_Count]) == 0)
+        m_Count++;
+}
+
+/**
+ * \brief Getter for the number of samples in the document.
+ *
+ * \returns Number of samples copied from the queue.
+ */
+uint16_t SampleBatch::getCount()
+{
+    return m_Count;
+}
+
+/**
+ * \brief Prints the JSON document.
+ * \param[in] p Destination of the document.
+ *
+ * \returns Number of characters printed.
+ */
+size_t SampleBatch::printTo(Print& p) const
+{
+    size_t len = 0;
+    int8_t firstChannel = 1;
+    int8_t firstPoint;
+
+    len += p.print(F("{\"version\":\"1.0.0\",\"datastreams\":["));
+    for (uint8_t channel = 0; channel < MAX_SENSORS; channel++)
+    {
+        if (m_Channels[channel][0] == 0)
+            continue;
+
+        if (!firstChannel)
+            len += p.print(',');
+        firstChannel = 0;
+
+        len += p.print(F("{\"id\":\""));
+        len += p.print(m_Channels[channel]);
+        len += p.print(F("\",\"datapoints\":["));
+        firstPoint = 1;
+        for (uint16_t i = 0; i < m_Count; i++)
+        {
+            if (!firstPoint)
+                len += p.print(',');
+            firstPoint = 0;
+
+            len += p.print(F("{\"at\":\""));
+            len += printTime(p, m_Samples[i].time
+                                - (int32_t) m_Timezone * SECS_PER_HOUR);
+            len += p.print(F("\",\"value\":\""));
+            len += printMilli(p, m_Samples[i].values[channel]);
+            len += p.print(F("\"}"));
+        }
+        len += p.print(F("]}"));
+    }
+    len += p.print(F("]}"));
+
+    return len;
+}
+
+/**
+ * \brief Prints a timestamp in ISO 8601 format, e.g. 2014-05-01T12:00:00Z.
+ * \param[in] p Destination of the timestamp.
+ * \param[in] time UTC in seconds since 1970.
+ *
+ * \returns Number of characters printed.
+ */
+size_t SampleBatch::printTime(Print& p, uint32_t time)
+{
+    tmElements_t tm;
+    size_t len = 0;
+
+    breakTime(time, tm);
+    len += p.print(tmYearToCalendar(tm.Year));
+    len += p.print('-');
+    len += printTwoDigits(p, tm.Month);
+    len += p.print('-');
+    len += printTwoDigits(p, tm.Day);
+    len += p.print('T');
+    len += printTwoDigits(p, tm.Hour);
+    len += p.print(':');
+    len += printTwoDigits(p, tm.Minute);
+    len += p.print(':');
+    len += printTwoDigits(p, tm.Second);
+    len += p.print('Z');
+
+    return len;
+}
+
+/**
+ * \brief Prints a value with a leading zero if needed.
+ * \param[in] p Destination of the value.
+ * \param[in] value Value in the range 0..99.
+ *
+ * \returns Number of characters printed.
+ */
+size_t SampleBatch::printTwoDigits(Print& p, uint8_t value)
+{
+    size_t len = 0;
+
+    if (value < 10)
+        len += p.print('0');
+    len += p.print(value);
+
+    return len;
+}
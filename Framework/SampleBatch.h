@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SAMPLEBATCH_H_
+#define SAMPLEBATCH_H_
+
+#include <Printable.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/SampleQueue.h>
+
+/**
+ * \brief Xively JSON document of the oldest samples of a SampleQueue.
+ *
+ * Each named Xively channel becomes a datastream carrying one datapoint per
+ * sample. Channels without a name are left out. Timestamps are converted from
+ * local time to UTC. Values are printed with three decimals straight from the
+ * milli-units. The samples are copied from the queue once by the constructor,
+ * so printing the document more than once (e.g. to determine its length
+ * first) does not read the SD card again.
+ */
+class SampleBatch: public Printable
+{
+public:
+    SampleBatch(SampleQueue* queue, uint16_t count,
+                char (*channels)[XIVELY_CHANNEL_NAME_LENGTH], int8_t timezone);
+
+    uint16_t getCount();
+    size_t printTo(Print& p) const;
+
+private:
+    static size_t printTime(Print& p, uint32_t time);
+    static size_t printTwoDigits(Print& p, uint8_t value);
+
+    Sample m_Samples[XIVELY_BATCH_SIZE];
+    uint16_t m_Count;
+    char (*m_Channels)[XIVELY_CHANNEL_NAME_LENGTH];
+    int8_t m_Timezone;
+};
+
+#endif /* SAMPLEBATCH_H_ */
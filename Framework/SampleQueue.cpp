@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SampleQueue.h"
+#include <SD.h>
+
+/**
+ * \brief Constructor
+ * \param[in] fileName Name of the file on the SD card taking the samples that
+ *                     do not fit into RAM.
+ *
+ * The queue starts empty. Call init once the SD card is available.
+ */
+SampleQueue::SampleQueue(const char* fileName) :
+        m_FileName(fileName), m_FileOffset(0), m_FileCount(0), m_Head(0),
+        m_Count(0)
+{
+}
+
+/**
+ * \brief Queues the samples left in the file by a previous run.
+ */
+void SampleQueue::init()
+{
+    File f;
+
+    m_FileOffset = 0;
+    m_FileCount = 0;
+    if (SD.exists((char*) m_FileName))
+    {
+        f = SD.open(m_FileName, FILE_READ);
+        if (f)
+        {
+            m_FileCount = f.size() / sizeof(Sample);
+            f.close();
+        }
+    }
+}
+
+/**
+ * \brief Appends a sample.
+ * \param[in] sample The sample to be queued.
+ *
+ * When the ring is full its oldest sample is moved to the file. If that fails
+ * the oldest sample is dropped.
+ */
+void SampleQueue::push(const Sample* sample)
+{
+    if (m_Count == SAMPLE_QUEUE_SIZE)
+    {
+        spill(&m_Ring[m_Head]);
+        m_Head = (m_Head + 1) % SAMPLE_QUEUE_SIZE;
+        m_Count--;
+    }
+
+    m_Ring[(m_Head + m_Count) % SAMPLE_QUEUE_SIZE] = *sample;
+    m_Count++;
+}
+
+/**
+ * \brief Reads a queued sample without removing it.
+ * \param[in] idx Position in the queue. 0 is the oldest sample.
+ * \param[out] sample The sample is copied to this location.
+ *
+ * \returns 0 on success. -1 if there is no such sample or it can not be read
+ * from the file.
+ */
+int8_t SampleQueue::peek(uint16_t idx, Sample* sample)
+{
+    File f;
+    int8_t result = -1;
+
+    if (idx < m_FileCount)
+    {
+        f = SD.open(m_FileName, FILE_READ);
+        if (f)
+        {
+            if (f.seek(m_FileOffset + (uint32_t) idx * sizeof(Sample))
+                && f.read(sample, sizeof(Sample)) == sizeof(Sample))
+                result = 0;
+            f.close();
+        }
+        return result;
+    }
+
+    idx -= m_FileCount;
+    if (idx >= m_Count)
+        return -1;
+
+    *sample = m_Ring[(m_Head + idx) % SAMPLE_QUEUE_SIZE];
+    return 0;
+}
+
+/**
+ * \brief Removes the oldest samples.
+ * \param[in] count Number of samples to be removed.
+ */
+void SampleQueue::pop(uint16_t count)
+{
+    if (count >= m_FileCount)
+    {
+        count -= m_FileCount;
+        if (m_FileCount > 0)
+            SD.remove((char*) m_FileName);
+        m_FileOffset = 0;
+        m_FileCount = 0;
+    }
+    else
+    {
+        m_FileOffset += (uint32_t) count * sizeof(Sample);
+        m_FileCount -= count;
+        return;
+    }
+
+    if (count > m_Count)
+        count = m_Count;
+    m_Head = (m_Head + count) % SAMPLE_QUEUE_SIZE;
+    m_Count -= count;
+}
+
+/**
+ * \brief Getter for the number of queued samples.
+ *
+ * \returns Number of samples in RAM and in the file.
+ */
+uint16_t SampleQueue::size()
+{
+    return m_FileCount + m_Count;
+}
+
+/**
+ * \brief Appends a sample to the file.
+ * \param[in] sample The sample to be written.
+ *
+ * \returns 0 on success. -1 if the file can not be written.
+ */
+int8_t SampleQueue::spill(const Sample* sample)
+{
+    File f;
+    int8_t result = -1;
+
+    if (m_FileCount == 0xFFFF)
+        return -1;
+
+    f = SD.open(m_FileName, FILE_WRITE);
+    if (f)
+    {
+        if (f.write((const uint8_t*) sample, sizeof(Sample)) == sizeof(Sample))
+        {
+            m_FileCount++;
+            result = 0;
+        }
+        f.close();
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SAMPLEQUEUE_H_
+#define SAMPLEQUEUE_H_
+
+#include <stdint.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Readings of all sensors at one point in time.
+ */
+struct Sample
+{
+    /**
+     * \brief Local time of the readings in seconds since 1970.
+     */
+    uint32_t time;
+
+    /**
+     * \brief Readings in milli-units indexed by sensor ID.
+     */
+    int32_t values[MAX_SENSORS];
+};
+
+/**
+ * \brief FIFO of samples waiting to be uploaded.
+ *
+ * The newest #SAMPLE_QUEUE_SIZE samples are kept in a ring buffer in RAM.
+ * When the ring is full the oldest sample is appended to a file on the SD
+ * card, so everything in the file is older than the samples in RAM and the
+ * order is kept. Samples are always taken from the file first. Once the file
+ * has been consumed it is removed.
+ *
+ * The read position within the file is only kept in RAM. After a reset the
+ * whole file is queued again.
+ */
+class SampleQueue
+{
+public:
+    SampleQueue(const char* fileName);
+
+    void init();
+
+    void push(const Sample* sample);
+    int8_t peek(uint16_t idx, Sample* sample);
+    void pop(uint16_t count);
+    uint16_t size();
+
+private:
+    int8_t spill(const Sample* sample);
+
+    const char* m_FileName;
+    uint32_t m_FileOffset;
+    uint16_t m_FileCount;
+    uint8_t m_Head;
+    uint8_t m_Count;
+    Sample m_Ring[SAMPLE_QUEUE_SIZE];
+};
+
+#endif /* SAMPLEQUEUE_H_ */
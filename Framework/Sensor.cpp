@@ -18,6 +18,7 @@
  *
  */
 #include "Sensor.h"
+#include <Arduino.h>
 #include <string.h>
 
 /**
@@ -59,3 +60,49 @@ Sensor::Sensor(const Sensor&)
 {
 
 }
+
+/**
+ * \brief Reads the sensor value in milli-units.
+ *
+ * Default implementation rounding the result of read(). Sensors delivering
+ * integer values shall override this method to avoid floating point math.
+ *
+ * \returns Sensor value multiplied by 1000.
+ */
+int32_t Sensor::readMilli()
+{
+    double value = read() * 1000;
+
+    return value < 0 ? value - 0.5 : value + 0.5;
+}
+
+/**
+ * \brief Getter for the resolution of the sensor value.
+ *
+ * \returns Number of significant fractional digits (0..3) of the value.
+ */
+uint8_t Sensor::getDecimals()
+{
+    return 3;
+}
+
+/**
+ * \brief Getter for the unit of the sensor value.
+ *
+ * \returns The unit as UTF-8 string in PROGMEM. Empty for dimensionless
+ * values.
+ */
+const __FlashStringHelper* Sensor::getUnit()
+{
+    return F("");
+}
+
+/**
+ * \brief Getter for the filter applied to the samples of the sensor.
+ *
+ * \returns Pointer to the filter of this sensor.
+ */
+SensorFilter* Sensor::getFilter()
+{
+    return &m_Filter;
+}
@@ -21,8 +21,12 @@
 #ifndef AQUADUINOSENSOR_H_
 #define AQUADUINOSENSOR_H_
 
+#include <stdint.h>
 #include "Object.h"
 #include "Serializable.h"
+#include "SensorFilter.h"
+
+class __FlashStringHelper;
 
 /**
  * \brief Base class for Sensors
@@ -30,15 +34,31 @@
  * Sensors shall provide a read method to read their values. This class may
  * also derive from Serializable and WebInterface when there is need for
  * configuration of sensors.
+ *
+ * Besides the floating point read method a sensor can provide its value as
+ * signed integer in milli-units (e.g. 25437 for 25.437 degree Celsius).
+ * Sensors which naturally produce integers should override readMilli and
+ * implement read on top of it. getDecimals tells how many of the three
+ * fractional digits carry information and getUnit names the unit.
+ *
+ * Each sensor owns a SensorFilter. Sensors pass their new samples through it
+ * so smoothing can be configured per sensor. The filter configuration is
+ * stored by the ConfigManager behind the sensor configuration.
  */
 class Sensor: public Object, public Serializable
 {
 public:
     Sensor();
+    virtual ~Sensor();
     virtual double read() = 0;
+    virtual int32_t readMilli();
+    virtual uint8_t getDecimals();
+    virtual const __FlashStringHelper* getUnit();
+
+    SensorFilter* getFilter();
 
 protected:
-    virtual ~Sensor();
+    SensorFilter m_Filter;
 private:
     Sensor(Sensor&);
     Sensor(const Sensor&);
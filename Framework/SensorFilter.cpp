@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SensorFilter.h"
+
+/**
+ * \brief Constructor
+ *
+ * Samples are passed through until another mode is configured.
+ */
+SensorFilter::SensorFilter() :
+        m_Mode(FILTER_NONE), m_Parameter(0)
+{
+    reset();
+}
+
+/**
+ * \brief Configures the filter.
+ * \param[in] mode One of FILTER_NONE, FILTER_AVERAGE, FILTER_EXPONENTIAL or
+ *                 FILTER_MEDIAN.
+ * \param[in] parameter Window length or weight shift depending on the mode.
+ *
+ * The history is cleared.
+ *
+ * \returns 0 on success. -1 when mode or parameter are out of range.
+ */
+int8_t SensorFilter::configure(uint8_t mode, uint8_t parameter)
+{
+    switch (mode)
+    {
+    case FILTER_NONE:
+        parameter = 0;
+        break;
+    case FILTER_AVERAGE:
+        if (parameter < 1 || parameter > SENSOR_FILTER_WINDOW)
+            return -1;
+        break;
+    case FILTER_EXPONENTIAL:
+        if (parameter < 1 || parameter > 7)
+            return -1;
+        break;
+    case FILTER_MEDIAN:
+        if (parameter < 1 || parameter > SENSOR_FILTER_MEDIAN_WINDOW)
+            return -1;
+        break;
+    default:
+        return -1;
+    }
+
+    m_Mode = mode;
+    m_Parameter = parameter;
+    reset();
+    return 0;
+}
+
+/**
+ * \brief Getter for the filter mode.
+ *
+ * \returns The configured mode.
+ */
+uint8_t SensorFilter::getMode()
+{
+    return m_Mode;
+}
+
+/**
+ * \brief Getter for the filter parameter.
+ *
+ * \returns Window length or weight shift depending on the mode.
+ */
+uint8_t SensorFilter::getParameter()
+{
+    return m_Parameter;
+}
+
+/**
+ * \brief Clears the history.
+ */
+void SensorFilter::reset()
+{
+    m_Next = 0;
+    m_Count = 0;
+    m_Sum = 0;
+    m_Value = 0;
+}
+
+/**
+ * \brief Adds a new sample.
+ * \param[in] sample The sample in milli-units.
+ *
+ * The exponential filter works like an accumulator scaled by 2^parameter. The
+ * integer part is kept in m_Value and the bits shifted out in m_Sum. Thus
+ * small differences are accumulated until they change the value instead of
+ * being truncated and the value reaches a constant input exactly.
+ *
+ * \returns The filtered value.
+ */
+int32_t SensorFilter::add(int32_t sample)
+{
+    switch (m_Mode)
+    {
+    case FILTER_AVERAGE:
+        if (m_Count == m_Parameter)
+            m_Sum -= m_Samples[m_Next];
+        else
+            m_Count++;
+        m_Sum += sample;
+        m_Samples[m_Next] = sample;
+        if (++m_Next == m_Parameter)
+            m_Next = 0;
+        m_Value = m_Sum / m_Count;
+        break;
+    case FILTER_EXPONENTIAL:
+        if (m_Count == 0)
+        {
+            m_Count = 1;
+            m_Value = sample;
+        }
+        else
+        {
+            m_Sum += sample - m_Value;
+            m_Value += m_Sum >> m_Parameter;
+            m_Sum &= (1 << m_Parameter) - 1;
+        }
+        break;
+    case FILTER_MEDIAN:
+        if (m_Count < m_Parameter)
+            m_Count++;
+        m_Samples[m_Next] = sample;
+        if (++m_Next == m_Parameter)
+            m_Next = 0;
+        m_Value = median();
+        break;
+    default:
+        m_Value = sample;
+        break;
+    }
+
+    return m_Value;
+}
+
+/**
+ * \brief Getter for the filtered value.
+ *
+ * \returns The value returned by the last call of add.
+ */
+int32_t SensorFilter::getValue()
+{
+    return m_Value;
+}
+
+/**
+ * \brief Computes the median of the samples in the window.
+ *
+ * The window is limited to #SENSOR_FILTER_MEDIAN_WINDOW samples so sorting a
+ * copy by insertion is cheap.
+ *
+ * \returns The median. For an even number of samples the lower one.
+ */
+int32_t SensorFilter::median()
+{
+    int32_t sorted[SENSOR_FILTER_MEDIAN_WINDOW];
+    int32_t current;
+    int8_t i, j;
+
+    for (i = 0; i < m_Count; i++)
+    {
+        current = m_Samples[i];
+        for (j = i; j > 0 && sorted[j - 1] > current; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = current;
+    }
+
+    return sorted[(m_Count - 1) / 2];
+}
+
+/**
+ * \brief Serializes mode and parameter.
+ */
+uint16_t SensorFilter::serialize(Stream* s)
+{
+    s->write(m_Mode);
+    s->write(m_Parameter);
+    return 2;
+}
+
+/**
+ * \brief Deserializes mode and parameter.
+ *
+ * Invalid configurations are ignored and the current one is kept.
+ */
+uint16_t SensorFilter::deserialize(Stream* s)
+{
+    int mode, parameter;
+
+    mode = s->read();
+    parameter = s->read();
+    if (mode < 0 || parameter < 0)
+        return 0;
+    configure(mode, parameter);
+    return 2;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SENSORFILTER_H_
+#define SENSORFILTER_H_
+
+#include <stdint.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/Serializable.h>
+
+#if SENSOR_FILTER_MEDIAN_WINDOW > SENSOR_FILTER_WINDOW
+#error SENSOR_FILTER_MEDIAN_WINDOW must not exceed SENSOR_FILTER_WINDOW
+#endif
+
+/**
+ * \brief Filter modes of SensorFilter.
+ */
+enum
+{
+    FILTER_NONE,
+    FILTER_AVERAGE,
+    FILTER_EXPONENTIAL,
+    FILTER_MEDIAN
+};
+
+/**
+ * \brief Smoothing of sensor samples given in milli-units.
+ *
+ * Sensors pass each new sample to add and use the returned value as their
+ * reading. The meaning of the parameter depends on the mode:
+ *
+ * - FILTER_NONE: Samples are passed through.
+ * - FILTER_AVERAGE: Moving average over the last parameter samples
+ *   (1..#SENSOR_FILTER_WINDOW). A running sum is kept so each sample costs
+ *   one addition and one subtraction.
+ * - FILTER_EXPONENTIAL: Exponential smoothing with a weight of 1/2^parameter
+ *   (1..7) for the new sample. The fraction of the value is kept so the
+ *   filter does not stall short of the input.
+ * - FILTER_MEDIAN: Median of the last parameter samples
+ *   (1..#SENSOR_FILTER_MEDIAN_WINDOW) to reject single spikes.
+ *
+ * Until the window is filled the available samples are used. The
+ * configuration is serialized as two bytes.
+ */
+class SensorFilter: public Serializable
+{
+public:
+    SensorFilter();
+
+    int8_t configure(uint8_t mode, uint8_t parameter);
+    uint8_t getMode();
+    uint8_t getParameter();
+
+    void reset();
+    int32_t add(int32_t sample);
+    int32_t getValue();
+
+    uint16_t serialize(Stream* s);
+    uint16_t deserialize(Stream* s);
+
+private:
+    int32_t median();
+
+    uint8_t m_Mode;
+    uint8_t m_Parameter;
+    uint8_t m_Next;
+    uint8_t m_Count;
+    int32_t m_Sum;
+    int32_t m_Value;
+    int32_t m_Samples[SENSOR_FILTER_WINDOW];
+};
+
+#endif /* SENSORFILTER_H_ */
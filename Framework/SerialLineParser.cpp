@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SerialLineParser.h"
+
+/**
+ * \brief Constructor
+ * \param[in] stream Stream the lines are received from.
+ */
+SerialLineParser::SerialLineParser(Stream* stream) :
+        m_Stream(stream), m_Length(0), m_Complete(0), m_Overflow(0)
+{
+    m_Line[0] = 0;
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+SerialLineParser::SerialLineParser(const SerialLineParser&)
+{
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+SerialLineParser::SerialLineParser(SerialLineParser&)
+{
+}
+
+/**
+ * \brief Reads the available characters of the stream
+ *
+ * Reading stops at the end of a line so that the line can be processed
+ * before the next one is collected. A completed line stays valid until the
+ * next call. Line feeds are ignored.
+ *
+ * \returns 1 when a line was completed. 0 otherwise.
+ */
+int8_t SerialLineParser::poll()
+{
+    int c;
+
+    if (m_Complete)
+    {
+        m_Complete = 0;
+        m_Length = 0;
+    }
+
+    while ((c = m_Stream->read()) >= 0)
+    {
+        if (c == '\r')
+        {
+            m_Line[m_Length] = 0;
+            if (m_Overflow)
+            {
+                m_Overflow = 0;
+                m_Length = 0;
+                continue;
+            }
+            m_Complete = 1;
+            return 1;
+        }
+        if (c == '\n')
+            continue;
+        if (m_Length < sizeof(m_Line) - 1)
+            m_Line[m_Length++] = c;
+        else
+            m_Overflow = 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Discards the line collected so far
+ */
+void SerialLineParser::reset()
+{
+    m_Length = 0;
+    m_Complete = 0;
+    m_Overflow = 0;
+    m_Line[0] = 0;
+}
+
+/**
+ * \brief Getter for the last completed line
+ *
+ * \returns The line without the carriage return.
+ */
+const char* SerialLineParser::getLine()
+{
+    return m_Line;
+}
+
+/**
+ * \brief Getter for a comma separated field of the last completed line
+ * \param[in] field Index of the field
+ *
+ * \returns Start of the field. It is terminated by a comma or the end of the
+ * line. NULL if the line has less fields.
+ */
+const char* SerialLineParser::getField(uint8_t field)
+{
+    const char* current = m_Line;
+
+    while (field)
+    {
+        if (*current == 0)
+            return NULL;
+        if (*current++ == ',')
+            field--;
+    }
+    return current;
+}
+
+/**
+ * \brief Getter for the length of the last completed line
+ *
+ * \returns Length in characters.
+ */
+uint8_t SerialLineParser::getLength()
+{
+    return m_Length;
+}
+
+/**
+ * \brief Converts a decimal number to a fixed-point value
+ * \param[in] str Number with optional sign and decimal point, e.g. "-12.34"
+ * \param[in] decimals Number of decimal places of the result
+ * \param[out] value The number multiplied by 10^decimals. Further decimal
+ *                   places are truncated.
+ *
+ * \returns Number of characters consumed. -1 if str does not start with a
+ * number.
+ */
+int8_t SerialLineParser::parseDecimal(const char* str, uint8_t decimals,
+                                      int32_t* value)
+{
+    const char* current = str;
+    int32_t result = 0;
+    int8_t negative = 0;
+    int8_t digits = 0;
+    int8_t fraction = -1;
+
+    if (*current == '-' || *current == '+')
+        negative = *current++ == '-';
+
+    for (;; current++)
+    {
+        if (*current == '.' && fraction < 0)
+        {
+            fraction = 0;
+            continue;
+        }
+        if (*current < '0' || *current > '9')
+            break;
+        digits++;
+        if (fraction >= 0)
+        {
+            if (fraction == decimals)
+                continue;
+            fraction++;
+        }
+        result = result * 10 + (*current - '0');
+    }
+
+    if (digits == 0)
+        return -1;
+
+    if (fraction < 0)
+        fraction = 0;
+    for (; fraction < decimals; fraction++)
+        result *= 10;
+
+    *value = negative ? -result : result;
+    return current - str;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SERIALLINEPARSER_H_
+#define SERIALLINEPARSER_H_
+
+#include <stdint.h>
+#include <Stream.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Allocation free line framer for serial sensors
+ *
+ * Collects the characters of a Stream (usually one of the HardwareSerial
+ * ports) in a fixed buffer of #SERIAL_LINE_LENGTH bytes until a carriage
+ * return is received. SerialLineParser::poll drains all characters available
+ * in the receive buffer of the port. Lines exceeding the buffer are dropped.
+ *
+ * The numbers of a line can be converted by SerialLineParser::parseDecimal
+ * to fixed-point values without using floating point arithmetic.
+ */
+class SerialLineParser
+{
+public:
+    SerialLineParser(Stream* stream);
+
+    int8_t poll();
+    void reset();
+    const char* getLine();
+    const char* getField(uint8_t field);
+    uint8_t getLength();
+
+    static int8_t parseDecimal(const char* str, uint8_t decimals,
+                               int32_t* value);
+
+private:
+    SerialLineParser(const SerialLineParser&);
+    SerialLineParser(SerialLineParser&);
+
+    Stream* m_Stream;
+    char m_Line[SERIAL_LINE_LENGTH];
+    uint8_t m_Length;
+    uint8_t m_Complete;
+    uint8_t m_Overflow;
+};
+
+#endif /* SERIALLINEPARSER_H_ */
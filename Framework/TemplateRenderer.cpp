@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TemplateRenderer.h"
+#include <avr/pgmspace.h>
+
+/**
+ * \brief Expands a template compiled by build/compile-templates.py.
+ * \param[in] out Destination, usually a BufferedPrint on the connection.
+ * \param[in] position Token to start with. Either the beginning of a
+ *                     template in PROGMEM or a position returned earlier.
+ * \param[in] budget Number of literal characters after which rendering is
+ *                   suspended. Values written by the callback are not
+ *                   counted.
+ * \param[in] value Callback writing the values of the placeholders.
+ * \param[in] context Passed on to the callback.
+ *
+ * Literals are copied byte by byte from PROGMEM to the destination. Neither
+ * the template nor the values are buffered on the way.
+ *
+ * \returns NULL when the template is complete. Otherwise the position to
+ * resume at.
+ */
+const char* renderTemplate(Print& out, const char* position, uint16_t budget,
+                           TemplateValue value, void* context)
+{
+    uint16_t written = 0;
+    uint8_t token;
+
+    while ((token = pgm_read_byte(position)) != 0)
+    {
+        if (written >= budget)
+            return position;
+
+        if (token & 0x80)
+        {
+            if (value(out, token & 0x7F, context))
+                return position;
+            position++;
+        }
+        else
+        {
+            for (position++; token > 0; token--, written++)
+                out.write(pgm_read_byte(position++));
+        }
+    }
+
+    return NULL;
+}
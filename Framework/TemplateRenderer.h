@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEMPLATERENDERER_H_
+#define TEMPLATERENDERER_H_
+
+#include <Arduino.h>
+#include <Print.h>
+
+/**
+ * \brief Writes the value of a placeholder.
+ * \param[in] out Destination of the value.
+ * \param[in] placeholder One of the TEMPLATE_* constants of HTMLTemplates.h.
+ * \param[in] context Context passed to renderTemplate.
+ *
+ * \returns 0 to continue with the next token. Any other value suspends
+ * rendering. The placeholder is then the first token processed on resume.
+ * This allows to expand a list one element per call.
+ */
+typedef int8_t (*TemplateValue)(Print& out, uint8_t placeholder,
+                                void* context);
+
+extern const char* renderTemplate(Print& out, const char* position,
+                                  uint16_t budget, TemplateValue value,
+                                  void* context);
+
+#endif /* TEMPLATERENDERER_H_ */
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "XivelyExporter.h"
+#include <Aquaduino.h>
+#include <Framework/SampleBatch.h>
+#include <stdlib.h>
+
+/**
+ * \brief Constructor
+ * \param[in] client Client used for the connection to Xively.
+ * \param[in] feed Feed ID as string.
+ * \param[in] apiKey Xively API key.
+ * \param[in] channels Xively channel names indexed by sensor ID.
+ *
+ * The strings are referenced, not copied. Thus changes to the configuration
+ * are taken into account with the next upload.
+ */
+XivelyExporter::XivelyExporter(Client& client, const char* feed,
+                               const char* apiKey,
+                               char (*channels)[XIVELY_CHANNEL_NAME_LENGTH]) :
+        m_XivelyClient(client), m_Feed(feed), m_APIKey(apiKey),
+        m_Channels(channels)
+{
+}
+
+/**
+ * \brief Checks the Xively flag of Aquaduino.
+ *
+ * \returns Value of the Xively flag.
+ */
+int8_t XivelyExporter::isEnabled()
+{
+    return __aquaduino->isXivelyEnabled();
+}
+
+/**
+ * \brief Getter for the number of samples sent at once.
+ *
+ * \returns #XIVELY_BATCH_SIZE
+ */
+uint16_t XivelyExporter::getBatchSize()
+{
+    return XIVELY_BATCH_SIZE;
+}
+
+/**
+ * \brief Uploads the samples in one request.
+ * \param[in] queue Queue holding the samples.
+ * \param[in] count Number of samples to be sent.
+ *
+ * Only the samples up to the first one that can not be read from the queue
+ * are sent. Samples rejected by Xively as invalid are reported as sent as
+ * they would never be accepted.
+ *
+ * \returns Number of samples sent when they were accepted or rejected as
+ * invalid. -1 if the first sample can not be read or on any other error.
+ */
+int16_t XivelyExporter::exportSamples(SampleQueue* queue, uint16_t count)
+{
+    SampleBatch batch(queue, count, m_Channels, __aquaduino->getTimezone());
+    int ret;
+
+    if (batch.getCount() == 0)
+        return -1;
+
+    Serial.print(F("Sending data to Xively... "));
+    ret = m_XivelyClient.put(atol(m_Feed), batch, m_APIKey);
+    Serial.println(ret);
+
+    if ((ret >= 200 && ret <= 299) || ret == -400 || ret == -422)
+        return batch.getCount();
+    return -1;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef XIVELYEXPORTER_H_
+#define XIVELYEXPORTER_H_
+
+#include <Client.h>
+#include <Xively.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/Exporter.h>
+
+/**
+ * \brief Exporter uploading samples as datapoints to a Xively feed.
+ *
+ * Feed, API key and channel names are the ones of the Aquaduino
+ * configuration. #XIVELY_BATCH_SIZE samples are uploaded per request.
+ */
+class XivelyExporter: public Exporter
+{
+public:
+    XivelyExporter(Client& client, const char* feed, const char* apiKey,
+                   char (*channels)[XIVELY_CHANNEL_NAME_LENGTH]);
+
+    int8_t isEnabled();
+    uint16_t getBatchSize();
+    int16_t exportSamples(SampleQueue* queue, uint16_t count);
+
+private:
+    XivelyClient m_XivelyClient;
+    const char* m_Feed;
+    const char* m_APIKey;
+    char (*m_Channels)[XIVELY_CHANNEL_NAME_LENGTH];
+};
+
+#endif /* XIVELYEXPORTER_H_ */
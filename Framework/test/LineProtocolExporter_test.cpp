@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Checks the line protocol sent by LineProtocolExporter. EthernetUDP is
+ * replaced by a fake sink recording every datagram, Aquaduino by the tables
+ * of HostAquaduino.
+ */
+
+#include <ArduinoUnit.h>
+#include <HostAquaduino.h>
+#include <Framework/LineProtocolExporter.h>
+
+#define MAX_DATAGRAMS 4
+#define DATAGRAM_SIZE 256
+
+/*
+ * 2014-05-01 12:00:00 UTC
+ */
+#define UTC 1398945600UL
+
+/**
+ * \brief State of the fake EthernetUDP.
+ */
+struct Sink
+{
+    uint8_t socketFree;
+    uint8_t sendable;
+    uint16_t localPort;
+    IPAddress host;
+    uint16_t port;
+    uint8_t open;
+    char packet[DATAGRAM_SIZE];
+    uint16_t length;
+    char datagrams[MAX_DATAGRAMS][DATAGRAM_SIZE];
+    uint8_t count;
+};
+
+static Sink sink;
+
+/*
+ * The fake sink. Only one datagram is built at a time like on the W5100.
+ */
+EthernetUDP::EthernetUDP()
+{
+}
+
+uint8_t EthernetUDP::begin(uint16_t port)
+{
+    sink.localPort = port;
+    return sink.socketFree;
+}
+
+void EthernetUDP::stop()
+{
+    sink.localPort = 0;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    sink.host = ip;
+    sink.port = port;
+    sink.open = 1;
+    sink.length = 0;
+    return 1;
+}
+
+int EthernetUDP::beginPacket(const char* host, uint16_t port)
+{
+    return 0;
+}
+
+int EthernetUDP::endPacket()
+{
+    if (!sink.open || !sink.sendable || sink.count == MAX_DATAGRAMS)
+        return 0;
+    sink.open = 0;
+    sink.sendable--;
+    sink.packet[sink.length] = 0;
+    strcpy(sink.datagrams[sink.count++], sink.packet);
+    return 1;
+}
+
+size_t EthernetUDP::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t EthernetUDP::write(const uint8_t* buffer, size_t size)
+{
+    if (!sink.open || sink.length + size >= DATAGRAM_SIZE)
+        return 0;
+    memcpy(&sink.packet[sink.length], buffer, size);
+    sink.length += size;
+    return size;
+}
+
+int EthernetUDP::parsePacket()
+{
+    return 0;
+}
+
+int EthernetUDP::available()
+{
+    return 0;
+}
+
+int EthernetUDP::read()
+{
+    return -1;
+}
+
+int EthernetUDP::read(unsigned char* buffer, size_t len)
+{
+    return 0;
+}
+
+int EthernetUDP::peek()
+{
+    return -1;
+}
+
+void EthernetUDP::flush()
+{
+}
+
+/**
+ * \brief Sensor which only has a name.
+ */
+class NamedSensor: public Sensor
+{
+public:
+    NamedSensor(const char* name)
+    {
+        setName(name);
+    }
+
+    virtual double read()
+    {
+        return 0;
+    }
+
+    virtual uint16_t serialize(Stream* s)
+    {
+        return 0;
+    }
+
+    virtual uint16_t deserialize(Stream* s)
+    {
+        return 0;
+    }
+};
+
+static NamedSensor temperature("Temperature");
+static NamedSensor unnamed("");
+static NamedSensor ph("pH Tank 1");
+static NamedSensor odd("a,b=c");
+
+static const IPAddress receiver(192, 168, 1, 10);
+static LineProtocolExporter exporter(receiver, 8089);
+static SampleQueue queue("samples.dat");
+
+/*
+ * Compares a recorded datagram and prints it if it differs.
+ *
+ * \returns 0 if it matches.
+ */
+static int8_t compareDatagram(uint8_t idx, const char* expected)
+{
+    if (strcmp(sink.datagrams[idx], expected) == 0)
+        return 0;
+    Serial.print(sink.datagrams[idx]);
+    return 1;
+}
+
+/*
+ * Sensors 0, 2 and 5 are named, sensor 1 has no name and the others are
+ * missing. The sink accepts the given number of datagrams.
+ */
+static void reset(uint8_t sendable, int8_t timezone)
+{
+    memset(hostSensors, 0, sizeof(hostSensors));
+    hostSensors[0] = &temperature;
+    hostSensors[1] = &unnamed;
+    hostSensors[2] = &ph;
+    hostSensors[5] = &odd;
+    hostTimezone = timezone;
+
+    sink = Sink();
+    sink.socketFree = 1;
+    sink.sendable = sendable;
+
+    queue.pop(queue.size());
+}
+
+/*
+ * Queues a sample taken at local time.
+ */
+static void push(uint32_t time, int32_t temperature, int32_t ph, int32_t odd)
+{
+    Sample sample;
+
+    memset(&sample, 0, sizeof(sample));
+    sample.time = time;
+    sample.values[0] = temperature;
+    sample.values[1] = 99;
+    sample.values[2] = ph;
+    sample.values[5] = odd;
+    queue.push(&sample);
+}
+
+test(sample_is_one_datagram)
+{
+    reset(MAX_DATAGRAMS, 0);
+    push(UTC, 25125, 7012, 5);
+
+    assertEqual(exporter.exportSamples(&queue, 1), 1);
+    assertEqual(sink.count, 1);
+    assertEqual(compareDatagram(0,
+                                "aquaduino,sensor=Temperature value=25.125 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=7.012 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=0.005 "
+                                "1398945600000000000\n"), 0);
+    assertTrue(sink.host == receiver);
+    assertEqual(sink.port, 8089);
+    assertEqual(sink.localPort, 0);
+    // Removing the samples is left to Aquaduino
+    assertEqual(queue.size(), 1);
+}
+
+test(negative_values)
+{
+    reset(MAX_DATAGRAMS, 0);
+    push(UTC, -1500, -7, -123456);
+
+    assertEqual(exporter.exportSamples(&queue, 1), 1);
+    assertEqual(compareDatagram(0,
+                                "aquaduino,sensor=Temperature value=-1.500 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=-0.007 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=-123.456 "
+                                "1398945600000000000\n"), 0);
+}
+
+test(timestamp_in_utc)
+{
+    reset(MAX_DATAGRAMS, 2);
+    push(UTC + 2 * 3600, 0, 0, 0);
+    assertEqual(exporter.exportSamples(&queue, 1), 1);
+    assertEqual(compareDatagram(0,
+                                "aquaduino,sensor=Temperature value=0.000 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=0.000 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=0.000 "
+                                "1398945600000000000\n"), 0);
+
+    reset(MAX_DATAGRAMS, -5);
+    push(UTC - 5 * 3600, 0, 0, 0);
+    assertEqual(exporter.exportSamples(&queue, 1), 1);
+    assertEqual(compareDatagram(0,
+                                "aquaduino,sensor=Temperature value=0.000 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=0.000 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=0.000 "
+                                "1398945600000000000\n"), 0);
+}
+
+test(datagram_per_sample)
+{
+    reset(MAX_DATAGRAMS, 0);
+    push(UTC, 1000, 2000, 3000);
+    push(UTC + 60, 1001, 2001, 3001);
+    push(UTC + 120, 1002, 2002, 3002);
+
+    assertEqual(exporter.exportSamples(&queue, 3), 3);
+    assertEqual(sink.count, 3);
+    assertEqual(compareDatagram(0,
+                                "aquaduino,sensor=Temperature value=1.000 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=2.000 "
+                                "1398945600000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=3.000 "
+                                "1398945600000000000\n"), 0);
+    assertEqual(compareDatagram(1,
+                                "aquaduino,sensor=Temperature value=1.001 "
+                                "1398945660000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=2.001 "
+                                "1398945660000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=3.001 "
+                                "1398945660000000000\n"), 0);
+    assertEqual(compareDatagram(2,
+                                "aquaduino,sensor=Temperature value=1.002 "
+                                "1398945720000000000\n"
+                                "aquaduino,sensor=pH\\ Tank\\ 1 value=2.002 "
+                                "1398945720000000000\n"
+                                "aquaduino,sensor=a\\,b\\=c value=3.002 "
+                                "1398945720000000000\n"), 0);
+}
+
+test(count_of_sent_samples)
+{
+    reset(2, 0);
+    push(UTC, 1000, 2000, 3000);
+    push(UTC + 60, 1001, 2001, 3001);
+    push(UTC + 120, 1002, 2002, 3002);
+
+    // The third datagram is not accepted
+    assertEqual(exporter.exportSamples(&queue, 3), 2);
+    assertEqual(sink.count, 2);
+
+    // Asking for more samples than queued
+    reset(MAX_DATAGRAMS, 0);
+    push(UTC, 1000, 2000, 3000);
+    assertEqual(exporter.exportSamples(&queue, 2), 1);
+}
+
+test(nothing_sent)
+{
+    reset(0, 0);
+    push(UTC, 1000, 2000, 3000);
+    assertEqual(exporter.exportSamples(&queue, 1), -1);
+
+    reset(MAX_DATAGRAMS, 0);
+    sink.socketFree = 0;
+    push(UTC, 1000, 2000, 3000);
+    assertEqual(exporter.exportSamples(&queue, 1), -1);
+    assertEqual(sink.count, 0);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+}
+
+void loop()
+{
+    Test::run();
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Checks the packets of MQTTClient against a fake Client which records the
+ * written bytes and plays back the answers of the broker.
+ */
+
+#include <ArduinoUnit.h>
+#include <Client.h>
+#include <Framework/MQTTClient.h>
+
+/**
+ * \brief Client recording the sent bytes and returning canned answers.
+ */
+class FakeClient: public Client
+{
+public:
+    FakeClient() :
+            m_Connected(0), m_SentLength(0), m_Received(NULL),
+            m_ReceivedLength(0), m_ReceivedPos(0)
+    {
+    }
+
+    virtual int connect(IPAddress ip, uint16_t port)
+    {
+        m_Connected = 1;
+        return 1;
+    }
+
+    virtual int connect(const char* host, uint16_t port)
+    {
+        m_Connected = 1;
+        return 1;
+    }
+
+    virtual size_t write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+
+    virtual size_t write(const uint8_t* buf, size_t size)
+    {
+        if (!m_Connected || m_SentLength + size > sizeof(m_Sent))
+            return 0;
+        memcpy(&m_Sent[m_SentLength], buf, size);
+        m_SentLength += size;
+        return size;
+    }
+
+    virtual int available()
+    {
+        return m_ReceivedLength - m_ReceivedPos;
+    }
+
+    virtual int read()
+    {
+        if (m_ReceivedPos == m_ReceivedLength)
+            return -1;
+        return m_Received[m_ReceivedPos++];
+    }
+
+    virtual int read(uint8_t* buf, size_t size)
+    {
+        size_t i;
+
+        for (i = 0; i < size && available(); i++)
+            buf[i] = read();
+        return i;
+    }
+
+    virtual int peek()
+    {
+        if (m_ReceivedPos == m_ReceivedLength)
+            return -1;
+        return m_Received[m_ReceivedPos];
+    }
+
+    virtual void flush()
+    {
+    }
+
+    virtual void stop()
+    {
+        m_Connected = 0;
+    }
+
+    virtual uint8_t connected()
+    {
+        return m_Connected;
+    }
+
+    virtual operator bool()
+    {
+        return m_Connected;
+    }
+
+    /**
+     * \brief Queues bytes sent by the broker.
+     */
+    void receive(const uint8_t* data, uint16_t length)
+    {
+        m_Received = data;
+        m_ReceivedLength = length;
+        m_ReceivedPos = 0;
+    }
+
+    /**
+     * \brief Compares the bytes written since the last call.
+     *
+     * \returns 0 if they match.
+     */
+    int8_t compareSent(const uint8_t* expected, uint16_t length)
+    {
+        int8_t result = length != m_SentLength
+                        || memcmp(m_Sent, expected, length) != 0;
+        m_SentLength = 0;
+        return result;
+    }
+
+    uint16_t getSentLength()
+    {
+        return m_SentLength;
+    }
+
+private:
+    uint8_t m_Connected;
+    uint8_t m_Sent[256];
+    uint16_t m_SentLength;
+    const uint8_t* m_Received;
+    uint16_t m_ReceivedLength;
+    uint16_t m_ReceivedPos;
+};
+
+static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+
+static char callbackTopic[32];
+static uint8_t callbackPayload[32];
+static uint16_t callbackLength;
+
+static void callback(const char* topic, const uint8_t* payload,
+                     uint16_t length)
+{
+    strncpy(callbackTopic, topic, sizeof(callbackTopic) - 1);
+    memcpy(callbackPayload, payload, min(length, sizeof(callbackPayload)));
+    callbackLength = length;
+}
+
+/*
+ * Connects without will and processes the CONNACK.
+ */
+static int8_t connect(FakeClient& client, MQTTClient& mqtt)
+{
+    if (mqtt.connect(IPAddress(127, 0, 0, 1), 1883, "aq", 60) != 0)
+        return -1;
+    client.compareSent(NULL, 0);
+    client.receive(connack, sizeof(connack));
+    mqtt.run();
+    return mqtt.getState() == MQTT_CONNECTED ? 0 : -1;
+}
+
+test(connect_with_will)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t expected[] = {
+        0x10, 46,
+        0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x26, 0x00, 0x3C,
+        0x00, 0x09, 'a', 'q', 'u', 'a', 'd', 'u', 'i', 'n', 'o',
+        0x00, 0x0E, 'a', 'q', 'u', 'a', 'd', 'u', 'i', 'n', 'o', '/',
+        's', 't', 'a', 't',
+        0x00, 0x07, 'o', 'f', 'f', 'l', 'i', 'n', 'e' };
+
+    assertEqual(mqtt.connect(IPAddress(127, 0, 0, 1), 1883, "aquaduino", 60,
+                             "aquaduino/stat", "offline"), 0);
+    assertEqual(client.compareSent(expected, sizeof(expected)), 0);
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_CONNECTING);
+
+    client.receive(connack, sizeof(connack));
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_CONNECTED);
+}
+
+test(connect_refused)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t refused[] = { 0x20, 0x02, 0x00, 0x05 };
+
+    assertEqual(mqtt.connect(IPAddress(127, 0, 0, 1), 1883, "aq", 60), 0);
+    client.receive(refused, sizeof(refused));
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_DISCONNECTED);
+    assertEqual(client.connected(), 0);
+}
+
+test(connect_timeout)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+
+    assertEqual(mqtt.connect(IPAddress(127, 0, 0, 1), 1883, "aq", 60), 0);
+    delay(MQTT_CONNECT_TIMEOUT);
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_CONNECTING);
+    delay(1);
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_DISCONNECTED);
+}
+
+test(publish_qos0_retained)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t expected[] = { 0x31, 9, 0x00, 0x03, 't', '/', 'a', '2',
+                                 '1', '.', '5' };
+
+    assertEqual(mqtt.publish("t/a", "21.5", 0, 1), -1);
+    assertEqual(connect(client, mqtt), 0);
+    assertEqual(mqtt.publish("t/a", "21.5", 0, 1), 0);
+    assertEqual(client.compareSent(expected, sizeof(expected)), 0);
+    assertEqual(mqtt.isPublishPending(), 0);
+}
+
+test(subscribe)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t expected[] = { 0x82, 12, 0x00, 0x01, 0x00, 0x07, 'a', '/',
+                                 '+', '/', 's', 'e', 't', 0x01 };
+    const uint8_t suback[] = { 0x90, 0x03, 0x00, 0x01, 0x01 };
+
+    assertEqual(connect(client, mqtt), 0);
+    assertEqual(mqtt.subscribe("a/+/set", 1), 0);
+    assertEqual(client.compareSent(expected, sizeof(expected)), 0);
+    client.receive(suback, sizeof(suback));
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_CONNECTED);
+}
+
+test(publish_qos1_retry)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t expected[] = { 0x32, 6, 0x00, 0x01, 't', 0x00, 0x01, 'x' };
+    const uint8_t duplicate[] = { 0x3A, 6, 0x00, 0x01, 't', 0x00, 0x01,
+                                  'x' };
+    const uint8_t puback[] = { 0x40, 0x02, 0x00, 0x01 };
+
+    assertEqual(connect(client, mqtt), 0);
+    assertEqual(mqtt.publish("t", "x", 1, 0), 0);
+    assertEqual(client.compareSent(expected, sizeof(expected)), 0);
+    assertEqual(mqtt.isPublishPending(), 1);
+    // Only one QoS 1 message in flight
+    assertEqual(mqtt.publish("t", "y", 1, 0), -1);
+
+    delay(MQTT_RETRY_INTERVAL - 1);
+    mqtt.run();
+    assertEqual(client.getSentLength(), 0);
+    delay(1);
+    mqtt.run();
+    assertEqual(client.compareSent(duplicate, sizeof(duplicate)), 0);
+
+    client.receive(puback, sizeof(puback));
+    mqtt.run();
+    assertEqual(mqtt.isPublishPending(), 0);
+    delay(MQTT_RETRY_INTERVAL);
+    mqtt.run();
+    assertEqual(client.getSentLength(), 0);
+}
+
+test(publish_qos1_after_reconnect)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t duplicate[] = { 0x3A, 6, 0x00, 0x01, 't', 0x00, 0x01,
+                                  'x' };
+
+    assertEqual(connect(client, mqtt), 0);
+    assertEqual(mqtt.publish("t", "x", 1, 0), 0);
+    client.stop();
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_DISCONNECTED);
+    client.compareSent(NULL, 0);
+
+    assertEqual(connect(client, mqtt), 0);
+    assertEqual(client.compareSent(duplicate, sizeof(duplicate)), 0);
+    assertEqual(mqtt.isPublishPending(), 1);
+}
+
+test(receive_qos1_publish)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t publish[] = { 0x32, 10, 0x00, 0x03, 'a', '/', 'b', 0x12,
+                                0x34, 'O', 'N', '!' };
+    const uint8_t puback[] = { 0x40, 0x02, 0x12, 0x34 };
+
+    mqtt.setCallback(callback);
+    assertEqual(connect(client, mqtt), 0);
+    client.receive(publish, sizeof(publish));
+    mqtt.run();
+    assertEqual(client.compareSent(puback, sizeof(puback)), 0);
+    assertEqual(strcmp(callbackTopic, "a/b"), 0);
+    assertEqual(callbackLength, 3);
+    assertEqual(memcmp(callbackPayload, "ON!", 3), 0);
+}
+
+test(receive_publish_topic_beyond_packet)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t publish[] = { 0x30, 0x04, 0xFF, 0xFF, 'a', 'b' };
+    const uint8_t publishQos1[] = { 0x32, 0x04, 0xFF, 0xFE, 0x00, 0x01 };
+
+    mqtt.setCallback(callback);
+    callbackLength = 0xFFFF;
+    assertEqual(connect(client, mqtt), 0);
+    client.receive(publish, sizeof(publish));
+    mqtt.run();
+    client.receive(publishQos1, sizeof(publishQos1));
+    mqtt.run();
+    assertEqual(callbackLength, 0xFFFF);
+    assertEqual(client.getSentLength(), 0);
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_CONNECTED);
+}
+
+test(receive_remaining_length_too_long)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t publish[] = { 0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+
+    assertEqual(connect(client, mqtt), 0);
+    client.receive(publish, sizeof(publish));
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_DISCONNECTED);
+    assertEqual(client.connected(), 0);
+}
+
+test(keep_alive)
+{
+    FakeClient client;
+    MQTTClient mqtt(client);
+    const uint8_t pingreq[] = { 0xC0, 0x00 };
+    const uint8_t pingresp[] = { 0xD0, 0x00 };
+
+    assertEqual(connect(client, mqtt), 0);
+    delay(60000UL - 1);
+    mqtt.run();
+    assertEqual(client.getSentLength(), 0);
+    delay(1);
+    mqtt.run();
+    assertEqual(client.compareSent(pingreq, sizeof(pingreq)), 0);
+
+    client.receive(pingresp, sizeof(pingresp));
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_CONNECTED);
+
+    // Nothing received for one and a half keep alive intervals
+    delay(90001UL);
+    mqtt.run();
+    assertEqual(mqtt.getState(), (uint8_t) MQTT_DISCONNECTED);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+}
+
+void loop()
+{
+    Test::run();
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Checks the slot timing of OneWireAsync against a simulated bus with one
+ * slave. Only runs on the host: Timer1 and the busy waits advance the
+ * simulated time and the compare match interrupt is raised by calling
+ * OneWireAsync::handleInterrupt.
+ */
+
+#include <ArduinoUnit.h>
+#include <Framework/OneWireAsync.h>
+
+#define BUS_PIN 9
+#define BUS_PORT digitalPinToPort(BUS_PIN)
+#define BUS_MASK digitalPinToBitMask(BUS_PIN)
+#define TICKS_PER_US (F_CPU / 8000000UL)
+#define MAX_PULSES 200
+
+/**
+ * \brief Low pulse driven by the master.
+ */
+struct Pulse
+{
+    unsigned long fall;
+    unsigned long length;
+};
+
+/**
+ * \brief State of the simulated bus and its slave.
+ */
+struct Bus
+{
+    uint8_t slavePresent;
+    const uint8_t* response;
+    uint8_t masterLow;
+    unsigned long fall;
+    Pulse pulses[MAX_PULSES];
+    uint8_t nrOfPulses;
+    unsigned long presenceStart;
+    unsigned long presenceEnd;
+    unsigned long slaveLowUntil;
+    uint16_t slot;
+    uint16_t txBits;
+    uint8_t received[ONEWIRE_ASYNC_BUFFER_SIZE];
+    unsigned long maxInterrupt;
+};
+
+static Bus bus;
+static OneWireAsync driver;
+
+/*
+ * Updates the slave and the input register after the master changed the
+ * line or time advanced.
+ */
+static void observe()
+{
+    volatile uint8_t* reg = hostPorts[BUS_PORT];
+    uint8_t masterLow = (reg[1] & BUS_MASK) && !(reg[2] & BUS_MASK);
+    unsigned long now = hostMicros;
+    unsigned long length;
+    uint16_t bit;
+    uint8_t lineLow;
+
+    if (masterLow && !bus.masterLow)
+    {
+        bus.fall = now;
+        bit = bus.slot - bus.txBits;
+        // The slave holds a read slot low for 15 µs to send a 0
+        if (bus.slot >= bus.txBits && bus.response != NULL
+            && !(bus.response[bit >> 3] & (1 << (bit & 7))))
+            bus.slaveLowUntil = now + 15;
+    }
+    else if (!masterLow && bus.masterLow)
+    {
+        length = now - bus.fall;
+        if (bus.nrOfPulses < MAX_PULSES)
+        {
+            bus.pulses[bus.nrOfPulses].fall = bus.fall;
+            bus.pulses[bus.nrOfPulses].length = length;
+            bus.nrOfPulses++;
+        }
+        if (length >= 480)
+        {
+            bus.slot = 0;
+            if (bus.slavePresent)
+            {
+                bus.presenceStart = now + 30;
+                bus.presenceEnd = now + 150;
+            }
+        }
+        else
+        {
+            // The slave samples a written bit 30 µs after the falling edge
+            if (bus.slot < bus.txBits && length < 30)
+                bus.received[bus.slot >> 3] |= 1 << (bus.slot & 7);
+            bus.slot++;
+        }
+    }
+    bus.masterLow = masterLow;
+
+    lineLow = masterLow || now < bus.slaveLowUntil
+              || (now >= bus.presenceStart && now < bus.presenceEnd);
+    if (lineLow)
+        reg[0] &= ~BUS_MASK;
+    else
+        reg[0] |= BUS_MASK;
+}
+
+/*
+ * Busy wait inside the interrupt. Timer1 keeps counting.
+ */
+static void busyWait(unsigned int us)
+{
+    observe();
+    hostAdvance(us);
+    TCNT1 += us * TICKS_PER_US;
+    observe();
+}
+
+/*
+ * Prepares the bus for the next transaction.
+ */
+static void resetBus(uint8_t slavePresent, const uint8_t* response)
+{
+    memset(&bus, 0, sizeof(bus));
+    bus.slavePresent = slavePresent;
+    bus.response = response;
+    hostDelayHook = busyWait;
+    hostPorts[BUS_PORT][1] &= ~BUS_MASK;
+    hostPorts[BUS_PORT][2] &= ~BUS_MASK;
+    observe();
+}
+
+/*
+ * Runs a transaction to its end. Time advances to the programmed compare
+ * match, then Timer1 is cleared as in CTC mode and the interrupt is raised.
+ */
+static int8_t transfer(const uint8_t* tx, uint8_t txLength, uint8_t rxLength,
+                       uint8_t flags)
+{
+    unsigned long entry;
+
+    bus.txBits = txLength * 8;
+    if (driver.start(BUS_PIN, tx, txLength, rxLength, flags) != 0)
+        return -1;
+
+    while (driver.isBusy())
+    {
+        if (OCR1A < TCNT1 || !(TIMSK1 & _BV(OCIE1A)))
+            return -1;
+        hostAdvance((OCR1A - TCNT1) / TICKS_PER_US);
+        TCNT1 = 0;
+        observe();
+        entry = hostMicros;
+        driver.handleInterrupt();
+        observe();
+        if (hostMicros - entry > bus.maxInterrupt)
+            bus.maxInterrupt = hostMicros - entry;
+    }
+    return 0;
+}
+
+test(reset_detects_presence)
+{
+    uint8_t skipRom = 0xCC;
+
+    resetBus(1, NULL);
+    assertEqual(transfer(&skipRom, 1, 0, ONEWIRE_ASYNC_RESET), 0);
+    assertEqual(driver.getPresence(), 1);
+    assertMoreOrEqual(bus.nrOfPulses, 1);
+    assertMoreOrEqual(bus.pulses[0].length, 480UL);
+    assertMoreOrEqual(bus.pulses[1].fall - bus.pulses[0].fall
+                      - bus.pulses[0].length, 480UL);
+}
+
+test(reset_without_slave)
+{
+    uint8_t skipRom = 0xCC;
+
+    resetBus(0, NULL);
+    assertEqual(transfer(&skipRom, 1, 0, ONEWIRE_ASYNC_RESET), 0);
+    assertEqual(driver.getPresence(), 0);
+}
+
+test(write_slot_timing)
+{
+    const uint8_t tx[] = { 0xCC, 0x4E, 0x4B, 0x46, 0x7F };
+    uint8_t i;
+    uint8_t bit;
+    const Pulse* pulse;
+
+    resetBus(1, NULL);
+    assertEqual(transfer(tx, sizeof(tx), 0, ONEWIRE_ASYNC_RESET), 0);
+    assertEqual(bus.nrOfPulses, 1 + sizeof(tx) * 8);
+    assertEqual(memcmp(bus.received, tx, sizeof(tx)), 0);
+
+    for (i = 1; i < bus.nrOfPulses; i++)
+    {
+        pulse = &bus.pulses[i];
+        bit = tx[(i - 1) >> 3] & (1 << ((i - 1) & 7));
+        if (bit)
+        {
+            assertMoreOrEqual(pulse->length, 1UL);
+            assertLessOrEqual(pulse->length, 15UL);
+        }
+        else
+        {
+            assertMoreOrEqual(pulse->length, 60UL);
+            assertLessOrEqual(pulse->length, 120UL);
+        }
+        if (i + 1 < bus.nrOfPulses)
+        {
+            // Slot length and recovery time between two slots
+            assertMoreOrEqual(pulse[1].fall - pulse->fall, 60UL);
+            assertMoreOrEqual(pulse[1].fall - pulse->fall - pulse->length,
+                              1UL);
+        }
+    }
+    assertLessOrEqual(bus.maxInterrupt, 15UL);
+}
+
+test(read_slot_timing)
+{
+    const uint8_t tx[] = { 0xCC, 0xBE };
+    const uint8_t scratchpad[] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C,
+                                   0x10, 0x1C };
+    uint8_t rx[sizeof(scratchpad)];
+    uint8_t i;
+    const Pulse* pulse;
+
+    resetBus(1, scratchpad);
+    assertEqual(transfer(tx, sizeof(tx), sizeof(rx), ONEWIRE_ASYNC_RESET),
+                0);
+    assertEqual(driver.getResult(rx, sizeof(rx)), (int8_t) sizeof(rx));
+    assertEqual(memcmp(rx, scratchpad, sizeof(rx)), 0);
+    assertEqual(bus.nrOfPulses, 1 + (sizeof(tx) + sizeof(rx)) * 8);
+
+    for (i = 1 + sizeof(tx) * 8; i < bus.nrOfPulses; i++)
+    {
+        pulse = &bus.pulses[i];
+        // Released by the master, a 0 is still held by the slave
+        assertMoreOrEqual(pulse->length, 1UL);
+        assertLessOrEqual(pulse->length, 15UL);
+        if (i + 1 < bus.nrOfPulses)
+            assertMoreOrEqual(pulse[1].fall - pulse->fall, 60UL);
+    }
+    assertLessOrEqual(bus.maxInterrupt, 15UL);
+}
+
+test(power_after_transaction)
+{
+    uint8_t convert[] = { 0xCC, 0x44 };
+    volatile uint8_t* reg = hostPorts[BUS_PORT];
+
+    resetBus(1, NULL);
+    assertEqual(transfer(convert, sizeof(convert), 0,
+                         ONEWIRE_ASYNC_RESET | ONEWIRE_ASYNC_POWER), 0);
+    assertTrue((reg[1] & BUS_MASK) && (reg[2] & BUS_MASK));
+    assertEqual(driver.getEndTime(), millis());
+    assertEqual(TIMSK1 & _BV(OCIE1A), 0);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+}
+
+void loop()
+{
+    Test::run();
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Checks the CRC8 and CRC16 of OneWire against bitwise reference
+ * implementations and measures their cost per byte. The Makefile builds one
+ * binary per algorithm selected by ONEWIRE_CRC8_TABLE and
+ * ONEWIRE_CRC16_TABLE.
+ */
+
+#include <ArduinoUnit.h>
+#include <OneWire.h>
+
+#define BENCH_LENGTH 240
+#define BENCH_ROUNDS 2000
+
+#if ONEWIRE_CRC8_TABLE == ONEWIRE_CRC_FULL
+#define VARIANT "full table"
+#elif ONEWIRE_CRC8_TABLE == ONEWIRE_CRC_NIBBLE
+#define VARIANT "nibble tables"
+#else
+#define VARIANT "bitwise"
+#endif
+
+static uint8_t data[BENCH_LENGTH];
+static volatile uint16_t sink;
+
+/*
+ * Dallas CRC8, polynomial x^8 + x^5 + x^4 + 1, LSB first
+ */
+static uint8_t referenceCrc8(const uint8_t* input, uint16_t length)
+{
+    uint8_t crc = 0;
+    uint8_t i;
+
+    while (length--)
+    {
+        crc ^= *input++;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+    }
+    return crc;
+}
+
+/*
+ * CRC16, polynomial x^16 + x^15 + x^2 + 1, LSB first, seed 0
+ */
+static uint16_t referenceCrc16(const uint8_t* input, uint16_t length)
+{
+    uint16_t crc = 0;
+    uint8_t i;
+
+    while (length--)
+    {
+        crc ^= *input++;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    return crc;
+}
+
+static void fill(uint8_t* buffer, uint16_t length, uint32_t seed)
+{
+    while (length--)
+    {
+        seed = seed * 1103515245UL + 12345;
+        *buffer++ = seed >> 16;
+    }
+}
+
+static void report(const char* name, unsigned long long cycles)
+{
+    Serial.print(name);
+    Serial.print(F(" " VARIANT ": "));
+    Serial.print((double) cycles / ((double) BENCH_ROUNDS * BENCH_LENGTH), 2);
+    Serial.println(F(" " HOST_CYCLES_UNIT "/byte"));
+}
+
+test(crc8_known_values)
+{
+    // ROM code from Maxim application note 27 and a DS18B20 scratchpad
+    uint8_t rom[] = { 0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00 };
+    uint8_t scratchpad[] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10 };
+    uint8_t check[] = "123456789";
+
+    assertEqual(OneWire::crc8(rom, sizeof(rom)), 0xA2);
+    assertEqual(OneWire::crc8(scratchpad, sizeof(scratchpad)), 0x1C);
+    assertEqual(OneWire::crc8(check, 9), 0xA1);
+}
+
+test(crc16_known_values)
+{
+    uint8_t check[] = "123456789";
+    uint8_t inverted[] = { 0xC2, 0x44 };
+
+    assertEqual(OneWire::crc16(check, 9), 0xBB3D);
+    assertTrue(OneWire::check_crc16(check, 9, inverted));
+}
+
+test(crc_matches_reference)
+{
+    uint16_t length;
+    uint32_t seed;
+
+    for (seed = 1; seed < 200; seed++)
+    {
+        length = seed % BENCH_LENGTH;
+        fill(data, length, seed);
+        assertEqual(OneWire::crc8(data, length),
+                    referenceCrc8(data, length));
+        assertEqual(OneWire::crc16(data, length),
+                    referenceCrc16(data, length));
+    }
+}
+
+test(crc8_benchmark)
+{
+    unsigned long long start;
+    unsigned long long cycles;
+    uint16_t i;
+    uint8_t crc = 0;
+
+    fill(data, sizeof(data), 42);
+    start = hostCycles();
+    for (i = 0; i < BENCH_ROUNDS; i++)
+    {
+        data[0] = i;
+        crc ^= OneWire::crc8(data, sizeof(data));
+    }
+    cycles = hostCycles() - start;
+    sink = crc;
+    report("crc8", cycles);
+}
+
+test(crc16_benchmark)
+{
+    unsigned long long start;
+    unsigned long long cycles;
+    uint16_t i;
+    uint16_t crc = 0;
+
+    fill(data, sizeof(data), 42);
+    start = hostCycles();
+    for (i = 0; i < BENCH_ROUNDS; i++)
+    {
+        data[0] = i;
+        crc ^= OneWire::crc16(data, sizeof(data));
+    }
+    cycles = hostCycles() - start;
+    sink = crc;
+    report("crc16", cycles);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+}
+
+void loop()
+{
+    Test::run();
+}
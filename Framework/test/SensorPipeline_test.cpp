@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Compares the sensor to controller pipeline with and without
+ * FIXED_POINT_SENSORS. Each tick reads all sensors as Aquaduino::readSensors
+ * does and runs one controller per sensor. The fixed point pipeline drives
+ * the real TemperatureController, which is built with FIXED_POINT_SENSORS as
+ * configured. The floating point branch of TemperatureController::run is
+ * not selected by the configuration, so it is modelled here as reference.
+ * The sensors are real Sensor objects producing DS18S20 samples through
+ * their SensorFilter.
+ *
+ * The benchmark only shows the overhead on the host, which has a floating
+ * point unit. On the ATmega2560 every double operation is a call into the
+ * software floating point library.
+ */
+
+#include <ArduinoUnit.h>
+#include <HostAquaduino.h>
+#include <Controller/TemperatureController.h>
+
+#define NR_OF_SENSORS 8
+#define BENCH_TICKS 20000
+
+/**
+ * \brief Sensor producing DS18S20 samples, a slow triangle around 25 °C.
+ *
+ * readMilli and read are implemented like in DS18S20.
+ */
+class PipelineSensor: public Sensor
+{
+public:
+    PipelineSensor() :
+            m_Raw(0), m_Step(1)
+    {
+    }
+
+    void start(int16_t raw)
+    {
+        m_Raw = raw;
+        m_Step = 1;
+        m_Filter.configure(FILTER_AVERAGE, 4);
+    }
+
+    virtual double read()
+    {
+        return readMilli() / 1000.0;
+    }
+
+    virtual int32_t readMilli()
+    {
+        // 1/16 °C steps between 20 °C and 30 °C
+        m_Raw += m_Step;
+        if (m_Raw >= 30 * 16 || m_Raw <= 20 * 16)
+            m_Step = -m_Step;
+        return m_Filter.add((int32_t) m_Raw * 125 / 2);
+    }
+
+    virtual uint16_t serialize(Stream* s)
+    {
+        return 0;
+    }
+
+    virtual uint16_t deserialize(Stream* s)
+    {
+        return 0;
+    }
+
+private:
+    int16_t m_Raw;
+    int8_t m_Step;
+};
+
+/**
+ * \brief Actuator which is only switched on and off.
+ */
+class SwitchActuator: public Actuator
+{
+public:
+    SwitchActuator() :
+            Actuator("Switch"), m_On(0)
+    {
+    }
+
+    virtual void on()
+    {
+        m_On = 1;
+    }
+
+    virtual void off()
+    {
+        m_On = 0;
+    }
+
+    virtual void forceOn()
+    {
+        m_On = 1;
+    }
+
+    virtual void forceOff()
+    {
+        m_On = 0;
+    }
+
+    virtual int8_t isOn()
+    {
+        return m_On;
+    }
+
+    virtual int8_t supportsPWM()
+    {
+        return 0;
+    }
+
+    virtual void setPWM(float dutyCycle)
+    {
+    }
+
+    virtual float getPWM()
+    {
+        return m_On;
+    }
+
+    virtual uint16_t serialize(Stream* s)
+    {
+        return 0;
+    }
+
+    virtual uint16_t deserialize(Stream* s)
+    {
+        return 0;
+    }
+
+private:
+    int8_t m_On;
+};
+
+static double floatReadings[NR_OF_SENSORS];
+
+/**
+ * \brief TemperatureController::run as built without FIXED_POINT_SENSORS.
+ *
+ * Reads floatReadings instead of Aquaduino::getSensorValue.
+ */
+class FloatController: public Controller
+{
+public:
+    FloatController() :
+            Controller("Float")
+    {
+    }
+
+    void configure(uint8_t sensor, Actuator* heater, Actuator* cooler,
+                   double refTemp1, double refTemp2, double hysteresis)
+    {
+        m_Sensor = sensor;
+        m_Heater = heater;
+        m_Cooler = cooler;
+        m_HeatOn = refTemp1;
+        m_HeatOff = refTemp1 + hysteresis;
+        m_CoolOn = refTemp2;
+        m_CoolOff = refTemp2 - hysteresis;
+        m_Heating = 0;
+        m_Cooling = 0;
+    }
+
+    virtual int8_t run()
+    {
+        float temp = floatReadings[m_Sensor];
+
+        if (temp < m_HeatOn)
+        {
+            m_Heater->on();
+            m_Heating = 1;
+        }
+        else if (m_Heating && (temp > m_HeatOff))
+        {
+            m_Heater->off();
+            m_Heating = 0;
+        }
+
+        if (temp > m_CoolOn)
+        {
+            m_Cooler->on();
+            m_Cooling = 1;
+        }
+        else if (m_Cooling && temp < m_CoolOff)
+        {
+            m_Cooler->off();
+            m_Cooling = 0;
+        }
+        return true;
+    }
+
+    virtual uint16_t serialize(Stream* s)
+    {
+        return 0;
+    }
+
+    virtual uint16_t deserialize(Stream* s)
+    {
+        return 0;
+    }
+
+private:
+    uint8_t m_Sensor;
+    Actuator* m_Heater;
+    Actuator* m_Cooler;
+    float m_HeatOn;
+    float m_HeatOff;
+    float m_CoolOn;
+    float m_CoolOff;
+    int8_t m_Heating;
+    int8_t m_Cooling;
+};
+
+static PipelineSensor fixedSensors[NR_OF_SENSORS];
+static PipelineSensor floatSensors[NR_OF_SENSORS];
+static SwitchActuator heaters[NR_OF_SENSORS];
+static SwitchActuator coolers[NR_OF_SENSORS];
+static SwitchActuator floatHeaters[NR_OF_SENSORS];
+static SwitchActuator floatCoolers[NR_OF_SENSORS];
+static TemperatureController* controllers[NR_OF_SENSORS];
+static FloatController floatControllers[NR_OF_SENSORS];
+
+/*
+ * Configures the controller of a sensor. The reference temperatures and
+ * hysteresis are given in degree. Heater and cooler are switched off.
+ */
+static void configure(uint8_t i, double refTemp1, double refTemp2,
+                      double hysteresis)
+{
+    TemperatureController* controller = controllers[i];
+
+    controller->setRefTempLow(refTemp1);
+    controller->setHeatingHysteresis(hysteresis);
+    controller->setRefTempHigh(refTemp2);
+    controller->setCoolingHysteresis(hysteresis);
+    heaters[i].off();
+    coolers[i].off();
+    // Clears the state kept by the controller
+    hostSensorReadings[i] = lround((refTemp1 + refTemp2) * 500);
+    controller->run();
+
+    floatControllers[i].configure(i, &floatHeaters[i], &floatCoolers[i],
+                                  refTemp1, refTemp2, hysteresis);
+    floatHeaters[i].off();
+    floatCoolers[i].off();
+}
+
+/*
+ * Sets both pipelines to the same state.
+ */
+static void startPipelines()
+{
+    uint8_t i;
+
+    for (i = 0; i < NR_OF_SENSORS; i++)
+    {
+        fixedSensors[i].start(20 * 16 + i * 10);
+        floatSensors[i].start(20 * 16 + i * 10);
+        configure(i, 22 + i % 3, 27 + i % 2, 0.5);
+    }
+}
+
+/*
+ * Aquaduino::readSensors and executeControllers with FIXED_POINT_SENSORS.
+ */
+static void tickFixed()
+{
+    uint8_t i;
+
+    for (i = 0; i < NR_OF_SENSORS; i++)
+        hostSensorReadings[i] = fixedSensors[i].readMilli();
+    for (i = 0; i < NR_OF_SENSORS; i++)
+        controllers[i]->run();
+}
+
+/*
+ * The same without FIXED_POINT_SENSORS.
+ */
+static void tickFloat()
+{
+    uint8_t i;
+
+    for (i = 0; i < NR_OF_SENSORS; i++)
+        floatReadings[i] = floatSensors[i].read();
+    for (i = 0; i < NR_OF_SENSORS; i++)
+        floatControllers[i].run();
+}
+
+test(fixed_point_switches_like_float)
+{
+    uint16_t tick;
+    uint8_t i;
+    uint16_t heatingTicks = 0;
+    uint16_t coolingTicks = 0;
+
+    startPipelines();
+    for (tick = 0; tick < 1000; tick++)
+    {
+        tickFixed();
+        tickFloat();
+        for (i = 0; i < NR_OF_SENSORS; i++)
+        {
+            assertEqual(hostSensorReadings[i],
+                        (int32_t) floor(floatReadings[i] * 1000 + 0.5));
+            assertEqual(heaters[i].isOn(), floatHeaters[i].isOn());
+            assertEqual(coolers[i].isOn(), floatCoolers[i].isOn());
+            heatingTicks += heaters[i].isOn();
+            coolingTicks += coolers[i].isOn();
+        }
+    }
+    // The trace has to cross the thresholds to prove anything
+    assertMore(heatingTicks, 0);
+    assertMore(coolingTicks, 0);
+}
+
+test(thresholds_are_rounded)
+{
+    // 16.06 * 1000 is 16059.999... in double
+    startPipelines();
+    configure(0, 16.06, 30, 0.5);
+
+    hostSensorReadings[0] = 16060;
+    controllers[0]->run();
+    assertEqual(heaters[0].isOn(), 0);
+    hostSensorReadings[0] = 16059;
+    controllers[0]->run();
+    assertEqual(heaters[0].isOn(), 1);
+    hostSensorReadings[0] = 16560;
+    controllers[0]->run();
+    assertEqual(heaters[0].isOn(), 1);
+    hostSensorReadings[0] = 16561;
+    controllers[0]->run();
+    assertEqual(heaters[0].isOn(), 0);
+}
+
+test(pipeline_benchmark)
+{
+    unsigned long long start;
+    unsigned long long fixedCycles;
+    unsigned long long floatCycles;
+    uint16_t tick;
+
+    startPipelines();
+    start = hostCycles();
+    for (tick = 0; tick < BENCH_TICKS; tick++)
+        tickFixed();
+    fixedCycles = hostCycles() - start;
+
+    start = hostCycles();
+    for (tick = 0; tick < BENCH_TICKS; tick++)
+        tickFloat();
+    floatCycles = hostCycles() - start;
+
+    Serial.print(F("fixed point: "));
+    Serial.print((double) fixedCycles / BENCH_TICKS, 1);
+    Serial.println(F(" " HOST_CYCLES_UNIT "/tick"));
+    Serial.print(F("floating point: "));
+    Serial.print((double) floatCycles / BENCH_TICKS, 1);
+    Serial.println(F(" " HOST_CYCLES_UNIT "/tick"));
+}
+
+void setup()
+{
+    uint8_t i;
+
+    Serial.begin(9600);
+    for (i = 0; i < NR_OF_SENSORS; i++)
+    {
+        hostSensors[i] = &fixedSensors[i];
+        hostActuators[2 * i] = &heaters[i];
+        hostActuators[2 * i + 1] = &coolers[i];
+        controllers[i] = new TemperatureController("Temperature");
+        hostControllers[i] = controllers[i];
+        controllers[i]->assignSensor(i);
+        controllers[i]->assignHeatingActuator(2 * i);
+        controllers[i]->assignCoolingActuator(2 * i + 1);
+    }
+}
+
+void loop()
+{
+    Test::run();
+}
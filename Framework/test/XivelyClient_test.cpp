@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Checks the requests XivelyClient sends for a feed of 8 datastreams and
+ * measures the cost per upload of rendering the body once into the scratch
+ * buffer against counting it first. The server is a fake Client answering
+ * every request with an empty 200 response.
+ */
+
+#include <ArduinoUnit.h>
+#include <Client.h>
+#include <Xively.h>
+
+#define DATASTREAMS 8
+#define BENCH_ROUNDS 2000
+#define FEED_ID 123456
+#define API_KEY "0123456789abcdef"
+#define RESPONSE "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"
+
+/**
+ * \brief Client recording the last request and answering it with 200.
+ */
+class FakeServer: public Client
+{
+public:
+    FakeServer() :
+            m_Connected(0), m_Connects(0), m_SentLength(0), m_ReceivedPos(0)
+    {
+    }
+
+    virtual int connect(IPAddress ip, uint16_t port)
+    {
+        m_Connected = 1;
+        m_Connects++;
+        return 1;
+    }
+
+    virtual int connect(const char* host, uint16_t port)
+    {
+        m_Connected = 1;
+        m_Connects++;
+        return 1;
+    }
+
+    virtual size_t write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+
+    virtual size_t write(const uint8_t* buf, size_t size)
+    {
+        if (!m_Connected)
+            return 0;
+        // Once the response was read the next request starts
+        if (m_ReceivedPos > 0)
+        {
+            m_ReceivedPos = 0;
+            m_SentLength = 0;
+        }
+        if (m_SentLength + size <= sizeof(m_Sent))
+            memcpy(&m_Sent[m_SentLength], buf, size);
+        m_SentLength += size;
+        return size;
+    }
+
+    virtual int available()
+    {
+        return sizeof(RESPONSE) - 1 - m_ReceivedPos;
+    }
+
+    virtual int read()
+    {
+        if (!available())
+            return -1;
+        return RESPONSE[m_ReceivedPos++];
+    }
+
+    virtual int read(uint8_t* buf, size_t size)
+    {
+        size_t i;
+
+        for (i = 0; i < size && available(); i++)
+            buf[i] = read();
+        return i;
+    }
+
+    virtual int peek()
+    {
+        if (!available())
+            return -1;
+        return RESPONSE[m_ReceivedPos];
+    }
+
+    virtual void flush()
+    {
+    }
+
+    virtual void stop()
+    {
+        m_Connected = 0;
+    }
+
+    virtual uint8_t connected()
+    {
+        return m_Connected;
+    }
+
+    virtual operator bool()
+    {
+        return m_Connected;
+    }
+
+    /**
+     * \brief Compares the last request.
+     *
+     * \returns 0 if it matches.
+     */
+    int8_t compareSent(const char* expected)
+    {
+        return strlen(expected) != m_SentLength
+               || memcmp(m_Sent, expected, m_SentLength) != 0;
+    }
+
+    uint16_t getConnects()
+    {
+        return m_Connects;
+    }
+
+private:
+    uint8_t m_Connected;
+    uint16_t m_Connects;
+    uint8_t m_Sent[1024];
+    size_t m_SentLength;
+    uint8_t m_ReceivedPos;
+};
+
+#define BODY "{\"version\":\"1.0.0\",\"datastreams\":[" \
+    "{\"id\":\"temp0\",\"current_value\":\"24.50\"}," \
+    "{\"id\":\"temp1\",\"current_value\":\"-1.25\"}," \
+    "{\"id\":\"temp2\",\"current_value\":\"0.07\"}," \
+    "{\"id\":\"ph\",\"current_value\":\"7.01\"}," \
+    "{\"id\":\"redox\",\"current_value\":\"312.00\"}," \
+    "{\"id\":\"flow\",\"current_value\":\"1530.75\"}," \
+    "{\"id\":\"level\",\"current_value\":\"-0.50\"}," \
+    "{\"id\":\"light\",\"current_value\":\"100.00\"}]}"
+
+static const char expectedRequest[] =
+        "PUT /v2/feeds/123456.json HTTP/1.1\r\n"
+        "Host: api.xively.com\r\n"
+        "User-Agent: Arduino/2.0\r\n"
+        "X-ApiKey: " API_KEY "\r\n"
+        "User-Agent: Xively-Arduino-Lib/1.0\r\n"
+        "Content-Length: 345\r\n"
+        "\r\n"
+        BODY;
+
+static char ids[DATASTREAMS][6] =
+{ "temp0", "temp1", "temp2", "ph", "redox", "flow", "level", "light" };
+static const float values[DATASTREAMS] =
+{ 24.5, -1.25, 0.07, 7.01, 312, 1530.75, -0.5, 100 };
+
+static XivelyDatastream* datastreams[DATASTREAMS];
+static FakeServer server;
+static XivelyClient xively(server);
+
+/*
+ * Creates the datastreams of the feed with the values above.
+ */
+static void setValues()
+{
+    uint8_t i;
+
+    for (i = 0; i < DATASTREAMS; i++)
+    {
+        if (datastreams[i] == NULL)
+            datastreams[i] = new XivelyDatastream(ids[i], sizeof(ids[i]),
+                                                  DATASTREAM_FLOAT);
+        datastreams[i]->setFloat(values[i]);
+    }
+}
+
+static void report(const char* name, unsigned long long cycles)
+{
+    Serial.print(name);
+    Serial.print(F(", 8 datastreams: "));
+    Serial.print((double) cycles / BENCH_ROUNDS, 0);
+    Serial.println(F(" " HOST_CYCLES_UNIT "/upload"));
+}
+
+test(put_feed_renders_once)
+{
+    XivelyFeed feed(FEED_ID, datastreams, DATASTREAMS);
+
+    assertEqual(sizeof(BODY) - 1, 345U);
+    assertEqual(xively.put(feed, API_KEY), 200);
+    assertEqual(server.compareSent(expectedRequest), 0);
+}
+
+test(put_printable_counts_first)
+{
+    XivelyFeed feed(FEED_ID, datastreams, DATASTREAMS);
+    const Printable& body = feed;
+
+    assertEqual(xively.put(FEED_ID, body, API_KEY), 200);
+    assertEqual(server.compareSent(expectedRequest), 0);
+}
+
+test(put_keeps_connection)
+{
+    XivelyFeed feed(FEED_ID, datastreams, DATASTREAMS);
+    uint16_t connects;
+
+    assertEqual(xively.put(feed, API_KEY), 200);
+    connects = server.getConnects();
+    assertEqual(xively.put(feed, API_KEY), 200);
+    assertEqual(server.getConnects(), connects);
+}
+
+test(upload_benchmark)
+{
+    XivelyFeed feed(FEED_ID, datastreams, DATASTREAMS);
+    const Printable& body = feed;
+    unsigned long long start;
+    unsigned long long cycles;
+    uint16_t i;
+
+    start = hostCycles();
+    for (i = 0; i < BENCH_ROUNDS; i++)
+        xively.put(feed, API_KEY);
+    cycles = hostCycles() - start;
+    report("single pass", cycles);
+
+    start = hostCycles();
+    for (i = 0; i < BENCH_ROUNDS; i++)
+        xively.put(FEED_ID, body, API_KEY);
+    cycles = hostCycles() - start;
+    report("count and send", cycles);
+
+    assertEqual(server.compareSent(expectedRequest), 0);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+    setValues();
+}
+
+void loop()
+{
+    Test::run();
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Replacement of the Arduino core for the host builds of the tests. It is
+ * included ahead of every translation unit and uses the include guard of
+ * libraries/Arduino/Arduino.h so that the AVR version is never pulled in.
+ *
+ * Time is simulated. It only advances by delayMicroseconds and hostAdvance.
+ * Digital pins map to the fake ports hostPorts, each consisting of the PIN,
+ * DDR and PORT register in the order the AVR uses.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#ifdef abs
+#undef abs
+#endif
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+#define interrupts() sei()
+#define noInterrupts() cli()
+
+#define clockCyclesPerMicrosecond() ( F_CPU / 1000000L )
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+typedef unsigned int word;
+typedef uint8_t boolean;
+typedef uint8_t byte;
+
+#define HOST_PORTS 4
+
+#define digitalPinToPort(P) ((P) / 8)
+#define digitalPinToBitMask(P) ((uint8_t) (1 << ((P) % 8)))
+#define portInputRegister(P) (&hostPorts[(P)][0])
+#define portModeRegister(P) (&hostPorts[(P)][1])
+#define portOutputRegister(P) (&hostPorts[(P)][2])
+
+extern volatile uint8_t hostPorts[HOST_PORTS][3];
+
+/**
+ * \brief Simulated time in microseconds.
+ */
+extern unsigned long hostMicros;
+
+/**
+ * \brief Called by delayMicroseconds instead of advancing hostMicros.
+ *
+ * Lets a test model what happens while the code under test busy waits.
+ */
+extern void (*hostDelayHook)(unsigned int us);
+
+void hostAdvance(unsigned long us);
+unsigned long long hostCycles();
+
+#if defined(__i386__) || defined(__x86_64__)
+#define HOST_CYCLES_UNIT "TSC cycles"
+#else
+#define HOST_CYCLES_UNIT "ns"
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+extern "C"
+{
+char* itoa(int value, char* buffer, int base);
+char* utoa(unsigned int value, char* buffer, int base);
+char* ltoa(long value, char* buffer, int base);
+char* ultoa(unsigned long value, char* buffer, int base);
+char* dtostrf(double value, signed char width, unsigned char precision,
+              char* buffer);
+}
+
+#include "WString.h"
+#include "Stream.h"
+
+/**
+ * \brief Serial port printing to stdout.
+ */
+class HostSerial: public Stream
+{
+public:
+    void begin(unsigned long baud);
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    virtual void flush();
+    virtual size_t write(uint8_t c);
+    using Print::write;
+};
+
+extern HostSerial Serial;
+
+void setup(void);
+void loop(void);
+
+#endif
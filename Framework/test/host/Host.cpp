@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <time.h>
+#include <ArduinoUnit.h>
+#include <SD.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+volatile uint8_t SREG = _BV(SREG_I);
+volatile uint8_t TCCR1A;
+volatile uint8_t TCCR1B;
+volatile uint16_t TCNT1;
+volatile uint16_t OCR1A;
+volatile uint8_t TIFR1;
+volatile uint8_t TIMSK1;
+
+volatile uint8_t hostPorts[HOST_PORTS][3];
+
+unsigned long hostMicros;
+void (*hostDelayHook)(unsigned int us);
+
+HostSerial Serial;
+SDClass SD;
+
+/**
+ * \brief Advances the simulated time.
+ * \param[in] us Microseconds to advance.
+ */
+void hostAdvance(unsigned long us)
+{
+    hostMicros += us;
+}
+
+/**
+ * \brief Reads a free running counter for the benchmarks.
+ *
+ * \returns The time stamp counter on x86. Nanoseconds elsewhere, see
+ * HOST_CYCLES_UNIT.
+ */
+unsigned long long hostCycles()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+unsigned long millis(void)
+{
+    return hostMicros / 1000;
+}
+
+unsigned long micros(void)
+{
+    return hostMicros;
+}
+
+void delay(unsigned long ms)
+{
+    hostAdvance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (hostDelayHook != NULL)
+        hostDelayHook(us);
+    else
+        hostAdvance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    volatile uint8_t* reg = portModeRegister(digitalPinToPort(pin));
+
+    if (mode == OUTPUT)
+        *reg |= digitalPinToBitMask(pin);
+    else
+        *reg &= ~digitalPinToBitMask(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    volatile uint8_t* reg = portOutputRegister(digitalPinToPort(pin));
+
+    if (val)
+        *reg |= digitalPinToBitMask(pin);
+    else
+        *reg &= ~digitalPinToBitMask(pin);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (*portInputRegister(digitalPinToPort(pin))
+            & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+/*
+ * Number conversions of the avr-libc used by WString.
+ */
+
+char* ultoa(unsigned long value, char* buffer, int base)
+{
+    char digits[sizeof(value) * 8 + 1];
+    uint8_t count = 0;
+    uint8_t i;
+
+    do
+    {
+        digits[count++] = "0123456789abcdefghijklmnopqrstuvwxyz"[value % base];
+        value /= base;
+    } while (value > 0);
+    for (i = 0; i < count; i++)
+        buffer[i] = digits[count - 1 - i];
+    buffer[count] = 0;
+    return buffer;
+}
+
+char* ltoa(long value, char* buffer, int base)
+{
+    if (value < 0 && base == 10)
+    {
+        buffer[0] = '-';
+        ultoa(-(unsigned long) value, &buffer[1], base);
+        return buffer;
+    }
+    return ultoa((unsigned long) value, buffer, base);
+}
+
+char* itoa(int value, char* buffer, int base)
+{
+    if (base == 10)
+        return ltoa(value, buffer, base);
+    return ultoa((unsigned int) value, buffer, base);
+}
+
+char* utoa(unsigned int value, char* buffer, int base)
+{
+    return ultoa(value, buffer, base);
+}
+
+char* dtostrf(double value, signed char width, unsigned char precision,
+              char* buffer)
+{
+    sprintf(buffer, "%*.*f", width, precision, value);
+    return buffer;
+}
+
+void HostSerial::begin(unsigned long baud)
+{
+}
+
+int HostSerial::available()
+{
+    return 0;
+}
+
+int HostSerial::read()
+{
+    return -1;
+}
+
+int HostSerial::peek()
+{
+    return -1;
+}
+
+void HostSerial::flush()
+{
+    fflush(stdout);
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+    putchar(c);
+    return 1;
+}
+
+/**
+ * \brief Runs the sketch until all tests are resolved.
+ *
+ * \returns The number of failed tests as exit code.
+ */
+int main()
+{
+    setup();
+    while (Test::getCurrentPassed() + Test::getCurrentFailed()
+           + Test::getCurrentSkipped() < Test::getCurrentCount())
+        loop();
+    fflush(stdout);
+    return Test::getCurrentFailed();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "HostAquaduino.h"
+
+Sensor* hostSensors[MAX_SENSORS];
+int32_t hostSensorReadings[MAX_SENSORS];
+Actuator* hostActuators[MAX_ACTUATORS];
+Controller* hostControllers[MAX_CONTROLLERS];
+int8_t hostTimezone;
+
+static double hostAquaduino[sizeof(Aquaduino) / sizeof(double) + 1];
+Aquaduino* __aquaduino = (Aquaduino*) hostAquaduino;
+
+int8_t Aquaduino::getTimezone()
+{
+    return hostTimezone;
+}
+
+Sensor* Aquaduino::getSensor(unsigned int sensor)
+{
+    if (sensor < MAX_SENSORS)
+        return hostSensors[sensor];
+    return NULL;
+}
+
+double Aquaduino::getSensorValue(int8_t idx)
+{
+    if (idx >= 0 && idx < MAX_SENSORS)
+        return hostSensorReadings[idx] / 1000.0;
+    return 0;
+}
+
+int32_t Aquaduino::getSensorMilliValue(int8_t idx)
+{
+    if (idx >= 0 && idx < MAX_SENSORS)
+        return hostSensorReadings[idx];
+    return 0;
+}
+
+Actuator* Aquaduino::getActuator(unsigned int actuator)
+{
+    if (actuator < MAX_ACTUATORS)
+        return hostActuators[actuator];
+    return NULL;
+}
+
+int8_t Aquaduino::getAssignedActuators(Controller* controller,
+                                       Actuator** actuators, int8_t max)
+{
+    int8_t controllerIdx = -1;
+    int8_t nrOfAssignedActuators = 0;
+    int8_t i;
+
+    for (i = 0; i < MAX_CONTROLLERS; i++)
+    {
+        if (hostControllers[i] == controller)
+            controllerIdx = i;
+    }
+    for (i = 0; i < MAX_ACTUATORS; i++)
+    {
+        if (hostActuators[i]
+            && hostActuators[i]->getController() == controllerIdx)
+        {
+            if (nrOfAssignedActuators < max)
+                actuators[nrOfAssignedActuators] = hostActuators[i];
+            nrOfAssignedActuators++;
+        }
+    }
+    return nrOfAssignedActuators;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Stand-in for the Aquaduino object in the host builds of the tests.
+ *
+ * Aquaduino itself is never constructed on the host. The members called by
+ * the code under test are defined in HostAquaduino.cpp on top of the tables
+ * below, which the tests fill in. __aquaduino only points at storage of the
+ * right size.
+ */
+
+#ifndef HOSTAQUADUINO_H_
+#define HOSTAQUADUINO_H_
+
+#include <Framework/Aquaduino.h>
+
+/**
+ * \brief Sensors returned by Aquaduino::getSensor indexed by sensor ID.
+ */
+extern Sensor* hostSensors[MAX_SENSORS];
+
+/**
+ * \brief Readings in milli-units returned by Aquaduino::getSensorMilliValue
+ * and Aquaduino::getSensorValue indexed by sensor ID.
+ */
+extern int32_t hostSensorReadings[MAX_SENSORS];
+
+/**
+ * \brief Actuators returned by Aquaduino::getActuator indexed by actuator ID.
+ */
+extern Actuator* hostActuators[MAX_ACTUATORS];
+
+/**
+ * \brief Controllers indexed by controller ID.
+ */
+extern Controller* hostControllers[MAX_CONTROLLERS];
+
+/**
+ * \brief Timezone returned by Aquaduino::getTimezone.
+ */
+extern int8_t hostTimezone;
+
+#endif /* HOSTAQUADUINO_H_ */
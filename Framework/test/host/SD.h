@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Replacement of the SD library for the host builds of the tests. It behaves
+ * like a slot without a card: no file exists and none can be opened.
+ */
+
+#ifndef __SD_H__
+#define __SD_H__
+
+#include <Arduino.h>
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x13
+
+/**
+ * \brief File that is never open.
+ */
+class File
+{
+public:
+    operator bool()
+    {
+        return false;
+    }
+
+    uint32_t size()
+    {
+        return 0;
+    }
+
+    boolean seek(uint32_t pos)
+    {
+        return false;
+    }
+
+    int read(void* buf, uint16_t nbyte)
+    {
+        return -1;
+    }
+
+    size_t write(const uint8_t* buf, size_t size)
+    {
+        return 0;
+    }
+
+    void close()
+    {
+    }
+};
+
+/**
+ * \brief SD card slot without a card.
+ */
+class SDClass
+{
+public:
+    File open(const char* filename, uint8_t mode = FILE_READ)
+    {
+        return File();
+    }
+
+    boolean exists(char* filepath)
+    {
+        return false;
+    }
+
+    boolean remove(char* filepath)
+    {
+        return false;
+    }
+};
+
+extern SDClass SD;
+
+#endif
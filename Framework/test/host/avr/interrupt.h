@@ -18,28 +18,20 @@
  *
  */
 
-#ifndef SERIALATLASEC_H
-#define SERIALATLASEC_H
-
-#include <Framework/Sensor.h>
-
-/**
- * \brief Class for using Arduino pins as digital input.
+/*
+ * Interrupts do not exist on the host. cli and sei only maintain the I bit
+ * of SREG so that code saving and restoring SREG behaves as on the AVR.
+ * Tests call the handlers directly.
  */
-class SerialAtlasEC: public Sensor
-{
-public:
-    SerialAtlasEC();
-    double read();
 
-    uint16_t serialize(Stream* s);
-    uint16_t deserialize(Stream* s);
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
 
-    int8_t getPin();
-    int8_t setPin(int8_t pin);
+#define cli() (SREG &= ~_BV(SREG_I))
+#define sei() (SREG |= _BV(SREG_I))
 
-private:
-    unsigned char m_Pin;
-};
+#define ISR(vector, ...) extern "C" void vector(void)
 
-#endif
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -18,28 +18,32 @@
  *
  */
 
-#ifndef SERIALATLASPH_H
-#define SERIALATLASPH_H
+/*
+ * Registers used by the code under test. They are plain variables on the
+ * host.
+ */
 
-#include <Framework/Sensor.h>
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
 
-/**
- * \brief Class for using Arduino pins as digital input.
- */
-class SerialAtlasPH: public Sensor
-{
-public:
-    SerialAtlasPH();
-    double read();
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+extern volatile uint8_t SREG;
 
-    uint16_t serialize(Stream* s);
-    uint16_t deserialize(Stream* s);
+extern volatile uint8_t TCCR1A;
+extern volatile uint8_t TCCR1B;
+extern volatile uint16_t TCNT1;
+extern volatile uint16_t OCR1A;
+extern volatile uint8_t TIFR1;
+extern volatile uint8_t TIMSK1;
 
-    int8_t getPin();
-    int8_t setPin(int8_t pin);
+#define CS11 1
+#define WGM12 3
+#define OCF1A 1
+#define OCIE1A 1
 
-private:
-    unsigned char m_Pin;
-};
+#define SREG_I 7
 
-#endif /* SERIALINPUT_H */
+#endif /* HOST_AVR_IO_H_ */
@@ -18,28 +18,34 @@
  *
  */
 
-#ifndef SERIALATLASORP_H
-#define SERIALATLASORP_H
+/*
+ * Program memory is ordinary memory on the host.
+ */
 
-#include <Framework/Sensor.h>
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
 
-/**
- * \brief Class for using Arduino pins as digital input.
- */
-class SerialAtlasORP: public Sensor
-{
-public:
-    SerialAtlasORP();
-    double read();
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
 
-    uint16_t serialize(Stream* s);
-    uint16_t deserialize(Stream* s);
+typedef char prog_char;
+typedef uint8_t prog_uchar;
 
-    int8_t getPin();
-    int8_t setPin(int8_t pin);
+#define pgm_read_byte(address) (*(const uint8_t*) (address))
+#define pgm_read_word(address) (*(const uint16_t*) (address))
+#define pgm_read_dword(address) (*(const uint32_t*) (address))
+#define pgm_read_byte_near(address) pgm_read_byte(address)
+#define pgm_read_word_near(address) pgm_read_word(address)
 
-private:
-    unsigned char m_Pin;
-};
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strlen_P strlen
 
-#endif
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -20,6 +20,7 @@
 
 #include <Arduino.h>
 #include <string.h>
+#include "util.h"
 
 void hts(const uint8_t* bytes, uint8_t byte_size, char* hexString, uint8_t string_size)
 {
@@ -56,3 +57,33 @@ void sth(const char* hexString, uint8_t* bytes, uint8_t byte_size)
         bytes[j] |= (high >= 'A' ? high + 10 - 'A' : high - '0') << 4;
     }
 }
+
+/**
+ * \brief Prints a milli-unit value with three decimals.
+ * \param[in] p Destination of the value.
+ * \param[in] value Value in milli-units.
+ *
+ * \returns Number of characters printed.
+ */
+size_t printMilli(Print& p, int32_t value)
+{
+    uint32_t magnitude = value;
+    uint16_t fraction;
+    size_t len = 0;
+
+    if (value < 0)
+    {
+        len += p.print('-');
+        magnitude = -magnitude;
+    }
+    len += p.print(magnitude / 1000);
+    len += p.print('.');
+    fraction = magnitude % 1000;
+    if (fraction < 100)
+        len += p.print('0');
+    if (fraction < 10)
+        len += p.print('0');
+    len += p.print(fraction);
+
+    return len;
+}
@@ -18,7 +18,10 @@
  *
  */
 
+#include <Print.h>
+
 extern void hts(const uint8_t* bytes, uint8_t byte_size, char* hexString,
                 uint8_t string_size);
 extern void sth(const char* hexString, uint8_t* bytes,
                 uint8_t byte_size);
+extern size_t printMilli(Print& p, int32_t value);
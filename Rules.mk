@@ -73,6 +73,25 @@ upload: Aquaduino.hex
 upload_test: ArrayMap_test.hex
 	avrdude -C$(AVRDUDECONF) -patmega2560 -cwiring -P$(ARDUINOCOM) -b115200 -D -Uflash:w:ArrayMap_test.hex:i 
 
+# Templates compiled into PROGMEM token streams for the HTTPServer
+HTML_TEMPLATES	:= HTML/main.htm HTML/mainarow.htm HTML/mainsrow.htm \
+		   HTML/maincrow.htm HTML/clockrow.htm
+
+Framework/HTMLTemplates.h Framework/HTMLTemplates.cpp: $(HTML_TEMPLATES) build/compile-templates.py
+	python3 build/compile-templates.py Framework/HTMLTemplates $(HTML_TEMPLATES)
+
+Framework/HTMLTemplates.o Framework/HTTPServer.o: Framework/HTMLTemplates.h
+
+# Pages for the HTTPServer. Copy the folder www to the root of the SD card.
+www: HTML/*.htm
+	mkdir -p www/gz
+	for f in HTML/*.htm; do \
+		cp $$f www/; \
+		gzip -9 -n -c $$f > www/gz/`basename $$f`; \
+	done
+
+CLEAN		:= $(CLEAN) www/*.htm www/gz/*.htm
+
 # Standard things
 
 -include	$(DEPS_$(d))
@@ -86,7 +105,7 @@ TGT_BIN	:= $(TGT_BIN)
 .PHONY:		targets
 targets:	$(TGT_BIN) $(TGT_SBIN) $(TGT_ETC) $(TGT_LIB)
 	
-.PHONY:		clean
+.PHONY:		clean www
 clean:
 		rm -f $(CLEAN)
 
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AnalogInput.h"
+#include <Framework/Aquaduino.h>
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+#if ANALOGINPUT_OVERSAMPLE_BITS > 3
+#error ANALOGINPUT_OVERSAMPLE_BITS must not exceed 3
+#endif
+
+/**
+ * \brief Number of conversions decimated to one value.
+ */
+#define ANALOGINPUT_CONVERSIONS (1 << (2 * ANALOGINPUT_OVERSAMPLE_BITS))
+
+AnalogInput* AnalogInput::m_Inputs[ANALOGINPUT_MAX_INPUTS];
+volatile int8_t AnalogInput::m_Current = -1;
+
+/**
+ * \brief Constructor
+ */
+AnalogInput::AnalogInput()
+{
+    m_Type = SENSOR_ANALOGINPUT;
+    m_Channel = 0;
+    m_Slot = -1;
+    m_Coefficients[0] = 0;
+    m_Coefficients[1] = 5.0 / (1024UL << ANALOGINPUT_OVERSAMPLE_BITS);
+    m_Coefficients[2] = 0;
+    m_Raw = 0;
+    m_Accumulator = 0;
+    m_Conversions = 0;
+    m_Head = 0;
+    m_Tail = 0;
+}
+
+/**
+ * \brief Destructor
+ *
+ * Removes the input from the conversion cycle.
+ */
+AnalogInput::~AnalogInput()
+{
+    detach();
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId ADC channel (0..15) or analog pin (A0..A15).
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object.
+ */
+Object* AnalogInput::create(void* memory, const char* name, uint8_t portId,
+                            uint8_t option)
+{
+    AnalogInput* input = new (memory) AnalogInput();
+    input->setName(name);
+    input->setChannel(portId);
+    return input;
+}
+
+/**
+ * \brief Reads the calibrated value
+ *
+ * \returns The value in the unit of the calibration.
+ */
+double AnalogInput::read()
+{
+    return readMilli() / 1000.0;
+}
+
+/**
+ * \brief Reads the calibrated value in milli-units
+ *
+ * All values decimated since the last call are calibrated and passed through
+ * the sensor filter.
+ *
+ * \returns The filtered value in milli-units.
+ */
+int32_t AnalogInput::readMilli()
+{
+    uint16_t raw;
+    uint8_t oldSREG;
+
+    for (;;)
+    {
+        oldSREG = SREG;
+        cli();
+        if (m_Tail == m_Head)
+        {
+            SREG = oldSREG;
+            break;
+        }
+        raw = m_Samples[m_Tail];
+        m_Tail = (m_Tail + 1) % ANALOGINPUT_BUFFER;
+        SREG = oldSREG;
+
+        m_Raw = raw;
+        m_Filter.add(calibrate(raw));
+    }
+
+    return m_Filter.getValue();
+}
+
+/**
+ * \brief Getter for the unit of the value.
+ *
+ * \returns Volt, which holds for the default calibration only.
+ */
+const __FlashStringHelper* AnalogInput::getUnit()
+{
+    return F("V");
+}
+
+/**
+ * \brief Applies the calibration polynomial.
+ * \param[in] raw Decimated ADC value.
+ *
+ * \returns The calibrated value in milli-units.
+ */
+int32_t AnalogInput::calibrate(uint16_t raw)
+{
+    float value = 0;
+    int8_t i;
+
+    for (i = ANALOGINPUT_COEFFICIENTS - 1; i >= 0; i--)
+        value = value * raw + m_Coefficients[i];
+    value *= 1000;
+
+    return value < 0 ? value - 0.5 : value + 0.5;
+}
+
+/**
+ * \brief Serializes channel and calibration.
+ */
+uint16_t AnalogInput::serialize(Stream* s)
+{
+    s->write(m_Channel);
+    s->write((uint8_t*) m_Coefficients, sizeof(m_Coefficients));
+    return sizeof(m_Channel) + sizeof(m_Coefficients);
+}
+
+/**
+ * \brief Deserializes channel and calibration.
+ */
+uint16_t AnalogInput::deserialize(Stream* s)
+{
+    float coefficients[ANALOGINPUT_COEFFICIENTS];
+
+    setChannel(s->read());
+    if (s->readBytes((char*) coefficients, sizeof(coefficients))
+        != sizeof(coefficients))
+        return sizeof(m_Channel);
+    setCalibration(coefficients);
+    return sizeof(m_Channel) + sizeof(m_Coefficients);
+}
+
+/**
+ * \brief Sets the ADC channel and registers the input for conversion.
+ * \param[in] channel ADC channel (0..15) or analog pin (A0..A15).
+ *
+ * The conversions are started when this is the first registered input.
+ *
+ * \returns 0 on success. -1 if the channel is invalid or
+ * #ANALOGINPUT_MAX_INPUTS inputs are registered already.
+ */
+int8_t AnalogInput::setChannel(uint8_t channel)
+{
+    uint8_t oldSREG;
+    int8_t slot;
+
+    if (channel >= A0)
+        channel -= A0;
+    if (channel > 15)
+        return -1;
+
+    detach();
+    m_Channel = channel;
+    for (slot = 0; slot < ANALOGINPUT_MAX_INPUTS; slot++)
+        if (m_Inputs[slot] == NULL)
+            break;
+    if (slot == ANALOGINPUT_MAX_INPUTS)
+        return -1;
+
+    oldSREG = SREG;
+    cli();
+    m_Accumulator = 0;
+    m_Conversions = 0;
+    m_Head = 0;
+    m_Tail = 0;
+    m_Slot = slot;
+    m_Inputs[slot] = this;
+    if (m_Current < 0)
+    {
+        m_Current = slot;
+        startConversion(m_Channel);
+    }
+    SREG = oldSREG;
+
+    return 0;
+}
+
+/**
+ * \brief Removes the input from the conversion cycle.
+ *
+ * The ISR skips the slot and stops the ADC when no input is left.
+ */
+void AnalogInput::detach()
+{
+    uint8_t oldSREG;
+
+    if (m_Slot < 0)
+        return;
+
+    oldSREG = SREG;
+    cli();
+    m_Inputs[m_Slot] = NULL;
+    m_Slot = -1;
+    SREG = oldSREG;
+}
+
+uint8_t AnalogInput::getChannel()
+{
+    return m_Channel;
+}
+
+/**
+ * \brief Sets the calibration polynomial.
+ * \param[in] coefficients #ANALOGINPUT_COEFFICIENTS coefficients starting
+ *                         with the constant one. The polynomial maps the
+ *                         decimated ADC value to the unit of the sensor.
+ */
+void AnalogInput::setCalibration(const float* coefficients)
+{
+    int8_t i;
+
+    for (i = 0; i < ANALOGINPUT_COEFFICIENTS; i++)
+        m_Coefficients[i] = coefficients[i];
+}
+
+/**
+ * \brief Getter for the calibration polynomial.
+ * \param[out] coefficients Buffer of #ANALOGINPUT_COEFFICIENTS coefficients.
+ */
+void AnalogInput::getCalibration(float* coefficients)
+{
+    int8_t i;
+
+    for (i = 0; i < ANALOGINPUT_COEFFICIENTS; i++)
+        coefficients[i] = m_Coefficients[i];
+}
+
+/**
+ * \brief Getter for the last decimated ADC value.
+ *
+ * Useful to determine the calibration.
+ *
+ * \returns Value with 10 + #ANALOGINPUT_OVERSAMPLE_BITS bits.
+ */
+uint16_t AnalogInput::getRaw()
+{
+    return m_Raw;
+}
+
+/**
+ * \brief Starts a single conversion with interrupt on completion.
+ * \param[in] channel ADC channel (0..15).
+ *
+ * AVCC is used as reference. The prescaler of 128 gives the 125 kHz ADC
+ * clock needed for full resolution.
+ */
+void AnalogInput::startConversion(uint8_t channel)
+{
+    if (channel & 0x08)
+        ADCSRB |= _BV(MUX5);
+    else
+        ADCSRB &= ~_BV(MUX5);
+    ADMUX = _BV(REFS0) | (channel & 0x07);
+    ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1)
+             | _BV(ADPS0);
+}
+
+/**
+ * \brief Handles the conversion complete interrupt.
+ *
+ * Accumulates the result for the current input. Once a value is decimated
+ * it is put into the ring buffer, dropping the oldest value when the buffer
+ * is full, and the next input is converted. The ADC stops when no input is
+ * registered anymore.
+ */
+void AnalogInput::handleInterrupt()
+{
+    uint16_t value = ADC;
+    AnalogInput* input = NULL;
+    uint8_t next, i;
+
+    if (m_Current >= 0)
+        input = m_Inputs[m_Current];
+
+    if (input != NULL)
+    {
+        input->m_Accumulator += value;
+        if (++input->m_Conversions < ANALOGINPUT_CONVERSIONS)
+        {
+            ADCSRA |= _BV(ADSC);
+            return;
+        }
+
+        input->m_Samples[input->m_Head] = input->m_Accumulator
+                                          >> ANALOGINPUT_OVERSAMPLE_BITS;
+        next = (input->m_Head + 1) % ANALOGINPUT_BUFFER;
+        if (next == input->m_Tail)
+            input->m_Tail = (input->m_Tail + 1) % ANALOGINPUT_BUFFER;
+        input->m_Head = next;
+        input->m_Accumulator = 0;
+        input->m_Conversions = 0;
+    }
+
+    for (i = 1; i <= ANALOGINPUT_MAX_INPUTS; i++)
+    {
+        next = (m_Current + i) % ANALOGINPUT_MAX_INPUTS;
+        if (m_Inputs[next] != NULL)
+        {
+            m_Current = next;
+            startConversion(m_Inputs[next]->m_Channel);
+            return;
+        }
+    }
+
+    m_Current = -1;
+    ADCSRA &= ~_BV(ADIE);
+}
+
+#ifdef USE_SENSOR_ANALOGINPUT
+ISR(ADC_vect)
+{
+    AnalogInput::handleInterrupt();
+}
+#endif
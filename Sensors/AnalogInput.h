@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANALOGINPUT_H_
+#define ANALOGINPUT_H_
+
+#include <Framework/Sensor.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Number of coefficients of the calibration polynomial.
+ */
+#define ANALOGINPUT_COEFFICIENTS 3
+
+/**
+ * \brief Sensor for analog probes attached to the ADC.
+ *
+ * The ADC is driven by its conversion complete interrupt. Each ISR run stores
+ * the result and starts the next conversion, so no loop time is spent in
+ * blocking analogRead calls. The registered inputs are converted round robin.
+ * Each input accumulates 4^#ANALOGINPUT_OVERSAMPLE_BITS conversions which are
+ * decimated to a value with #ANALOGINPUT_OVERSAMPLE_BITS additional bits of
+ * resolution and put into a ring buffer of #ANALOGINPUT_BUFFER entries.
+ *
+ * read drains the ring buffer. Each decimated value x is calibrated by the
+ * polynomial c0 + c1 * x + c2 * x^2 and passed through the sensor filter.
+ * The default calibration returns the voltage at AVCC = 5 V reference.
+ */
+class AnalogInput: public Sensor
+{
+public:
+    AnalogInput();
+    virtual ~AnalogInput();
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
+    double read();
+    int32_t readMilli();
+    const __FlashStringHelper* getUnit();
+
+    uint16_t serialize(Stream* s);
+    uint16_t deserialize(Stream* s);
+
+    int8_t setChannel(uint8_t channel);
+    uint8_t getChannel();
+
+    void setCalibration(const float* coefficients);
+    void getCalibration(float* coefficients);
+
+    uint16_t getRaw();
+
+    static void handleInterrupt();
+
+private:
+    static void startConversion(uint8_t channel);
+    void detach();
+    int32_t calibrate(uint16_t raw);
+
+    uint8_t m_Channel;
+    int8_t m_Slot;
+    float m_Coefficients[ANALOGINPUT_COEFFICIENTS];
+    uint16_t m_Raw;
+    volatile uint32_t m_Accumulator;
+    volatile uint8_t m_Conversions;
+    volatile uint8_t m_Head;
+    volatile uint8_t m_Tail;
+    volatile uint16_t m_Samples[ANALOGINPUT_BUFFER];
+
+    static AnalogInput* m_Inputs[ANALOGINPUT_MAX_INPUTS];
+    static volatile int8_t m_Current;
+};
+
+#endif /* ANALOGINPUT_H_ */
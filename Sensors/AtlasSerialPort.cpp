@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AtlasSerialPort.h"
+#include "SerialAtlasSensor.h"
+
+#if defined(USE_SENSOR_SERIALATLASPH) || defined(USE_SENSOR_SERIALATLASEC) \
+    || defined(USE_SENSOR_SERIALATLASORP)
+
+static AtlasSerialPort atlasPort1(&Serial1, 1);
+static AtlasSerialPort atlasPort2(&Serial2, 2);
+static AtlasSerialPort atlasPort3(&Serial3, 3);
+
+void serialEvent1()
+{
+    atlasPort1.run();
+}
+
+void serialEvent2()
+{
+    atlasPort2.run();
+}
+
+void serialEvent3()
+{
+    atlasPort3.run();
+}
+
+/**
+ * \brief Constructor
+ * \param[in] serial UART the circuits are attached to
+ * \param[in] uart Number of the UART
+ */
+AtlasSerialPort::AtlasSerialPort(HardwareSerial* serial, uint8_t uart) :
+        m_Serial(serial), m_Parser(serial), m_Uart(uart), m_Head(0),
+        m_Count(0), m_Sent(0), m_Begun(0), m_SentTime(0)
+{
+    memset(m_Queue, 0, sizeof(m_Queue));
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+AtlasSerialPort::AtlasSerialPort(const AtlasSerialPort&) :
+        m_Parser(NULL)
+{
+}
+
+/**
+ * \brief Copy constructor
+ *
+ * Private & Empty.
+ */
+AtlasSerialPort::AtlasSerialPort(AtlasSerialPort&) :
+        m_Parser(NULL)
+{
+}
+
+/**
+ * \brief Returns the port of a UART
+ * \param[in] uart Number of the UART (1 - 3)
+ *
+ * The UART is initialized on first use.
+ *
+ * \returns The port. NULL if there is no such UART.
+ */
+AtlasSerialPort* AtlasSerialPort::getPort(uint8_t uart)
+{
+    AtlasSerialPort* port;
+
+    switch (uart)
+    {
+    case 1:
+        port = &atlasPort1;
+        break;
+    case 2:
+        port = &atlasPort2;
+        break;
+    case 3:
+        port = &atlasPort3;
+        break;
+    default:
+        return NULL;
+    }
+
+    if (!port->m_Begun)
+        port->begin();
+    return port;
+}
+
+/**
+ * \brief Removes the commands of a sensor from the queues of all UARTs
+ * \param[in] sensor Sensor that is destroyed
+ *
+ * The sensor may have been moved to another UART by setPort while commands
+ * were still queued, so every queue is searched.
+ */
+void AtlasSerialPort::detach(SerialAtlasSensor* sensor)
+{
+    atlasPort1.remove(sensor);
+    atlasPort2.remove(sensor);
+    atlasPort3.remove(sensor);
+}
+
+/**
+ * \brief Initializes the UART and the select pins of the port expander
+ */
+void AtlasSerialPort::begin()
+{
+    m_Serial->begin(38400);
+    if (m_Uart == ATLAS_EXPANDER_UART)
+    {
+        pinMode(ATLAS_EXPANDER_S1, OUTPUT);
+        pinMode(ATLAS_EXPANDER_S2, OUTPUT);
+        pinMode(ATLAS_EXPANDER_S3, OUTPUT);
+    }
+    m_Begun = 1;
+}
+
+/**
+ * \brief Queues a command
+ * \param[in] sensor Sensor the response is delivered to
+ * \param[in] channel Channel of the port expander. 0 without expander.
+ * \param[in] command Command including the carriage return
+ *
+ * \returns 0 when the command was queued. -1 when the queue is full or the
+ * command too long.
+ */
+int8_t AtlasSerialPort::enqueue(SerialAtlasSensor* sensor, uint8_t channel,
+                                const char* command)
+{
+    AtlasCommand* entry;
+
+    if (m_Count == ATLAS_QUEUE_LENGTH
+        || strlen(command) >= sizeof(entry->command))
+        return -1;
+
+    entry = &m_Queue[(m_Head + m_Count) % ATLAS_QUEUE_LENGTH];
+    entry->sensor = sensor;
+    entry->channel = channel;
+    strcpy(entry->command, command);
+    m_Count++;
+
+    run();
+    return 0;
+}
+
+/**
+ * \brief Processes responses, timeouts and sends the next command
+ *
+ * Called whenever data arrived at the UART and by the sensors on every read.
+ */
+void AtlasSerialPort::run()
+{
+    AtlasCommand* current = &m_Queue[m_Head];
+
+    if (m_Sent)
+    {
+        if (m_Parser.poll())
+        {
+            if (current->sensor != NULL)
+                current->sensor->handleResponse(m_Parser.getLine());
+            next();
+        }
+        else if (millis() - m_SentTime > ATLAS_RESPONSE_TIMEOUT)
+        {
+            if (current->sensor != NULL)
+                current->sensor->handleTimeout();
+            next();
+        }
+    }
+    else
+    {
+        // Drop anything received without being asked for
+        while (m_Parser.poll())
+            ;
+    }
+
+    if (!m_Sent && m_Count)
+    {
+        current = &m_Queue[m_Head];
+        select(current->channel);
+        m_Parser.reset();
+        m_Serial->print(current->command);
+        m_SentTime = millis();
+        m_Sent = 1;
+    }
+}
+
+/**
+ * \brief Removes the current command from the queue
+ */
+void AtlasSerialPort::next()
+{
+    m_Head = (m_Head + 1) % ATLAS_QUEUE_LENGTH;
+    m_Count--;
+    m_Sent = 0;
+}
+
+/**
+ * \brief Removes the commands of a sensor from the queue
+ * \param[in] sensor Sensor that is destroyed
+ *
+ * A command that was already sent stays at the head of the queue until it
+ * was answered or timed out. Its response is dropped.
+ */
+void AtlasSerialPort::remove(SerialAtlasSensor* sensor)
+{
+    AtlasCommand* entry;
+    uint8_t kept = 0;
+    uint8_t i;
+
+    for (i = 0; i < m_Count; i++)
+    {
+        entry = &m_Queue[(m_Head + i) % ATLAS_QUEUE_LENGTH];
+        if (entry->sensor == sensor)
+        {
+            if (i > 0 || !m_Sent)
+                continue;
+            entry->sensor = NULL;
+        }
+        if (kept != i)
+            m_Queue[(m_Head + kept) % ATLAS_QUEUE_LENGTH] = *entry;
+        kept++;
+    }
+    m_Count = kept;
+}
+
+/**
+ * \brief Selects a channel of the port expander
+ * \param[in] channel Channel 1 - 8. 0 leaves the expander untouched.
+ */
+void AtlasSerialPort::select(uint8_t channel)
+{
+    if (m_Uart != ATLAS_EXPANDER_UART || channel == 0)
+        return;
+
+    channel--;
+    digitalWrite(ATLAS_EXPANDER_S1, channel & 0x01 ? HIGH : LOW);
+    digitalWrite(ATLAS_EXPANDER_S2, channel & 0x02 ? HIGH : LOW);
+    digitalWrite(ATLAS_EXPANDER_S3, channel & 0x04 ? HIGH : LOW);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ATLASSERIALPORT_H_
+#define ATLASSERIALPORT_H_
+
+#include <Arduino.h>
+#include <Framework/FrameworkConfig.h>
+#include <Framework/SerialLineParser.h>
+
+class SerialAtlasSensor;
+
+/**
+ * \brief Command queued for an Atlas Scientific circuit
+ */
+struct AtlasCommand
+{
+    /**
+     * \brief Sensor the response is delivered to. NULL when the sensor was
+     * destroyed after the command was sent.
+     */
+    SerialAtlasSensor* sensor;
+
+    /**
+     * \brief Channel of the port expander. 0 without expander.
+     */
+    uint8_t channel;
+
+    /**
+     * \brief Command including the carriage return
+     */
+    char command[ATLAS_COMMAND_LENGTH];
+};
+
+/**
+ * \brief UART shared by Atlas Scientific circuits
+ *
+ * Each UART has a queue of #ATLAS_QUEUE_LENGTH commands. The commands are
+ * sent one at a time. The next one is sent when the response line of the
+ * current one was received or #ATLAS_RESPONSE_TIMEOUT milliseconds passed.
+ * Thus several circuits can share a UART through a serial port expander and
+ * the latency of a reading is bounded.
+ *
+ * There is one instance per UART returned by AtlasSerialPort::getPort.
+ */
+class AtlasSerialPort
+{
+public:
+    AtlasSerialPort(HardwareSerial* serial, uint8_t uart);
+
+    int8_t enqueue(SerialAtlasSensor* sensor, uint8_t channel,
+                   const char* command);
+    void run();
+
+    static AtlasSerialPort* getPort(uint8_t uart);
+    static void detach(SerialAtlasSensor* sensor);
+
+private:
+    AtlasSerialPort(const AtlasSerialPort&);
+    AtlasSerialPort(AtlasSerialPort&);
+
+    void begin();
+    void select(uint8_t channel);
+    void next();
+    void remove(SerialAtlasSensor* sensor);
+
+    HardwareSerial* m_Serial;
+    SerialLineParser m_Parser;
+    AtlasCommand m_Queue[ATLAS_QUEUE_LENGTH];
+    uint8_t m_Uart;
+    uint8_t m_Head;
+    uint8_t m_Count;
+    uint8_t m_Sent;
+    uint8_t m_Begun;
+    unsigned long m_SentTime;
+};
+
+#endif /* ATLASSERIALPORT_H_ */
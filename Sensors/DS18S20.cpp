@@ -31,61 +31,122 @@
  */
 DS18S20::DS18S20()
 {
-    int i;
     m_Type = SENSOR_DS18S20;
-    for (i = 0; i < TEMP_HISTORY; i++)
+    m_Filter.configure(FILTER_AVERAGE, SENSOR_FILTER_WINDOW);
+    m_Pin = 0;
+    m_Idx = MAX_ONEWIRE_DEVICES;
+    m_Conversion = 0;
+    m_Resolution = 12;
+}
+
+/**
+ * \brief Destructor
+ *
+ * Releases the bus registered at the OneWireHandler.
+ */
+DS18S20::~DS18S20()
+{
+    OneWireHandler* handler = __aquaduino->getOneWireHandler();
+
+    if (handler != NULL)
     {
-        temp_hist[i] = 0.0;
+        handler->removeResolution(m_Idx, m_Address);
+        handler->removePin(m_Idx);
     }
-    m_Pin = 0;
-    m_Idx = 0;
-    m_ReadPending = 0;
-    m_LastReadIssue = 0;
 }
 
 /**
- * \brief Reads the sensor
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId Pin the sensor is attached to.
+ * \param[in] option Unused.
  *
- * Currently only supports one DS18S20.
- * Reading is done on two phases to remove delay calls.
- * First phase (readPending = 0) searches for attached DS18S20 and issues a
- * conversion.
+ * \returns The constructed object.
+ */
+Object* DS18S20::create(void* memory, const char* name, uint8_t portId,
+                        uint8_t option)
+{
+    DS18S20* sensor = new (memory) DS18S20();
+    OneWireHandler* handler = __aquaduino->getOneWireHandler();
+
+    sensor->setName(name);
+    sensor->setPin(portId);
+    if (handler != NULL)
+        sensor->m_Idx = handler->addPin(portId);
+    return sensor;
+}
+
+/**
+ * \brief Reads the sensor
  *
- * Second phase (readPending = 1) reads the value when more than one second
- * has passed since the read was issued.
+ * \returns The temperature in degree Celsius.
  */
 double DS18S20::read()
+{
+    return readMilli() / 1000.0;
+}
+
+/**
+ * \brief Reads the sensor in milli degree Celsius
+ *
+ * The conversion is not triggered by the sensor itself. The OneWireHandler
+ * broadcasts one conversion command to all devices of the bus. Once the
+ * conversion counter of the bus changed the scratchpad of this sensor is read.
+ * Otherwise the last value is returned. Reads with an invalid CRC are dropped.
+ * While an asynchronous read is pending the last value is returned as well.
+ *
+ * The raw value has a resolution of 1/16 degree and is converted to milli
+ * degree without floating point math. Each new value is passed through the
+ * filter of the sensor.
+ */
+int32_t DS18S20::readMilli()
 {
     uint8_t data[12];
-    int8_t i = 0;
+    int8_t result;
+    uint8_t conversion;
     OneWireHandler* handler = __aquaduino->getOneWireHandler();
 
-    if (!m_ReadPending)
-    {
-        handler->issueReadCommand(m_Idx, m_Address);
-        m_LastReadIssue = millis();
-        m_ReadPending = 1;
-    }
-    else if (millis() - m_LastReadIssue > 750)
-    {
-        if (handler->read(m_Idx, m_Address, data, 12))
-            return 0.0;
-        temp_hist[m_Runs++] = ((double) convertToRaw(data,
-                                                   12,
-                                                   m_Address[0] == 0x10))
-                            / 16;
-
-
-        m_Celsius = 0;
-        for (i = 0; i < TEMP_HISTORY; i++)
-            m_Celsius += temp_hist[i];
-        m_Celsius /= TEMP_HISTORY;
-        if (m_Runs == TEMP_HISTORY)
-            m_Runs = 0;
-        m_ReadPending = 0;
-    }
+    conversion = handler->getConversion(m_Idx);
+    if (conversion == m_Conversion)
+        return m_Filter.getValue();
 
-    return m_Celsius;
+    result = handler->read(m_Idx, m_Address, data, 12);
+    if (result > 0)
+        return m_Filter.getValue();
+    m_Conversion = conversion;
+    if (result < 0)
+        return m_Filter.getValue();
+
+    return m_Filter.add((int32_t) (int16_t) convertToRaw(data,
+                                                        12,
+                                                        m_Address[0] == 0x10)
+                        * 125 / 2);
+}
+
+/**
+ * \brief Getter for the resolution of the temperature value.
+ *
+ * \returns Number of significant fractional digits for the configured
+ * resolution.
+ */
+uint8_t DS18S20::getDecimals()
+{
+    if (m_Resolution <= 9)
+        return 1;
+    if (m_Resolution == 10)
+        return 2;
+    return 3;
+}
+
+/**
+ * \brief Getter for the unit of the temperature.
+ *
+ * \returns Degree Celsius.
+ */
+const __FlashStringHelper* DS18S20::getUnit()
+{
+    return F("\xC2\xB0" "C");
 }
 
 /**
@@ -124,18 +185,39 @@ uint16_t DS18S20::serialize(Stream* s)
 {
 	s->write(m_Pin);
 	s->write(m_Address, sizeof(m_Address));
-    return sizeof(m_Pin) + sizeof(m_Address);
+	s->write(m_Resolution);
+    return sizeof(m_Pin) + sizeof(m_Address) + sizeof(m_Resolution);
 }
 
+/**
+ * \brief Deserializes the sensor configuration
+ *
+ * Configurations written before the resolution was stored end after the
+ * address. Those sensors keep the default resolution of 12 bits. The
+ * resolution is written to the device afterwards.
+ */
 uint16_t DS18S20::deserialize(Stream* s)
 {
     OneWireHandler* handler = __aquaduino->getOneWireHandler();
+    int resolution;
+
+    if (handler != NULL)
+    {
+        handler->removeResolution(m_Idx, m_Address);
+        handler->removePin(m_Idx);
+    }
 
     m_Pin = s->read();
 	s->readBytes((char*)m_Address, sizeof(m_Address));
+    resolution = s->read();
+    if (resolution >= 9 && resolution <= 12)
+        m_Resolution = resolution;
     if (handler != NULL)
+    {
         m_Idx = handler->addPin(m_Pin);
-    return sizeof(m_Pin) + sizeof(m_Address);
+        handler->setResolution(m_Idx, m_Address, m_Resolution);
+    }
+    return sizeof(m_Pin) + sizeof(m_Address) + sizeof(m_Resolution);
 }
 
 void DS18S20::setPin(uint8_t pin)
@@ -151,8 +233,11 @@ uint8_t DS18S20::getPin()
 void DS18S20::setAddress(uint8_t* addr)
 {
     uint8_t i = 0;
+    __aquaduino->getOneWireHandler()->removeResolution(m_Idx, m_Address);
     for (; i < sizeof(m_Address); i++)
         m_Address[i] = addr[i];
+    __aquaduino->getOneWireHandler()->setResolution(m_Idx, m_Address,
+                                                    m_Resolution);
 }
 
 void DS18S20::getAddress(uint8_t* addr)
@@ -161,3 +246,33 @@ void DS18S20::getAddress(uint8_t* addr)
     for (; i < sizeof(m_Address); i++)
         addr[i] = m_Address[i];
 }
+
+/**
+ * \brief Sets the resolution of the sensor
+ * \param[in] resolution Resolution in bits. Valid values are 9 to 12.
+ *
+ * Lower resolutions shorten the conversion time from 750 ms at 12 bits down
+ * to 93.75 ms at 9 bits. The DS18S20 itself always converts at 9 bits and
+ * extends the result using the count remain register.
+ *
+ * \returns 0 when the resolution was written to the device. -1 otherwise.
+ */
+int8_t DS18S20::setResolution(uint8_t resolution)
+{
+    if (resolution < 9 || resolution > 12)
+        return -1;
+    m_Resolution = resolution;
+    return __aquaduino->getOneWireHandler()->setResolution(m_Idx,
+                                                           m_Address,
+                                                           m_Resolution);
+}
+
+/**
+ * \brief Getter for the configured resolution
+ *
+ * \returns Resolution in bits.
+ */
+uint8_t DS18S20::getResolution()
+{
+    return m_Resolution;
+}
@@ -28,16 +28,23 @@
 /**
  * \brief Basic implementation for DS18S20 Temperature Sensors
  *
- * Allows for reading a single DS18S20. The temperature is calculated as
- * arithmetic mean of a history of #TEMP_HISTORY values. The returned value
- * thus adjusts slowly temperature differences. This prevents controllers
- * from enabling or disabling actuators when there is a single faulty read.
+ * Allows for reading a single DS18S20. By default the temperature is
+ * calculated by the sensor filter as moving average of the last
+ * #SENSOR_FILTER_WINDOW values. The returned value thus adjusts slowly to
+ * temperature differences. This prevents controllers from enabling or
+ * disabling actuators when there is a single faulty read.
  */
 class DS18S20: public Sensor
 {
 public:
     DS18S20();
+    virtual ~DS18S20();
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
     double read();
+    int32_t readMilli();
+    uint8_t getDecimals();
+    const __FlashStringHelper* getUnit();
 
     uint16_t serialize(Stream* s);
     uint16_t deserialize(Stream* s);
@@ -48,17 +55,16 @@ public:
     void setAddress(uint8_t* addr);
     void getAddress(uint8_t* addr);
 
+    int8_t setResolution(uint8_t resolution);
+    uint8_t getResolution();
+
 private:
     uint16_t convertToRaw(uint8_t* data, uint8_t size, int8_t type);
     uint8_t m_Pin;
     uint8_t m_Idx;
-    double m_Celsius;
-    double m_Fahrenheit;
-    float temp_hist[TEMP_HISTORY];
     uint8_t m_Address[8];
-    unsigned long m_LastReadIssue;
-    uint8_t m_ReadPending;
-    uint8_t m_Runs;
+    uint8_t m_Resolution;
+    uint8_t m_Conversion;
 };
 
 #endif /* DS18S20_H_ */
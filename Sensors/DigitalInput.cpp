@@ -22,6 +22,10 @@
 #include "DigitalInput.h"
 #include <Arduino.h>
 #include <SD.h>
+#include <avr/interrupt.h>
+
+DigitalInput* DigitalInput::m_Slots[16];
+uint8_t DigitalInput::m_BankState[2];
 
 /**
  * \brief Constructor
@@ -30,6 +34,41 @@ DigitalInput::DigitalInput()
 {
     m_Type = SENSOR_DIGITALINPUT;
     m_Pin = 0;
+    m_Interrupt = 0;
+    m_Debounce = 0;
+    m_Level = LOW;
+    m_Next = 0;
+    m_Edges = 0;
+    m_Pulses = 0;
+    m_LastEdge = 0;
+}
+
+/**
+ * \brief Destructor
+ *
+ * Releases the pin change interrupt slot.
+ */
+DigitalInput::~DigitalInput()
+{
+    disableInterrupt();
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId Pin the sensor is attached to.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object.
+ */
+Object* DigitalInput::create(void* memory, const char* name, uint8_t portId,
+                             uint8_t option)
+{
+    DigitalInput* input = new (memory) DigitalInput();
+    input->setName(name);
+    input->setPin(portId);
+    return input;
 }
 
 /**
@@ -39,28 +78,346 @@ DigitalInput::DigitalInput()
  */
 double DigitalInput::read()
 {
-    return digitalRead(m_Pin);
+    return readMilli() / 1000.0;
 }
 
+/**
+ * \brief Reads the digital input in milli-units
+ *
+ * Every call takes a new sample which is passed through the filter of the
+ * sensor. A median filter thus suppresses short glitches of the input.
+ *
+ * In interrupt driven mode the debounced level is sampled. An edge ignored
+ * during the debounce time leaves the pin at another level than recorded.
+ * This is caught up here once the debounce time passed.
+ *
+ * \returns 1000 if input is HIGH or 0 if input is LOW.
+ */
+int32_t DigitalInput::readMilli()
+{
+    uint8_t level = digitalRead(m_Pin);
+    uint8_t oldSREG;
+
+    if (m_Interrupt)
+    {
+        oldSREG = SREG;
+        cli();
+        if (level != m_Level && millis() - m_LastEdge >= m_Debounce)
+            handleEdge(level, millis());
+        level = m_Level;
+        SREG = oldSREG;
+    }
+
+    return m_Filter.add(level == HIGH ? 1000 : 0);
+}
+
+/**
+ * \brief Getter for the resolution of the value.
+ *
+ * \returns 0 as the value is either 0 or 1.
+ */
+uint8_t DigitalInput::getDecimals()
+{
+    return 0;
+}
+
+/**
+ * \brief Serializes pin, interrupt mode and debounce time.
+ */
 uint16_t DigitalInput::serialize(Stream* s)
 {
 	s->write(m_Pin);
-	return 1;
+	s->write(m_Interrupt);
+	s->write(m_Debounce);
+	return 3;
 }
 
+/**
+ * \brief Deserializes pin, interrupt mode and debounce time.
+ *
+ * Configurations written before the interrupt mode was stored only contain
+ * the pin. Those inputs are sampled.
+ */
 uint16_t DigitalInput::deserialize(Stream* s)
 {
-	m_Pin = s->read();
-	return 1;
+    int interrupt, debounce;
+
+    setPin(s->read());
+    interrupt = s->read();
+    debounce = s->read();
+    if (interrupt < 0 || debounce < 0)
+        return 1;
+    if (interrupt == 1)
+        enableInterrupt(debounce);
+    else
+        disableInterrupt();
+    return 3;
 }
 
-void  DigitalInput::setPin(uint8_t pin)
+/**
+ * \brief Sets the pin of the input.
+ * \param[in] pin Arduino pin number.
+ *
+ * The interrupt driven mode is kept when the new pin supports it.
+ */
+void DigitalInput::setPin(uint8_t pin)
 {
+    uint8_t interrupt = m_Interrupt;
+
+    disableInterrupt();
 	m_Pin = pin;
 	pinMode(m_Pin, INPUT);
+	if (interrupt)
+	    enableInterrupt(m_Debounce);
 }
 
 uint8_t DigitalInput::getPin()
 {
     return m_Pin;
 }
+
+/**
+ * \brief Maps a pin to its slot in m_Slots.
+ * \param[in] pin Arduino pin number.
+ *
+ * Slots 0..7 belong to PCINT0..7 (port B), slots 8..15 to PCINT16..23
+ * (port K).
+ *
+ * \returns The slot or -1 when the pin has no pin change interrupt.
+ */
+int8_t DigitalInput::getSlot(uint8_t pin)
+{
+    if (digitalPinToPCICR(pin) == (uint8_t*) 0)
+        return -1;
+    return (digitalPinToPCICRbit(pin) ? 8 : 0) + digitalPinToPCMSKbit(pin);
+}
+
+/**
+ * \brief Switches to interrupt driven mode.
+ * \param[in] debounce Time in milliseconds after an edge during which
+ *                     further edges are ignored.
+ *
+ * Edge and pulse counters as well as the edge history are cleared.
+ *
+ * \returns 0 on success. -1 if the pin has no pin change interrupt.
+ */
+int8_t DigitalInput::enableInterrupt(uint8_t debounce)
+{
+    int8_t slot = getSlot(m_Pin);
+    uint8_t oldSREG;
+
+    if (slot < 0)
+        return -1;
+
+    disableInterrupt();
+
+    oldSREG = SREG;
+    cli();
+    m_Debounce = debounce;
+    m_Level = digitalRead(m_Pin);
+    m_Next = 0;
+    m_Edges = 0;
+    m_Pulses = 0;
+    m_LastEdge = millis();
+    m_Slots[slot] = this;
+    m_BankState[slot >> 3] = *portInputRegister(digitalPinToPort(m_Pin));
+    *digitalPinToPCMSK(m_Pin) |= _BV(digitalPinToPCMSKbit(m_Pin));
+    PCICR |= _BV(digitalPinToPCICRbit(m_Pin));
+    m_Interrupt = 1;
+    SREG = oldSREG;
+
+    return 0;
+}
+
+/**
+ * \brief Switches back to sampling the pin on every read.
+ */
+void DigitalInput::disableInterrupt()
+{
+    int8_t slot = getSlot(m_Pin);
+    uint8_t oldSREG;
+
+    if (!m_Interrupt || slot < 0)
+        return;
+
+    oldSREG = SREG;
+    cli();
+    m_Slots[slot] = NULL;
+    *digitalPinToPCMSK(m_Pin) &= ~_BV(digitalPinToPCMSKbit(m_Pin));
+    if (*digitalPinToPCMSK(m_Pin) == 0)
+        PCICR &= ~_BV(digitalPinToPCICRbit(m_Pin));
+    m_Interrupt = 0;
+    SREG = oldSREG;
+}
+
+/**
+ * \brief Getter for the mode of the input.
+ *
+ * \returns 1 if the input is interrupt driven. 0 if it is sampled.
+ */
+uint8_t DigitalInput::isInterruptDriven()
+{
+    return m_Interrupt;
+}
+
+/**
+ * \brief Getter for the debounce time.
+ *
+ * \returns The debounce time in milliseconds.
+ */
+uint8_t DigitalInput::getDebounce()
+{
+    return m_Debounce;
+}
+
+/**
+ * \brief Getter for the number of edges.
+ *
+ * \returns Number of edges accepted since the interrupt was enabled.
+ */
+uint32_t DigitalInput::getEdgeCount()
+{
+    uint32_t edges;
+    uint8_t oldSREG = SREG;
+
+    cli();
+    edges = m_Edges;
+    SREG = oldSREG;
+    return edges;
+}
+
+/**
+ * \brief Getter for the number of pulses.
+ *
+ * \returns Number of rising edges accepted since the interrupt was enabled.
+ */
+uint32_t DigitalInput::getPulseCount()
+{
+    uint32_t pulses;
+    uint8_t oldSREG = SREG;
+
+    cli();
+    pulses = m_Pulses;
+    SREG = oldSREG;
+    return pulses;
+}
+
+/**
+ * \brief Reads an edge from the history.
+ * \param[in] age 0 for the latest edge, 1 for the one before and so on.
+ * \param[out] edge The edge.
+ *
+ * \returns 0 on success. -1 if the edge is not in the history.
+ */
+int8_t DigitalInput::getEdge(uint8_t age, DigitalInputEdge* edge)
+{
+    uint8_t oldSREG;
+    int8_t result = -1;
+
+    if (age >= DIGITALINPUT_EDGE_BUFFER)
+        return -1;
+
+    oldSREG = SREG;
+    cli();
+    if (age < m_Edges)
+    {
+        *edge = m_History[(m_Next + DIGITALINPUT_EDGE_BUFFER - 1 - age)
+                          % DIGITALINPUT_EDGE_BUFFER];
+        result = 0;
+    }
+    SREG = oldSREG;
+
+    return result;
+}
+
+/**
+ * \brief Calculates the pulse rate from the edge history.
+ *
+ * The rate is derived from the time between the oldest and the latest rising
+ * edge in the history. When the time since the latest pulse is longer than
+ * the average period the rate is lowered accordingly. It drops to zero when
+ * there was no pulse for #DIGITALINPUT_RATE_TIMEOUT milliseconds.
+ *
+ * \returns Pulses per minute in milli-units.
+ */
+int32_t DigitalInput::getPulseRate()
+{
+    DigitalInputEdge edge;
+    unsigned long newest = 0, oldest = 0, period, now;
+    uint8_t age, pulses = 0;
+
+    for (age = 0; getEdge(age, &edge) == 0; age++)
+    {
+        if (edge.level != HIGH)
+            continue;
+        if (pulses++ == 0)
+            newest = edge.time;
+        oldest = edge.time;
+    }
+
+    now = millis();
+    if (pulses < 2 || now - newest >= DIGITALINPUT_RATE_TIMEOUT)
+        return 0;
+
+    period = (newest - oldest) / (pulses - 1);
+    if (now - newest > period)
+        period = now - newest;
+    if (period == 0)
+        period = 1;
+
+    return 60000000UL / period;
+}
+
+/**
+ * \brief Records an edge.
+ * \param[in] level Level of the pin after the edge.
+ * \param[in] now Current value of millis().
+ *
+ * Called with interrupts disabled.
+ */
+void DigitalInput::handleEdge(uint8_t level, unsigned long now)
+{
+    if (level == m_Level || now - m_LastEdge < m_Debounce)
+        return;
+
+    m_Level = level;
+    m_LastEdge = now;
+    m_Edges++;
+    if (level == HIGH)
+        m_Pulses++;
+    m_History[m_Next].time = now;
+    m_History[m_Next].level = level;
+    if (++m_Next == DIGITALINPUT_EDGE_BUFFER)
+        m_Next = 0;
+}
+
+/**
+ * \brief Dispatches a pin change interrupt to the registered inputs.
+ * \param[in] bank 0 for PCINT0..7, 1 for PCINT16..23.
+ * \param[in] state Current state of the input port of the bank.
+ */
+void DigitalInput::handleInterrupt(uint8_t bank, uint8_t state)
+{
+    uint8_t changed = state ^ m_BankState[bank];
+    unsigned long now = millis();
+    uint8_t bit;
+
+    m_BankState[bank] = state;
+    for (bit = 0; changed; bit++, changed >>= 1)
+    {
+        if ((changed & 1) && m_Slots[(bank << 3) + bit] != NULL)
+            m_Slots[(bank << 3) + bit]->handleEdge((state >> bit) & 1, now);
+    }
+}
+
+#ifdef USE_SENSOR_DIGITALINPUT
+ISR(PCINT0_vect)
+{
+    DigitalInput::handleInterrupt(0, PINB);
+}
+
+ISR(PCINT2_vect)
+{
+    DigitalInput::handleInterrupt(1, PINK);
+}
+#endif
@@ -22,23 +22,82 @@
 #define DIGITALINPUT_H_
 
 #include <Framework/Sensor.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Edge recorded by an interrupt driven DigitalInput.
+ */
+struct DigitalInputEdge
+{
+    /**
+     * \brief Value of millis() when the edge was detected.
+     */
+    unsigned long time;
+
+    /**
+     * \brief Level after the edge (HIGH or LOW).
+     */
+    uint8_t level;
+};
 
 /**
  * \brief Class for using Arduino pins as digital input.
+ *
+ * By default the pin is sampled on every read. Pins with a pin change
+ * interrupt (10..13, 50..53 and 62..69 on the Mega) can be switched to
+ * interrupt driven mode instead. Then every edge is recorded with its
+ * timestamp in a ring buffer of #DIGITALINPUT_EDGE_BUFFER entries and
+ * counted as soon as it happens, even when the main loop stalls. Edges
+ * following an accepted edge within the debounce time are ignored. The level
+ * returned by read is the debounced one.
+ *
+ * The rising edges are counted as pulses. getPulseRate derives the pulses
+ * per minute of e.g. a flow meter from the buffered timestamps.
  */
 class DigitalInput: public Sensor
 {
 public:
     DigitalInput();
+    virtual ~DigitalInput();
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
     double read();
+    int32_t readMilli();
+    uint8_t getDecimals();
 
     uint16_t serialize(Stream* s);
     uint16_t deserialize(Stream* s);
     void setPin(uint8_t pin);
     uint8_t getPin();
 
+    int8_t enableInterrupt(uint8_t debounce);
+    void disableInterrupt();
+    uint8_t isInterruptDriven();
+    uint8_t getDebounce();
+
+    uint32_t getEdgeCount();
+    uint32_t getPulseCount();
+    int8_t getEdge(uint8_t age, DigitalInputEdge* edge);
+    int32_t getPulseRate();
+
+    static void handleInterrupt(uint8_t bank, uint8_t state);
+
 private:
+    static int8_t getSlot(uint8_t pin);
+    void handleEdge(uint8_t level, unsigned long now);
+
     unsigned char m_Pin;
+    uint8_t m_Interrupt;
+    uint8_t m_Debounce;
+    volatile uint8_t m_Level;
+    volatile uint8_t m_Next;
+    volatile uint32_t m_Edges;
+    volatile uint32_t m_Pulses;
+    volatile unsigned long m_LastEdge;
+    DigitalInputEdge m_History[DIGITALINPUT_EDGE_BUFFER];
+
+    static DigitalInput* m_Slots[16];
+    static uint8_t m_BankState[2];
 };
 
 #endif /* DIGITALINPUT_H_ */
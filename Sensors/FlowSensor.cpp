@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FlowSensor.h"
+#include <Framework/Aquaduino.h>
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+FlowSensor* FlowSensor::m_Counters[6];
+
+/**
+ * \brief Constructor
+ *
+ * The default calibration fits the common 450 pulses per litre meters.
+ */
+FlowSensor::FlowSensor()
+{
+    m_Type = SENSOR_FLOW;
+    m_Pin = 0;
+    m_Interrupt = -1;
+    m_MicroPerPulse = 2222;
+    m_Volume = 0;
+    m_Remainder = 0;
+    m_Rate = 0;
+    m_Pulses = 0;
+    m_LastPulses = 0;
+    m_LastUpdate = millis();
+    m_LastPersist = m_LastUpdate;
+    m_Dirty = 0;
+}
+
+/**
+ * \brief Destructor
+ *
+ * Releases the external interrupt.
+ */
+FlowSensor::~FlowSensor()
+{
+    detach();
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId Pin the flow meter is attached to.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object.
+ */
+Object* FlowSensor::create(void* memory, const char* name, uint8_t portId,
+                           uint8_t option)
+{
+    FlowSensor* sensor = new (memory) FlowSensor();
+    sensor->setName(name);
+    sensor->setPin(portId);
+    return sensor;
+}
+
+/**
+ * \brief Reads the flow rate
+ *
+ * \returns The rate in units per minute.
+ */
+double FlowSensor::read()
+{
+    return readMilli() / 1000.0;
+}
+
+/**
+ * \brief Reads the flow rate in milli-units
+ *
+ * The rate is updated every #FLOW_RATE_INTERVAL milliseconds and passed
+ * through the filter of the sensor.
+ *
+ * \returns The rate in milli-units per minute.
+ */
+int32_t FlowSensor::readMilli()
+{
+    update();
+    return m_Filter.getValue();
+}
+
+/**
+ * \brief Getter for the unit of the flow rate.
+ *
+ * \returns Litres per minute, which holds for calibrations in micro-litres.
+ */
+const __FlashStringHelper* FlowSensor::getUnit()
+{
+    return F("l/min");
+}
+
+/**
+ * \brief Converts the pulses counted since the last update.
+ *
+ * Fractions of a milli-unit are carried over to the next update so the
+ * volume does not drift.
+ */
+void FlowSensor::update()
+{
+    unsigned long now = millis();
+    unsigned long elapsed = now - m_LastUpdate;
+    uint32_t pulses, delta, amount;
+    uint8_t oldSREG;
+
+    if (elapsed < FLOW_RATE_INTERVAL)
+        return;
+
+    oldSREG = SREG;
+    cli();
+    pulses = m_Pulses;
+    SREG = oldSREG;
+
+    delta = pulses - m_LastPulses;
+    m_LastPulses = pulses;
+    m_LastUpdate = now;
+
+    //amount in micro-units
+    amount = delta * m_MicroPerPulse;
+    if (amount < 71000000UL)
+        m_Rate = amount * 60 / elapsed;
+    else
+        m_Rate = amount / elapsed * 60;
+    m_Filter.add(m_Rate);
+
+    amount += m_Remainder;
+    m_Volume += amount / 1000;
+    m_Remainder = amount % 1000;
+
+    if (delta)
+        m_Dirty = 1;
+    if (m_Dirty && now - m_LastPersist >= FLOW_PERSIST_INTERVAL)
+    {
+        m_LastPersist = now;
+        m_Dirty = 0;
+        __aquaduino->writeConfig(this);
+    }
+}
+
+/**
+ * \brief Serializes pin, calibration and volume.
+ */
+uint16_t FlowSensor::serialize(Stream* s)
+{
+    s->write(m_Pin);
+    s->write((uint8_t*) &m_MicroPerPulse, sizeof(m_MicroPerPulse));
+    s->write((uint8_t*) &m_Volume, sizeof(m_Volume));
+    return sizeof(m_Pin) + sizeof(m_MicroPerPulse) + sizeof(m_Volume);
+}
+
+/**
+ * \brief Deserializes pin, calibration and volume.
+ */
+uint16_t FlowSensor::deserialize(Stream* s)
+{
+    uint32_t microPerPulse;
+
+    setPin(s->read());
+    if (s->readBytes((char*) &microPerPulse, sizeof(microPerPulse))
+        != sizeof(microPerPulse))
+        return 1;
+    setCalibration(microPerPulse);
+    s->readBytes((char*) &m_Volume, sizeof(m_Volume));
+    return sizeof(m_Pin) + sizeof(m_MicroPerPulse) + sizeof(m_Volume);
+}
+
+/**
+ * \brief Maps a pin to the number used by attachInterrupt.
+ * \param[in] pin Arduino pin number.
+ *
+ * \returns The interrupt number or -1 if the pin has no external interrupt.
+ */
+int8_t FlowSensor::getInterrupt(uint8_t pin)
+{
+    switch (pin)
+    {
+    case 2:
+        return 0;
+    case 3:
+        return 1;
+    case 21:
+        return 2;
+    case 20:
+        return 3;
+    case 19:
+        return 4;
+    case 18:
+        return 5;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * \brief Sets the pin of the flow meter and starts counting.
+ * \param[in] pin Arduino pin number with external interrupt.
+ *
+ * The internal pull-up is enabled for open collector outputs.
+ *
+ * \returns 0 on success. -1 if the pin has no external interrupt or the
+ * interrupt is used by another FlowSensor.
+ */
+int8_t FlowSensor::setPin(uint8_t pin)
+{
+    static void (* const counters[6])() =
+        { &FlowSensor::countPulse0, &FlowSensor::countPulse1,
+          &FlowSensor::countPulse2, &FlowSensor::countPulse3,
+          &FlowSensor::countPulse4, &FlowSensor::countPulse5 };
+    int8_t interrupt = getInterrupt(pin);
+
+    detach();
+    m_Pin = pin;
+    if (interrupt < 0 || m_Counters[interrupt] != NULL)
+        return -1;
+
+    pinMode(m_Pin, INPUT_PULLUP);
+    m_Interrupt = interrupt;
+    m_Counters[interrupt] = this;
+    attachInterrupt(interrupt, counters[interrupt], RISING);
+    return 0;
+}
+
+/**
+ * \brief Stops counting.
+ */
+void FlowSensor::detach()
+{
+    if (m_Interrupt < 0)
+        return;
+    detachInterrupt(m_Interrupt);
+    m_Counters[m_Interrupt] = NULL;
+    m_Interrupt = -1;
+}
+
+uint8_t FlowSensor::getPin()
+{
+    return m_Pin;
+}
+
+/**
+ * \brief Sets the calibration.
+ * \param[in] microPerPulse Amount per pulse in micro-units. E.g. micro-litres
+ *                          for flow meters or micrometres for rain gauges.
+ */
+void FlowSensor::setCalibration(uint32_t microPerPulse)
+{
+    m_MicroPerPulse = microPerPulse;
+}
+
+/**
+ * \brief Getter for the calibration.
+ *
+ * \returns Amount per pulse in micro-units.
+ */
+uint32_t FlowSensor::getCalibration()
+{
+    return m_MicroPerPulse;
+}
+
+/**
+ * \brief Getter for the cumulative volume.
+ *
+ * \returns Volume in milli-units (e.g. millilitres) since the last reset.
+ */
+uint32_t FlowSensor::getVolume()
+{
+    return m_Volume;
+}
+
+/**
+ * \brief Resets the cumulative volume to zero.
+ */
+void FlowSensor::resetVolume()
+{
+    m_Volume = 0;
+    m_Remainder = 0;
+}
+
+/**
+ * \brief Getter for the number of pulses.
+ *
+ * \returns Number of pulses counted since the sensor was created.
+ */
+uint32_t FlowSensor::getPulseCount()
+{
+    uint32_t pulses;
+    uint8_t oldSREG = SREG;
+
+    cli();
+    pulses = m_Pulses;
+    SREG = oldSREG;
+    return pulses;
+}
+
+/*
+ * Handlers registered by attachInterrupt. Called with interrupts disabled.
+ */
+void FlowSensor::countPulse0()
+{
+    if (m_Counters[0] != NULL)
+        m_Counters[0]->m_Pulses++;
+}
+
+void FlowSensor::countPulse1()
+{
+    if (m_Counters[1] != NULL)
+        m_Counters[1]->m_Pulses++;
+}
+
+void FlowSensor::countPulse2()
+{
+    if (m_Counters[2] != NULL)
+        m_Counters[2]->m_Pulses++;
+}
+
+void FlowSensor::countPulse3()
+{
+    if (m_Counters[3] != NULL)
+        m_Counters[3]->m_Pulses++;
+}
+
+void FlowSensor::countPulse4()
+{
+    if (m_Counters[4] != NULL)
+        m_Counters[4]->m_Pulses++;
+}
+
+void FlowSensor::countPulse5()
+{
+    if (m_Counters[5] != NULL)
+        m_Counters[5]->m_Pulses++;
+}
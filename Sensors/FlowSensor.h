@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FLOWSENSOR_H_
+#define FLOWSENSOR_H_
+
+#include <Framework/Sensor.h>
+#include <Framework/FrameworkConfig.h>
+
+/**
+ * \brief Pulse counting sensor for flow meters and rain gauges.
+ *
+ * Hall effect flow meters and tipping bucket rain gauges deliver one pulse
+ * per fixed amount of water. The pulses are counted by the ISR of an external
+ * interrupt. The ISR only increments a counter so several hundred pulses per
+ * second are counted without loss and without load on the main loop. The
+ * supported pins are 2, 3, 18, 19, 20 and 21 of the Mega.
+ *
+ * The calibration is given as amount per pulse in micro-units. E.g. a meter
+ * with 450 pulses per litre has 2222 micro-litres per pulse. Every
+ * #FLOW_RATE_INTERVAL milliseconds the new pulses are converted to a rate in
+ * units per minute, which is the value of the sensor, and added to the
+ * cumulative volume. The volume is persisted every #FLOW_PERSIST_INTERVAL
+ * milliseconds while it changes.
+ */
+class FlowSensor: public Sensor
+{
+public:
+    FlowSensor();
+    virtual ~FlowSensor();
+    static Object* create(void* memory, const char* name, uint8_t portId,
+                          uint8_t option);
+    double read();
+    int32_t readMilli();
+    const __FlashStringHelper* getUnit();
+
+    uint16_t serialize(Stream* s);
+    uint16_t deserialize(Stream* s);
+
+    int8_t setPin(uint8_t pin);
+    uint8_t getPin();
+
+    void setCalibration(uint32_t microPerPulse);
+    uint32_t getCalibration();
+
+    uint32_t getVolume();
+    void resetVolume();
+    uint32_t getPulseCount();
+
+private:
+    static int8_t getInterrupt(uint8_t pin);
+    void detach();
+    void update();
+
+    static void countPulse0();
+    static void countPulse1();
+    static void countPulse2();
+    static void countPulse3();
+    static void countPulse4();
+    static void countPulse5();
+
+    uint8_t m_Pin;
+    int8_t m_Interrupt;
+    uint32_t m_MicroPerPulse;
+    uint32_t m_Volume;
+    uint16_t m_Remainder;
+    int32_t m_Rate;
+    volatile uint32_t m_Pulses;
+    uint32_t m_LastPulses;
+    unsigned long m_LastUpdate;
+    unsigned long m_LastPersist;
+    uint8_t m_Dirty;
+
+    static FlowSensor* m_Counters[6];
+};
+
+#endif /* FLOWSENSOR_H_ */
@@ -11,9 +11,9 @@ d		:= $(dir)
 
 # Local variables
 
-OBJS_$(d)	:= $(d)/DigitalInput.o $(d)/DS18S20.o \
-               $(d)/SerialAtlasEC.o $(d)/SerialAtlasORP.o \
-               $(d)/SerialAtlasPH.o
+OBJS_$(d)	:= $(d)/AnalogInput.o $(d)/AtlasSerialPort.o \
+               $(d)/DigitalInput.o $(d)/DS18S20.o $(d)/FlowSensor.o \
+               $(d)/SerialAtlasSensor.o
 DEPS_$(d)	:= $(OBJS_$(d):%=%.d)
 CLEAN		:= $(CLEAN) $(OBJS_$(d)) $(DEPS_$(d))
 
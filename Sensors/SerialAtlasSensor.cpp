@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SerialAtlasSensor.h"
+#include "AtlasSerialPort.h"
+#include <Framework/Aquaduino.h>
+#include <Framework/ObjectTypes.h>
+#include <Framework/SerialLineParser.h>
+#include <stdio.h>
+
+#if defined(USE_SENSOR_SERIALATLASPH) || defined(USE_SENSOR_SERIALATLASEC) \
+    || defined(USE_SENSOR_SERIALATLASORP)
+
+/**
+ * \brief First byte of the configuration. Tells it apart from the pin stored
+ * by the former SerialAtlasPH/EC/ORP classes which is always below 70.
+ */
+#define SERIALATLASSENSOR_FORMAT 0xA1
+
+/**
+ * \brief Constructor
+ * \param[in] probe ATLAS_PH, ATLAS_EC or ATLAS_ORP
+ * \param[in] uart UART the circuit is attached to (1 - 3)
+ */
+SerialAtlasSensor::SerialAtlasSensor(uint8_t probe, uint8_t uart)
+{
+    m_Type = SENSOR_SERIALINPUT;
+    m_Probe = probe;
+    m_Uart = uart;
+    m_Channel = 0;
+    m_Pending = 0;
+    m_TempSensorID = -1;
+    m_Value = 0;
+    m_LastRequest = 0;
+    m_LastTempComp = 0;
+    AtlasSerialPort::getPort(m_Uart);
+}
+
+/**
+ * \brief Destructor
+ *
+ * Removes the queued commands of the sensor.
+ */
+SerialAtlasSensor::~SerialAtlasSensor()
+{
+    AtlasSerialPort::detach(this);
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory for pH circuits
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId Unused. The UART is set by the configuration.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object. Attached to UART 3 by default.
+ */
+Object* SerialAtlasSensor::createPH(void* memory, const char* name,
+                                    uint8_t portId, uint8_t option)
+{
+    SerialAtlasSensor* sensor = new (memory) SerialAtlasSensor(ATLAS_PH, 3);
+    sensor->setName(name);
+    return sensor;
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory for EC circuits
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId Unused. The UART is set by the configuration.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object. Attached to UART 1 by default.
+ */
+Object* SerialAtlasSensor::createEC(void* memory, const char* name,
+                                    uint8_t portId, uint8_t option)
+{
+    SerialAtlasSensor* sensor = new (memory) SerialAtlasSensor(ATLAS_EC, 1);
+    sensor->setName(name);
+    return sensor;
+}
+
+/**
+ * \brief Factory method registered in ObjectFactory for ORP circuits
+ * \param[in] memory Memory for the new object.
+ * \param[in] name Name of the sensor.
+ * \param[in] portId Unused. The UART is set by the configuration.
+ * \param[in] option Unused.
+ *
+ * \returns The constructed object. Attached to UART 2 by default.
+ */
+Object* SerialAtlasSensor::createORP(void* memory, const char* name,
+                                     uint8_t portId, uint8_t option)
+{
+    SerialAtlasSensor* sensor = new (memory) SerialAtlasSensor(ATLAS_ORP, 2);
+    sensor->setName(name);
+    return sensor;
+}
+
+/**
+ * \brief Returns the last reading
+ *
+ * \returns The reading in the unit of the probe.
+ */
+double SerialAtlasSensor::read()
+{
+    return readMilli() / 1000.0;
+}
+
+/**
+ * \brief Returns the last reading in thousandths of the unit of the probe
+ *
+ * Queues the next reading when #ATLAS_READ_INTERVAL passed since the last
+ * request and no request is pending. pH and EC readings are temperature
+ * compensated every #ATLAS_TEMPCOMP_INTERVAL milliseconds.
+ *
+ * \returns The reading multiplied by 1000.
+ */
+int32_t SerialAtlasSensor::readMilli()
+{
+    AtlasSerialPort* port = AtlasSerialPort::getPort(m_Uart);
+    char command[ATLAS_COMMAND_LENGTH];
+    int32_t temperature;
+    int16_t centi;
+    int16_t magnitude;
+    unsigned long now = millis();
+
+    if (port == NULL)
+        return m_Value;
+
+    port->run();
+
+    if (!m_Pending && now - m_LastRequest >= ATLAS_READ_INTERVAL)
+    {
+        strcpy(command, "R\r");
+        if (m_Probe != ATLAS_ORP
+            && now - m_LastTempComp >= ATLAS_TEMPCOMP_INTERVAL
+            && getTemperature(&temperature) == 0)
+        {
+            centi = temperature / 10;
+            magnitude = centi < 0 ? -centi : centi;
+            snprintf(command, sizeof(command), "%s%d.%02d\r",
+                     centi < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+            m_LastTempComp = now;
+        }
+        if (port->enqueue(this, m_Channel, command) == 0)
+        {
+            m_Pending = 1;
+            m_LastRequest = now;
+        }
+    }
+
+    return m_Value;
+}
+
+/**
+ * \brief Getter for the resolution of the reading.
+ *
+ * \returns 2 for pH, 0 for EC (uS/cm) and 1 for ORP (mV).
+ */
+uint8_t SerialAtlasSensor::getDecimals()
+{
+    if (m_Probe == ATLAS_PH)
+        return 2;
+    if (m_Probe == ATLAS_ORP)
+        return 1;
+    return 0;
+}
+
+/**
+ * \brief Getter for the unit of the reading.
+ *
+ * \returns pH, uS/cm or mV depending on the probe.
+ */
+const __FlashStringHelper* SerialAtlasSensor::getUnit()
+{
+    if (m_Probe == ATLAS_PH)
+        return F("pH");
+    if (m_Probe == ATLAS_ORP)
+        return F("mV");
+    return F("uS/cm");
+}
+
+/**
+ * \brief Queues a calibration command
+ * \param[in] command Command without the carriage return
+ *
+ * \returns 0 when the command was queued. -1 otherwise.
+ */
+int8_t SerialAtlasSensor::calibrate(const char* command)
+{
+    AtlasSerialPort* port = AtlasSerialPort::getPort(m_Uart);
+    char buffer[ATLAS_COMMAND_LENGTH];
+
+    if (port == NULL || strlen(command) + 2 > sizeof(buffer))
+        return -1;
+
+    strcpy(buffer, command);
+    strcat(buffer, "\r");
+    return port->enqueue(this, m_Channel, buffer);
+}
+
+/**
+ * \brief Delivers the response line of a command
+ * \param[in] line Line without the carriage return
+ *
+ * EC circuits send comma separated values of which the last one is used.
+ * Responses starting with '*' (e.g. *OK) carry no value.
+ */
+void SerialAtlasSensor::handleResponse(const char* line)
+{
+    const char* value = line;
+    int32_t sample;
+
+    m_Pending = 0;
+    if (*line == '*')
+        return;
+
+    if (m_Probe == ATLAS_EC)
+    {
+        value = strrchr(line, ',');
+        value = value != NULL ? value + 1 : line;
+    }
+    if (SerialLineParser::parseDecimal(value, 3, &sample) >= 0)
+        m_Value = m_Filter.add(sample);
+}
+
+/**
+ * \brief Called when a command was not answered in time
+ */
+void SerialAtlasSensor::handleTimeout()
+{
+    m_Pending = 0;
+}
+
+/**
+ * \brief Gets the temperature used for compensation
+ * \param[out] temperature Temperature in milli degrees Celsius
+ *
+ * The ID of the DS18S20 is looked up once and only searched again when the
+ * sensor with that ID is gone or has another type.
+ *
+ * \returns 0 on success. -1 if there is no DS18S20.
+ */
+int8_t SerialAtlasSensor::getTemperature(int32_t* temperature)
+{
+    Sensor* sensor = NULL;
+
+    if (m_TempSensorID >= 0)
+        sensor = __aquaduino->getSensor(m_TempSensorID);
+
+    if (sensor == NULL || sensor->getType() != SENSOR_DS18S20)
+    {
+        m_TempSensorID = -1;
+        __aquaduino->resetSensorIterator();
+        while (__aquaduino->getNextSensor(&sensor) != -1)
+        {
+            if (sensor->getType() == SENSOR_DS18S20)
+            {
+                m_TempSensorID = __aquaduino->getSensorID(sensor);
+                break;
+            }
+        }
+        if (m_TempSensorID < 0)
+            return -1;
+    }
+
+    *temperature = __aquaduino->getSensorMilliValue(m_TempSensorID);
+    return 0;
+}
+
+/**
+ * \brief Serializes UART and expander channel behind a format marker
+ */
+uint16_t SerialAtlasSensor::serialize(Stream* s)
+{
+    s->write(SERIALATLASSENSOR_FORMAT);
+    s->write(m_Uart);
+    s->write(m_Channel);
+    return 3;
+}
+
+/**
+ * \brief Deserializes UART and expander channel
+ *
+ * Configurations of the former SerialAtlasPH/EC/ORP classes contain an unused
+ * pin only. They are recognized by the missing format marker. Those sensors
+ * keep the default UART of their probe type.
+ */
+uint16_t SerialAtlasSensor::deserialize(Stream* s)
+{
+    int uart, channel;
+
+    if (s->read() != SERIALATLASSENSOR_FORMAT)
+        return 1;
+
+    uart = s->read();
+    channel = s->read();
+    if (uart < 1 || uart > 3)
+        uart = m_Uart;
+    if (channel < 0 || channel > 8)
+        channel = 0;
+    setPort(uart, channel);
+    return 3;
+}
+
+/**
+ * \brief Sets UART and port expander channel
+ * \param[in] uart UART the circuit is attached to (1 - 3)
+ * \param[in] channel Channel of the port expander (1 - 8). 0 without expander.
+ *
+ * \returns 0 on success. -1 for invalid values.
+ */
+int8_t SerialAtlasSensor::setPort(uint8_t uart, uint8_t channel)
+{
+    if (AtlasSerialPort::getPort(uart) == NULL || channel > 8)
+        return -1;
+    m_Uart = uart;
+    m_Channel = channel;
+    return 0;
+}
+
+uint8_t SerialAtlasSensor::getProbe()
+{
+    return m_Probe;
+}
+
+uint8_t SerialAtlasSensor::getUart()
+{
+    return m_Uart;
+}
+
+uint8_t SerialAtlasSensor::getChannel()
+{
+    return m_Channel;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SERIALATLASSENSOR_H_
+#define SERIALATLASSENSOR_H_
+
+#include <Framework/Sensor.h>
+
+/**
+ * \brief Probe types of the Atlas Scientific circuits
+ */
+enum
+{
+    ATLAS_PH, ATLAS_EC, ATLAS_ORP
+};
+
+/**
+ * \brief Atlas Scientific pH, EC and ORP circuits attached to a UART
+ *
+ * The sensor is parameterised by its probe type, the UART (1 - 3) and the
+ * channel of an optional serial port expander. Readings are requested every
+ * #ATLAS_READ_INTERVAL milliseconds through the queue of the AtlasSerialPort
+ * of the UART. pH and EC readings are temperature compensated every
+ * #ATLAS_TEMPCOMP_INTERVAL milliseconds using the first DS18S20 sensor. Its
+ * ID is cached.
+ *
+ * The value is kept in thousandths of the unit of the probe.
+ */
+class SerialAtlasSensor: public Sensor
+{
+public:
+    SerialAtlasSensor(uint8_t probe, uint8_t uart);
+    virtual ~SerialAtlasSensor();
+    static Object* createPH(void* memory, const char* name, uint8_t portId,
+                            uint8_t option);
+    static Object* createEC(void* memory, const char* name, uint8_t portId,
+                            uint8_t option);
+    static Object* createORP(void* memory, const char* name, uint8_t portId,
+                             uint8_t option);
+    double read();
+    int32_t readMilli();
+    uint8_t getDecimals();
+    const __FlashStringHelper* getUnit();
+
+    uint16_t serialize(Stream* s);
+    uint16_t deserialize(Stream* s);
+
+    int8_t setPort(uint8_t uart, uint8_t channel);
+    uint8_t getProbe();
+    uint8_t getUart();
+    uint8_t getChannel();
+
+    int8_t calibrate(const char* command);
+
+    void handleResponse(const char* line);
+    void handleTimeout();
+
+private:
+    int8_t getTemperature(int32_t* temperature);
+
+    uint8_t m_Probe;
+    uint8_t m_Uart;
+    uint8_t m_Channel;
+    uint8_t m_Pending;
+    int8_t m_TempSensorID;
+    int32_t m_Value;
+    unsigned long m_LastRequest;
+    unsigned long m_LastTempComp;
+};
+
+#endif /* SERIALATLASSENSOR_H_ */
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2014 Timo Kerstan.  All right reserved.
+#
+# This file is part of Aquaduino.
+#
+# Aquaduino is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Aquaduino is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Compiles HTML templates into token streams stored in PROGMEM which are
+# expanded by renderTemplate (Framework/TemplateRenderer.h).
+#
+# Usage: compile-templates.py <output> <template>...
+#
+# Writes <output>.h and <output>.cpp. Each template x.htm becomes the array
+# xTemplate. A stream is a sequence of tokens terminated by 0:
+#
+#   0x01..0x7F  Literal. The byte gives the number of characters following.
+#   0x80..0xFF  Placeholder. The lower 7 bits are one of the TEMPLATE_*
+#               constants declared in <output>.h.
+#
+# Placeholders are written as ##NAME## in the templates. Indentation at the
+# beginning of a line is dropped as it only costs flash and transfer time.
+
+import os
+import re
+import sys
+
+PLACEHOLDER = re.compile(r'##([A-Z0-9_]+)##')
+MAX_LITERAL = 0x7F
+MAX_PLACEHOLDERS = 0x80
+
+LICENSE = """/*
+ * Copyright (c) 2014 Timo Kerstan.  All right reserved.
+ *
+ * This file is part of Aquaduino.
+ *
+ * Aquaduino is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Aquaduino is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Aquaduino.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Generated by build/compile-templates.py. Do not edit.
+ */
+"""
+
+
+def tokenize(text):
+    text = text.replace('\r', '')
+    text = '\n'.join(line.lstrip(' \t') for line in text.split('\n'))
+    tokens = []
+    position = 0
+    for match in PLACEHOLDER.finditer(text):
+        if match.start() > position:
+            tokens.append(('literal', text[position:match.start()]))
+        tokens.append(('placeholder', match.group(1)))
+        position = match.end()
+    if position < len(text):
+        tokens.append(('literal', text[position:]))
+    return tokens
+
+
+def quote(text):
+    result = '"'
+    for c in text:
+        if c == '\\' or c == '"':
+            result += '\\' + c
+        elif c == '\n':
+            result += '\\n'
+        elif c == '\t':
+            result += '\\t'
+        elif ' ' <= c <= '~':
+            result += c
+        else:
+            result += '\\%03o' % ord(c)
+    return result + '"'
+
+
+def emit(tokens, ids):
+    lines = []
+    for kind, value in tokens:
+        if kind == 'placeholder':
+            lines.append('"\\x%02x" /* %s */' % (0x80 | ids[value], value))
+            continue
+        data = value.encode('latin-1')
+        for start in range(0, len(data), MAX_LITERAL):
+            chunk = data[start:start + MAX_LITERAL].decode('latin-1')
+            lines.append('"\\x%02x"' % len(chunk))
+            for line in chunk.splitlines(True):
+                lines.append(quote(line))
+    return lines
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write('usage: %s <output> <template>...\n' % argv[0])
+        return 1
+
+    output = argv[1]
+    templates = []
+    names = set()
+    for path in argv[2:]:
+        with open(path, 'rb') as f:
+            tokens = tokenize(f.read().decode('latin-1'))
+        symbol = os.path.splitext(os.path.basename(path))[0] + 'Template'
+        templates.append((path, symbol, tokens))
+        names.update(v for k, v in tokens if k == 'placeholder')
+
+    names = sorted(names)
+    if len(names) > MAX_PLACEHOLDERS:
+        sys.stderr.write('too many placeholders\n')
+        return 1
+    ids = dict((name, i) for i, name in enumerate(names))
+
+    guard = os.path.basename(output).upper() + '_H_'
+    with open(output + '.h', 'w') as h:
+        h.write(LICENSE)
+        h.write('\n#ifndef %s\n#define %s\n\n' % (guard, guard))
+        h.write('#include <avr/pgmspace.h>\n\n')
+        h.write('/**\n * \\brief Placeholders of the compiled templates.\n */\n')
+        h.write('enum\n{\n')
+        h.write(',\n'.join('    TEMPLATE_%s' % name for name in names))
+        h.write('\n};\n\n')
+        for path, symbol, tokens in templates:
+            h.write('/**\n * \\brief Compiled %s.\n */\n' % path)
+            h.write('extern const char %s[] PROGMEM;\n\n' % symbol)
+        h.write('#endif /* %s */\n' % guard)
+
+    with open(output + '.cpp', 'w') as cpp:
+        cpp.write(LICENSE)
+        cpp.write('\n#include "%s.h"\n' % os.path.basename(output))
+        for path, symbol, tokens in templates:
+            cpp.write('\nconst char %s[] PROGMEM =\n' % symbol)
+            lines = emit(tokens, ids)
+            for line in lines[:-1]:
+                cpp.write('    %s\n' % line)
+            cpp.write('    %s;\n' % (lines[-1] if lines else '""'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
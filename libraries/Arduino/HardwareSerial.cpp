@@ -45,37 +45,86 @@
   #define SERIAL_BUFFER_SIZE 64
 #endif
 
+// The buffer sizes can be chosen per port and direction at build time, e.g.
+//   make FEATURE_DEFINES="-DSERIAL_RX_BUFFER_SIZE1=256"
+// They have to be powers of two so that indices wrap with a mask.
+#ifndef SERIAL_RX_BUFFER_SIZE0
+  #define SERIAL_RX_BUFFER_SIZE0 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_TX_BUFFER_SIZE0
+  #define SERIAL_TX_BUFFER_SIZE0 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_RX_BUFFER_SIZE1
+  #define SERIAL_RX_BUFFER_SIZE1 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_TX_BUFFER_SIZE1
+  #define SERIAL_TX_BUFFER_SIZE1 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_RX_BUFFER_SIZE2
+  #define SERIAL_RX_BUFFER_SIZE2 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_TX_BUFFER_SIZE2
+  #define SERIAL_TX_BUFFER_SIZE2 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_RX_BUFFER_SIZE3
+  #define SERIAL_RX_BUFFER_SIZE3 SERIAL_BUFFER_SIZE
+#endif
+#ifndef SERIAL_TX_BUFFER_SIZE3
+  #define SERIAL_TX_BUFFER_SIZE3 SERIAL_BUFFER_SIZE
+#endif
+
+#if (SERIAL_RX_BUFFER_SIZE0 & (SERIAL_RX_BUFFER_SIZE0 - 1)) || \
+    (SERIAL_TX_BUFFER_SIZE0 & (SERIAL_TX_BUFFER_SIZE0 - 1)) || \
+    (SERIAL_RX_BUFFER_SIZE1 & (SERIAL_RX_BUFFER_SIZE1 - 1)) || \
+    (SERIAL_TX_BUFFER_SIZE1 & (SERIAL_TX_BUFFER_SIZE1 - 1)) || \
+    (SERIAL_RX_BUFFER_SIZE2 & (SERIAL_RX_BUFFER_SIZE2 - 1)) || \
+    (SERIAL_TX_BUFFER_SIZE2 & (SERIAL_TX_BUFFER_SIZE2 - 1)) || \
+    (SERIAL_RX_BUFFER_SIZE3 & (SERIAL_RX_BUFFER_SIZE3 - 1)) || \
+    (SERIAL_TX_BUFFER_SIZE3 & (SERIAL_TX_BUFFER_SIZE3 - 1))
+  #error "Serial buffer sizes must be powers of two"
+#endif
+
 struct ring_buffer
 {
-  unsigned char buffer[SERIAL_BUFFER_SIZE];
+  unsigned char *buffer;
+  unsigned int mask;
   volatile unsigned int head;
   volatile unsigned int tail;
+  // characters dropped because the buffer was full
+  volatile unsigned int overflows;
+  // highest fill level seen
+  volatile unsigned int high_water;
 };
 
+#define RING_BUFFER(name, size) \
+  static unsigned char name##_storage[size]; \
+  ring_buffer name = { name##_storage, (size) - 1, 0, 0, 0, 0 };
+
 #if defined(USBCON)
-  ring_buffer rx_buffer = { { 0 }, 0, 0};
-  ring_buffer tx_buffer = { { 0 }, 0, 0};
+  RING_BUFFER(rx_buffer, SERIAL_RX_BUFFER_SIZE0)
+  RING_BUFFER(tx_buffer, SERIAL_TX_BUFFER_SIZE0)
 #endif
 #if defined(UBRRH) || defined(UBRR0H)
-  ring_buffer rx_buffer  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_buffer, SERIAL_RX_BUFFER_SIZE0)
+  RING_BUFFER(tx_buffer, SERIAL_TX_BUFFER_SIZE0)
 #endif
 #if defined(UBRR1H)
-  ring_buffer rx_buffer1  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer1  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_buffer1, SERIAL_RX_BUFFER_SIZE1)
+  RING_BUFFER(tx_buffer1, SERIAL_TX_BUFFER_SIZE1)
 #endif
 #if defined(UBRR2H)
-  ring_buffer rx_buffer2  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer2  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_buffer2, SERIAL_RX_BUFFER_SIZE2)
+  RING_BUFFER(tx_buffer2, SERIAL_TX_BUFFER_SIZE2)
 #endif
 #if defined(UBRR3H)
-  ring_buffer rx_buffer3  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer3  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_buffer3, SERIAL_RX_BUFFER_SIZE3)
+  RING_BUFFER(tx_buffer3, SERIAL_TX_BUFFER_SIZE3)
 #endif
 
 inline void store_char(unsigned char c, ring_buffer *buffer)
 {
-  int i = (unsigned int)(buffer->head + 1) % SERIAL_BUFFER_SIZE;
+  unsigned int i = (buffer->head + 1) & buffer->mask;
+  unsigned int used;
 
   // if we should be storing the received character into the location
   // just before the tail (meaning that the head would advance to the
@@ -84,6 +133,11 @@ inline void store_char(unsigned char c, ring_buffer *buffer)
   if (i != buffer->tail) {
     buffer->buffer[buffer->head] = c;
     buffer->head = i;
+    used = (i - buffer->tail) & buffer->mask;
+    if (used > buffer->high_water)
+      buffer->high_water = used;
+  } else {
+    buffer->overflows++;
   }
 }
 
@@ -205,7 +259,7 @@ ISR(USART_UDRE_vect)
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer.buffer[tx_buffer.tail];
-    tx_buffer.tail = (tx_buffer.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer.tail = (tx_buffer.tail + 1) & tx_buffer.mask;
 	
   #if defined(UDR0)
     UDR0 = c;
@@ -229,7 +283,7 @@ ISR(USART1_UDRE_vect)
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer1.buffer[tx_buffer1.tail];
-    tx_buffer1.tail = (tx_buffer1.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer1.tail = (tx_buffer1.tail + 1) & tx_buffer1.mask;
 	
     UDR1 = c;
   }
@@ -246,7 +300,7 @@ ISR(USART2_UDRE_vect)
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer2.buffer[tx_buffer2.tail];
-    tx_buffer2.tail = (tx_buffer2.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer2.tail = (tx_buffer2.tail + 1) & tx_buffer2.mask;
 	
     UDR2 = c;
   }
@@ -263,7 +317,7 @@ ISR(USART3_UDRE_vect)
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer3.buffer[tx_buffer3.tail];
-    tx_buffer3.tail = (tx_buffer3.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer3.tail = (tx_buffer3.tail + 1) & tx_buffer3.mask;
 	
     UDR3 = c;
   }
@@ -352,7 +406,7 @@ void HardwareSerial::end()
 
 int HardwareSerial::available(void)
 {
-  return (unsigned int)(SERIAL_BUFFER_SIZE + _rx_buffer->head - _rx_buffer->tail) % SERIAL_BUFFER_SIZE;
+  return (_rx_buffer->head - _rx_buffer->tail) & _rx_buffer->mask;
 }
 
 int HardwareSerial::peek(void)
@@ -371,7 +425,7 @@ int HardwareSerial::read(void)
     return -1;
   } else {
     unsigned char c = _rx_buffer->buffer[_rx_buffer->tail];
-    _rx_buffer->tail = (unsigned int)(_rx_buffer->tail + 1) % SERIAL_BUFFER_SIZE;
+    _rx_buffer->tail = (_rx_buffer->tail + 1) & _rx_buffer->mask;
     return c;
   }
 }
@@ -384,7 +438,8 @@ void HardwareSerial::flush()
 
 size_t HardwareSerial::write(uint8_t c)
 {
-  int i = (_tx_buffer->head + 1) % SERIAL_BUFFER_SIZE;
+  unsigned int i = (_tx_buffer->head + 1) & _tx_buffer->mask;
+  unsigned int used;
 	
   // If the output buffer is full, there's nothing for it other than to 
   // wait for the interrupt handler to empty it a bit
@@ -394,12 +449,63 @@ size_t HardwareSerial::write(uint8_t c)
 	
   _tx_buffer->buffer[_tx_buffer->head] = c;
   _tx_buffer->head = i;
+  used = (i - _tx_buffer->tail) & _tx_buffer->mask;
+  if (used > _tx_buffer->high_water)
+    _tx_buffer->high_water = used;
 	
   sbi(*_ucsrb, _udrie);
   
   return 1;
 }
 
+unsigned int HardwareSerial::getRxBufferSize()
+{
+  return _rx_buffer->mask + 1;
+}
+
+unsigned int HardwareSerial::getTxBufferSize()
+{
+  return _tx_buffer->mask + 1;
+}
+
+unsigned int HardwareSerial::getRxOverflows()
+{
+  uint8_t oldSREG = SREG;
+  unsigned int value;
+
+  cli();
+  value = _rx_buffer->overflows;
+  SREG = oldSREG;
+  return value;
+}
+
+unsigned int HardwareSerial::getRxHighWater()
+{
+  uint8_t oldSREG = SREG;
+  unsigned int value;
+
+  cli();
+  value = _rx_buffer->high_water;
+  SREG = oldSREG;
+  return value;
+}
+
+unsigned int HardwareSerial::getTxHighWater()
+{
+  return _tx_buffer->high_water;
+}
+
+void HardwareSerial::resetStatistics()
+{
+  uint8_t oldSREG = SREG;
+
+  cli();
+  _rx_buffer->overflows = 0;
+  _rx_buffer->high_water = 0;
+  _tx_buffer->high_water = 0;
+  SREG = oldSREG;
+}
+
 HardwareSerial::operator bool() {
 	return true;
 }
@@ -58,6 +58,13 @@ class HardwareSerial : public Stream
     virtual size_t write(uint8_t);
     using Print::write; // pull in write(str) and write(buf, size) from Print
     operator bool();
+    // buffer statistics to right-size SERIAL_RX/TX_BUFFER_SIZEn
+    unsigned int getRxBufferSize();
+    unsigned int getTxBufferSize();
+    unsigned int getRxOverflows();
+    unsigned int getRxHighWater();
+    unsigned int getTxHighWater();
+    void resetStatistics();
 };
 
 #if defined(UBRRH) || defined(UBRR0H)
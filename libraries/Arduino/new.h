@@ -10,6 +10,11 @@
 void * operator new(size_t size);
 void operator delete(void * ptr); 
 
+inline void * operator new(size_t size, void * ptr)
+{
+  return ptr;
+}
+
 __extension__ typedef int __guard __attribute__((mode (__DI__)));
 
 extern "C" int __cxa_guard_acquire(__guard *);
@@ -47,11 +47,16 @@
 #define INVALID_SERVER   -2
 #define TRUNCATED        -3
 #define INVALID_RESPONSE -4
+#define NO_SOCKET        -7
+#define SEND_FAILED      -8
+
+DNSClient::CacheEntry DNSClient::sCache[DNS_CACHE_SIZE];
 
 void DNSClient::begin(const IPAddress& aDNSServer)
 {
     iDNSServer = aDNSServer;
     iRequestId = 0;
+    iPending = false;
 }
 
 
@@ -116,6 +121,17 @@ int DNSClient::inet_aton(const char* aIPAddrString, IPAddress& aResult)
 }
 
 int DNSClient::getHostByName(const char* aHostname, IPAddress& aResult)
+{
+    int ret = beginHostByName(aHostname, aResult);
+    while (ret == DNS_PENDING)
+    {
+        delay(50);
+        ret = checkHostByName(aResult);
+    }
+    return ret;
+}
+
+int DNSClient::beginHostByName(const char* aHostname, IPAddress& aResult)
 {
     int ret =0;
 
@@ -126,52 +142,179 @@ int DNSClient::getHostByName(const char* aHostname, IPAddress& aResult)
         return 1;
     }
 
+    // See if we've looked it up recently
+    uint32_t nameHash = hash(aHostname);
+    CacheEntry* entry = lookup(nameHash);
+    if (entry)
+    {
+        memcpy(aResult.raw_address(), entry->iAddress, 4);
+        return 1;
+    }
+
     // Check we've got a valid DNS server to use
     if (iDNSServer == INADDR_NONE)
     {
         return INVALID_SERVER;
     }
-	
+
+    if (iPending)
+    {
+        // Drop whatever we were waiting for before
+        iUdp.stop();
+        iPending = false;
+    }
+
     // Find a socket to use
-    if (iUdp.begin(1024+(millis() & 0xF)) == 1)
+    if (iUdp.begin(1024+(millis() & 0xF)) != 1)
+    {
+        return NO_SOCKET;
+    }
+
+    // Send DNS request
+    ret = iUdp.beginPacket(iDNSServer, DNS_PORT);
+    if (ret != 0)
     {
-        // Try up to three times
-        int retries = 0;
-//        while ((retries < 3) && (ret <= 0))
+        // Now output the request data
+        ret = BuildRequest(aHostname);
+        if (ret != 0)
         {
-            // Send DNS request
-            ret = iUdp.beginPacket(iDNSServer, DNS_PORT);
-            if (ret != 0)
-            {
-                // Now output the request data
-                ret = BuildRequest(aHostname);
-                if (ret != 0)
-                {
-                    // And finally send the request
-                    ret = iUdp.endPacket();
-                    if (ret != 0)
-                    {
-                        // Now wait for a response
-                        int wait_retries = 0;
-                        ret = TIMED_OUT;
-                        while ((wait_retries < 3) && (ret == TIMED_OUT))
-                        {
-                            ret = ProcessResponse(5000, aResult);
-                            wait_retries++;
-                        }
-                    }
-                }
-            }
-            retries++;
+            // And finally send the request
+            ret = iUdp.endPacket();
         }
-
-        // We're done with the socket now
+    }
+    if (ret == 0)
+    {
         iUdp.stop();
+        return SEND_FAILED;
+    }
+
+    iPendingHash = nameHash;
+    iRequestTime = millis();
+    iPending = true;
+    return DNS_PENDING;
+}
+
+int DNSClient::checkHostByName(IPAddress& aResult)
+{
+    if (!iPending)
+    {
+        // There's no request to wait for
+        return NO_SOCKET;
     }
 
+    int ret;
+    if (iUdp.parsePacket() > 0)
+    {
+        // We've had a reply!
+        ret = ReadResponse(aResult);
+    }
+    else if ((millis() - iRequestTime) > DNS_TIMEOUT)
+    {
+        ret = TIMED_OUT;
+    }
+    else
+    {
+        return DNS_PENDING;
+    }
+
+    // We're done with the socket now
+    iUdp.stop();
+    iPending = false;
+
+    if (ret == SUCCESS)
+    {
+        store(iPendingHash, aResult, iTTL);
+    }
     return ret;
 }
 
+void DNSClient::forget(const char* aHostname)
+{
+    CacheEntry* entry = lookup(hash(aHostname));
+    if (entry)
+    {
+        entry->iLifetime = 0;
+    }
+}
+
+uint32_t DNSClient::hash(const char* aName)
+{
+    // FNV-1a, case insensitive as DNS names are
+    uint32_t h = 2166136261UL;
+    while (*aName)
+    {
+        char c = *aName++;
+        if ((c >= 'A') && (c <= 'Z'))
+        {
+            c += 'a' - 'A';
+        }
+        h = (h ^ (uint8_t)c) * 16777619UL;
+    }
+    return h;
+}
+
+DNSClient::CacheEntry* DNSClient::lookup(uint32_t aHash)
+{
+    uint32_t now = millis();
+    for (int i =0; i < DNS_CACHE_SIZE; i++)
+    {
+        if ( (sCache[i].iLifetime != 0) &&
+             ((now - sCache[i].iStored) >= sCache[i].iLifetime) )
+        {
+            // It's expired, free the slot
+            sCache[i].iLifetime = 0;
+        }
+        if ( (sCache[i].iLifetime != 0) && (sCache[i].iHash == aHash) )
+        {
+            return &sCache[i];
+        }
+    }
+    return NULL;
+}
+
+void DNSClient::store(uint32_t aHash, const IPAddress& aAddress, uint32_t aTTL)
+{
+    if (aTTL < DNS_CACHE_MIN_TTL)
+    {
+        aTTL = DNS_CACHE_MIN_TTL;
+    }
+    else if (aTTL > DNS_CACHE_MAX_TTL)
+    {
+        aTTL = DNS_CACHE_MAX_TTL;
+    }
+
+    // Use the slot of the name if it's still there, else a free one, else
+    // replace the one that has been there longest
+    uint32_t now = millis();
+    CacheEntry* entry = lookup(aHash);
+    for (int i =0; !entry && (i < DNS_CACHE_SIZE); i++)
+    {
+        if (sCache[i].iLifetime == 0)
+        {
+            entry = &sCache[i];
+        }
+    }
+    if (!entry)
+    {
+        entry = &sCache[0];
+        for (int i =1; i < DNS_CACHE_SIZE; i++)
+        {
+            if ((now - sCache[i].iStored) > (now - entry->iStored))
+            {
+                entry = &sCache[i];
+            }
+        }
+    }
+
+    entry->iHash = aHash;
+    entry->iAddress[0] = aAddress[0];
+    entry->iAddress[1] = aAddress[1];
+    entry->iAddress[2] = aAddress[2];
+    entry->iAddress[3] = aAddress[3];
+    entry->iStored = now;
+    entry->iLifetime = aTTL * 1000UL;
+}
+
 uint16_t DNSClient::BuildRequest(const char* aName)
 {
     // Build header
@@ -252,19 +395,8 @@ uint16_t DNSClient::BuildRequest(const char* aName)
 }
 
 
-uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
+int DNSClient::ReadResponse(IPAddress& aAddress)
 {
-    uint32_t startTime = millis();
-
-    // Wait for a response packet
-    while(iUdp.parsePacket() <= 0)
-    {
-        if((millis() - startTime) > aTimeout)
-            return TIMED_OUT;
-        delay(50);
-    }
-
-    // We've had a reply!
     // Read the UDP header
     uint8_t header[DNS_HEADER_SIZE]; // Enough space to reuse for the DNS header
     // Check that it's a response from the right server and the right port
@@ -382,11 +514,11 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
         iUdp.read((uint8_t*)&answerType, sizeof(answerType));
         iUdp.read((uint8_t*)&answerClass, sizeof(answerClass));
 
-        // Ignore the Time-To-Live as we don't do any caching
-        for (int i =0; i < TTL_SIZE; i++)
-        {
-            iUdp.read(); // we don't care about the returned byte
-        }
+        // Read the Time-To-Live, the cache needs it
+        uint8_t ttl[TTL_SIZE];
+        iUdp.read(ttl, TTL_SIZE);
+        iTTL = ((uint32_t)ttl[0] << 24) | ((uint32_t)ttl[1] << 16) |
+               ((uint32_t)ttl[2] << 8) | ttl[3];
 
         // And read out the length of this answer
         // Don't need header_flags anymore, so we can reuse it here
@@ -7,6 +7,27 @@
 
 #include <EthernetUdp.h>
 
+// Number of resolved names remembered
+#ifndef DNS_CACHE_SIZE
+#define DNS_CACHE_SIZE 4
+#endif
+// Names are kept at least this long (seconds), whatever TTL the server gives
+#ifndef DNS_CACHE_MIN_TTL
+#define DNS_CACHE_MIN_TTL 3600UL
+#endif
+// ...and at most this long (seconds)
+#ifndef DNS_CACHE_MAX_TTL
+#define DNS_CACHE_MAX_TTL 86400UL
+#endif
+// How long (milliseconds) to wait for the reply of the server
+#ifndef DNS_TIMEOUT
+#define DNS_TIMEOUT 15000UL
+#endif
+
+// Returned by beginHostByName() and checkHostByName() whilst waiting for the
+// reply of the server
+#define DNS_PENDING 0
+
 class DNSClient
 {
 public:
@@ -29,13 +50,60 @@ public:
     */
     int getHostByName(const char* aHostname, IPAddress& aResult);
 
+    /** Start to resolve the given hostname without waiting for the reply.
+        Numeric addresses and names still in the cache are answered at once,
+        otherwise the request is sent and checkHostByName() has to be called
+        until it no longer returns DNS_PENDING.
+        @param aHostname Name to be resolved
+        @param aResult IPAddress structure to store the returned IP address
+        @result 1 if aResult already holds the address, DNS_PENDING if the
+                request has been sent, else error code
+    */
+    int beginHostByName(const char* aHostname, IPAddress& aResult);
+
+    /** Check for the reply to the request sent by beginHostByName().
+        @param aResult IPAddress structure to store the returned IP address
+        @result 1 if aResult holds the address, DNS_PENDING if there's no
+                reply yet, else error code
+    */
+    int checkHostByName(IPAddress& aResult);
+
+    /** Drop the given hostname from the cache, e.g. because the address it
+        resolved to can't be reached anymore.
+        @param aHostname Name to be forgotten
+    */
+    static void forget(const char* aHostname);
+
 protected:
+    struct CacheEntry
+    {
+        uint32_t iHash;
+        uint8_t iAddress[4];
+        // millis() when the entry was stored
+        uint32_t iStored;
+        // How long (milliseconds) the entry is valid, 0 if the slot is free
+        uint32_t iLifetime;
+    };
+
     uint16_t BuildRequest(const char* aName);
-    uint16_t ProcessResponse(uint16_t aTimeout, IPAddress& aAddress);
+    int ReadResponse(IPAddress& aAddress);
+
+    static uint32_t hash(const char* aName);
+    static CacheEntry* lookup(uint32_t aHash);
+    static void store(uint32_t aHash, const IPAddress& aAddress, uint32_t aTTL);
 
     IPAddress iDNSServer;
     uint16_t iRequestId;
     EthernetUDP iUdp;
+    // Hash of the name of the outstanding request
+    uint32_t iPendingHash;
+    // millis() when the outstanding request was sent
+    uint32_t iRequestTime;
+    bool iPending;
+    // TTL (seconds) of the last answer read
+    uint32_t iTTL;
+
+    static CacheEntry sCache[DNS_CACHE_SIZE];
 };
 
 #endif
@@ -29,7 +29,12 @@ int EthernetClient::connect(const char* host, uint16_t port) {
   dns.begin(Ethernet.dnsServerIP());
   ret = dns.getHostByName(host, remote_addr);
   if (ret == 1) {
-    return connect(remote_addr, port);
+    ret = connect(remote_addr, port);
+    if (ret != 1) {
+      // The cached address may be stale, ask the server again next time
+      DNSClient::forget(host);
+    }
+    return ret;
   } else {
     return ret;
   }
@@ -0,0 +1,64 @@
+// Write combining Print adapter for Client connections
+// Released under Apache License, version 2.0
+
+#include "BufferedPrint.h"
+#include <string.h>
+
+BufferedPrint::BufferedPrint(Print& aSink)
+ : iSink(&aSink), iLength(0)
+{
+}
+
+size_t BufferedPrint::write(uint8_t aByte)
+{
+    if (iLength == sizeof(iBuffer))
+    {
+        flush();
+    }
+    iBuffer[iLength++] = aByte;
+    return 1;
+}
+
+size_t BufferedPrint::write(const uint8_t *aBuffer, size_t aSize)
+{
+    size_t written = 0;
+    size_t chunk;
+
+    while (aSize)
+    {
+        if ((iLength == 0) && (aSize >= sizeof(iBuffer)))
+        {
+            // Nothing to combine it with, so hand it on in one go
+            return written + iSink->write(aBuffer, aSize);
+        }
+        chunk = sizeof(iBuffer) - iLength;
+        if (chunk > aSize)
+        {
+            chunk = aSize;
+        }
+        memcpy(&iBuffer[iLength], aBuffer, chunk);
+        iLength += chunk;
+        aBuffer += chunk;
+        aSize -= chunk;
+        written += chunk;
+        if (iLength == sizeof(iBuffer))
+        {
+            flush();
+        }
+    }
+    return written;
+}
+
+size_t BufferedPrint::flush()
+{
+    size_t sent = 0;
+
+    if (iLength)
+    {
+        sent = iSink->write(iBuffer, iLength);
+        // Whatever happened, the data is gone.  A failed send is reported by
+        // the sink through its write error
+        iLength = 0;
+    }
+    return sent;
+}
@@ -0,0 +1,54 @@
+// Write combining Print adapter for Client connections
+// Released under Apache License, version 2.0
+
+#ifndef BufferedPrint_h
+#define BufferedPrint_h
+
+#include <Arduino.h>
+#include <Print.h>
+
+// Size of the write buffer.  Every flush becomes one send on the underlying
+// Client, i.e. one TCP segment for the W5100.  The MSS of 1460 bytes would be
+// too much RAM for the ATmega, so this is a compromise that can be
+// overridden at build time
+#ifndef HTTP_WRITE_BUFFER_SIZE
+#define HTTP_WRITE_BUFFER_SIZE 256
+#endif
+
+class BufferedPrint : public Print
+{
+public:
+    BufferedPrint(Print& aSink);
+
+    /** Collect a byte, sending the buffer on when it is full
+      @return 1
+    */
+    virtual size_t write(uint8_t aByte);
+
+    /** Collect a block, sending the buffer on when it is full.  Blocks that
+      don't fit into an empty buffer are passed straight through
+      @return Number of bytes stored or sent.  Send errors are reported by
+      the sink through its write error
+    */
+    virtual size_t write(const uint8_t *aBuffer, size_t aSize);
+
+    /** Send everything collected so far to the sink as one write
+      @return Number of bytes sent
+    */
+    size_t flush();
+
+    /** Drop everything collected so far without sending it
+    */
+    void discard() { iLength = 0; };
+
+    /** Number of bytes waiting to be sent
+    */
+    size_t pending() { return iLength; };
+
+protected:
+    Print* iSink;
+    size_t iLength;
+    uint8_t iBuffer[HTTP_WRITE_BUFFER_SIZE];
+};
+
+#endif
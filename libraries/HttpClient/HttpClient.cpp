@@ -3,6 +3,7 @@
 // Released under Apache License, version 2.0
 
 #include "HttpClient.h"
+#include "BufferedPrint.h"
 #include "b64.h"
 #ifdef PROXY_ENABLED // currently disabled as introduces dependency on Dns.h in Ethernet
 #include <Dns.h>
@@ -20,7 +21,8 @@ const char* HttpClient::kContentLengthPrefix = "Content-Length: ";
 
 #ifdef PROXY_ENABLED // currently disabled as introduces dependency on Dns.h in Ethernet
 HttpClient::HttpClient(Client& aClient, const char* aProxy, uint16_t aProxyPort)
- : iClient(&aClient), iProxyPort(aProxyPort)
+ : iClient(&aClient), iProxyPort(aProxyPort), iOut(aClient), iKeepAlive(false),
+   iConnectionId(0)
 {
   resetState();
   if (aProxy)
@@ -35,7 +37,8 @@ HttpClient::HttpClient(Client& aClient, const char* aProxy, uint16_t aProxyPort)
 }
 #else
 HttpClient::HttpClient(Client& aClient)
- : iClient(&aClient), iProxyPort(0)
+ : iClient(&aClient), iProxyPort(0), iOut(aClient), iKeepAlive(false),
+   iConnectionId(0)
 {
   resetState();
 }
@@ -45,7 +48,7 @@ void HttpClient::resetState()
 {
   iState = eIdle;
   iStatusCode = 0;
-  iContentLength = 0;
+  iContentLength = kNoContentLengthHeader;
   iBodyLengthConsumed = 0;
   iContentLengthPtr = 0;
   iHttpResponseTimeout = kHttpResponseTimeout;
@@ -53,7 +56,12 @@ void HttpClient::resetState()
 
 void HttpClient::stop()
 {
-  iClient->stop();
+  iOut.flush();
+  if (!iKeepAlive || !finishResponse())
+  {
+    iClient->stop();
+    iConnectionId = 0;
+  }
   resetState();
 }
 
@@ -70,29 +78,14 @@ int HttpClient::startRequest(const char* aServerName, uint16_t aServerPort, cons
         return HTTP_ERROR_API;
     }
 
-    if (iProxyPort)
+    int ret = openConnection(aServerName, IPAddress(0,0,0,0), aServerPort);
+    if (HTTP_SUCCESS != ret)
     {
-        if (!iClient->connect(iProxyAddress, iProxyPort) > 0)
-        {
-#ifdef LOGGING
-            Serial.println("Proxy connection failed");
-#endif
-            return HTTP_ERROR_CONNECTION_FAILED;
-        }
-    }
-    else
-    {
-        if (!iClient->connect(aServerName, aServerPort) > 0)
-        {
-#ifdef LOGGING
-            Serial.println("Connection failed");
-#endif
-            return HTTP_ERROR_CONNECTION_FAILED;
-        }
+        return ret;
     }
 
     // Now we're connected, send the first part of the request
-    int ret = sendInitialHeaders(aServerName, IPAddress(0,0,0,0), aServerPort, aURLPath, aHttpMethod, aUserAgent);
+    ret = sendInitialHeaders(aServerName, IPAddress(0,0,0,0), aServerPort, aURLPath, aHttpMethod, aUserAgent);
     if ((initialState == eIdle) && (HTTP_SUCCESS == ret))
     {
         // This was a simple version of the API, so terminate the headers now
@@ -111,37 +104,96 @@ int HttpClient::startRequest(const IPAddress& aServerAddress, const char* aServe
         return HTTP_ERROR_API;
     }
 
+    int ret = openConnection(NULL, aServerAddress, aServerPort);
+    if (HTTP_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    // Now we're connected, send the first part of the request
+    ret = sendInitialHeaders(aServerName, aServerAddress, aServerPort, aURLPath, aHttpMethod, aUserAgent);
+    if ((initialState == eIdle) && (HTTP_SUCCESS == ret))
+    {
+        // This was a simple version of the API, so terminate the headers now
+        finishHeaders();
+    }
+    // else we'll call it in endRequest or in the first call to print, etc.
+
+    return ret;
+}
+
+int HttpClient::openConnection(const char* aServerName, const IPAddress& aServerAddress, uint16_t aServerPort)
+{
+    // Work out where we're connecting to, and from that an id to recognise
+    // the connection by next time round
+    IPAddress address = aServerAddress;
+    uint16_t port = aServerPort;
     if (iProxyPort)
     {
-        if (!iClient->connect(iProxyAddress, iProxyPort) > 0)
+        aServerName = NULL;
+        address = iProxyAddress;
+        port = iProxyPort;
+    }
+    uint16_t id = port;
+    if (aServerName)
+    {
+        for (const char* p = aServerName; *p; p++)
         {
-#ifdef LOGGING
-            Serial.println("Proxy connection failed");
-#endif
-            return HTTP_ERROR_CONNECTION_FAILED;
+            id = id*31 + *p;
         }
     }
     else
     {
-        if (!iClient->connect(aServerAddress, aServerPort) > 0)
+        for (int i = 0; i < 4; i++)
         {
-#ifdef LOGGING
-            Serial.println("Connection failed");
-#endif
-            return HTTP_ERROR_CONNECTION_FAILED;
+            id = id*31 + address[i];
         }
     }
+    if (id == 0)
+    {
+        // 0 means "not connected"
+        id = 1;
+    }
 
-    // Now we're connected, send the first part of the request
-    int ret = sendInitialHeaders(aServerName, aServerAddress, aServerPort, aURLPath, aHttpMethod, aUserAgent);
-    if ((initialState == eIdle) && (HTTP_SUCCESS == ret))
+    if (iConnectionId != 0)
     {
-        // This was a simple version of the API, so terminate the headers now
-        finishHeaders();
+        // Throw away anything left over from the previous response
+        iClient->flush();
+        if (iKeepAlive && (iConnectionId == id) && iClient->connected())
+        {
+            // Still open, so we can just carry on using it
+            return HTTP_SUCCESS;
+        }
+        // The server has closed it, or it goes elsewhere
+        iClient->stop();
+        iConnectionId = 0;
     }
-    // else we'll call it in endRequest or in the first call to print, etc.
 
-    return ret;
+    int ret;
+    if (aServerName)
+    {
+        ret = iClient->connect(aServerName, port);
+    }
+    else
+    {
+        ret = iClient->connect(address, port);
+    }
+    if (ret <= 0)
+    {
+#ifdef LOGGING
+        if (iProxyPort)
+        {
+            Serial.println("Proxy connection failed");
+        }
+        else
+        {
+            Serial.println("Connection failed");
+        }
+#endif
+        return HTTP_ERROR_CONNECTION_FAILED;
+    }
+    iConnectionId = id;
+    return HTTP_SUCCESS;
 }
 
 int HttpClient::sendInitialHeaders(const char* aServerName, IPAddress aServerIP, uint16_t aPort, const char* aURLPath, const char* aHttpMethod, const char* aUserAgent)
@@ -150,51 +202,57 @@ int HttpClient::sendInitialHeaders(const char* aServerName, IPAddress aServerIP,
     Serial.println("Connected");
 #endif
     // Send the HTTP command, i.e. "GET /somepath/ HTTP/1.0"
-    iClient->print(aHttpMethod);
-    iClient->print(" ");
+    iOut.print(aHttpMethod);
+    iOut.print(" ");
     if (iProxyPort)
     {
       // We're going through a proxy, send a full URL
-      iClient->print("http://");
+      iOut.print("http://");
       if (aServerName)
       {
         // We've got a server name, so use it
-        iClient->print(aServerName);
+        iOut.print(aServerName);
       }
       else
       {
         // We'll have to use the IP address
-        iClient->print(aServerIP);
+        iOut.print(aServerIP);
       }
       if (aPort != kHttpPort)
       {
-        iClient->print(":");
-        iClient->print(aPort);
+        iOut.print(":");
+        iOut.print(aPort);
       }
     }
-    iClient->print(aURLPath);
-    iClient->println(" HTTP/1.1");
+    iOut.print(aURLPath);
+    iOut.println(" HTTP/1.1");
     // The host header, if required
     if (aServerName)
     {
-        iClient->print("Host: ");
-        iClient->print(aServerName);
+        iOut.print("Host: ");
+        iOut.print(aServerName);
         if (aPort != kHttpPort)
         {
-          iClient->print(":");
-          iClient->print(aPort);
+          iOut.print(":");
+          iOut.print(aPort);
         }
-        iClient->println();
+        iOut.println();
     }
     // And user-agent string
-    iClient->print("User-Agent: ");
+    iOut.print("User-Agent: ");
     if (aUserAgent)
     {
-        iClient->println(aUserAgent);
+        iOut.println(aUserAgent);
     }
     else
     {
-        iClient->println(kUserAgent);
+        iOut.println(kUserAgent);
+    }
+    if (!iKeepAlive)
+    {
+        // We're going to close the connection once we're done, so tell the
+        // server not to wait around for another request
+        iOut.println("Connection: close");
     }
 
     // Everything has gone well
@@ -204,27 +262,27 @@ int HttpClient::sendInitialHeaders(const char* aServerName, IPAddress aServerIP,
 
 void HttpClient::sendHeader(const char* aHeader)
 {
-    iClient->println(aHeader);
+    iOut.println(aHeader);
 }
 
 void HttpClient::sendHeader(const char* aHeaderName, const char* aHeaderValue)
 {
-    iClient->print(aHeaderName);
-    iClient->print(": ");
-    iClient->println(aHeaderValue);
+    iOut.print(aHeaderName);
+    iOut.print(": ");
+    iOut.println(aHeaderValue);
 }
 
 void HttpClient::sendHeader(const char* aHeaderName, const int aHeaderValue)
 {
-    iClient->print(aHeaderName);
-    iClient->print(": ");
-    iClient->println(aHeaderValue);
+    iOut.print(aHeaderName);
+    iOut.print(": ");
+    iOut.println(aHeaderValue);
 }
 
 void HttpClient::sendBasicAuth(const char* aUser, const char* aPassword)
 {
     // Send the initial part of this header line
-    iClient->print("Authorization: Basic ");
+    iOut.print("Authorization: Basic ");
     // Now Base64 encode "aUser:aPassword" and send that
     // This seems trickier than it should be but it's mostly to avoid either
     // (a) some arbitrarily sized buffer which hopes to be big enough, or
@@ -260,19 +318,19 @@ void HttpClient::sendBasicAuth(const char* aUser, const char* aPassword)
             // NUL-terminate the output string
             output[4] = '\0';
             // And write it out
-            iClient->print((char*)output);
+            iOut.print((char*)output);
 // FIXME We might want to fill output with '=' characters if b64_encode doesn't
 // FIXME do it for us when we're encoding the final chunk
             inputOffset = 0;
         }
     }
     // And end the header we've sent
-    iClient->println();
+    iOut.println();
 }
 
 void HttpClient::finishHeaders()
 {
-    iClient->println();
+    iOut.println();
     iState = eRequestSent;
 }
 
@@ -283,7 +341,9 @@ void HttpClient::endRequest()
         // We still need to finish off the headers
         finishHeaders();
     }
-    // else the end of headers has already been sent, so nothing to do here
+    // else the end of headers has already been sent
+    // Either way, push out whatever is still buffered
+    iOut.flush();
 }
 
 int HttpClient::responseStatusCode()
@@ -292,6 +352,8 @@ int HttpClient::responseStatusCode()
     {
         return HTTP_ERROR_API;
     }
+    // Make sure the server has got the whole request
+    iOut.flush();
     // The first line will be of the form Status-Line:
     //   HTTP-Version SP Status-Code SP Reason-Phrase CRLF
     // Where HTTP-Version is of the form:
@@ -361,6 +423,12 @@ int HttpClient::responseStatusCode()
                     timeoutStart = millis();
                 }
             }
+            else if (!iClient->connected())
+            {
+                // The server has closed the connection (e.g. an idle kept
+                // alive one), so there's no point in waiting for the reply
+                break;
+            }
             else
             {
                 // We haven't got any data, so let's pause to allow some to
@@ -380,7 +448,8 @@ int HttpClient::responseStatusCode()
 
     if ( (c == '\n') && (iState == eStatusCodeRead) )
     {
-        // We've read the status-line successfully
+        // We've read the status-line successfully, get ready for the headers
+        iContentLengthPtr = kContentLengthPrefix;
         return iStatusCode;
     }
     else if (c != '\n')
@@ -429,6 +498,37 @@ int HttpClient::skipResponseHeaders()
     }
 }
 
+bool HttpClient::finishResponse()
+{
+    if ( (iState < eStatusCodeRead) ||
+         (skipResponseHeaders() != HTTP_SUCCESS) ||
+         (contentLength() == kNoContentLengthHeader) )
+    {
+        // We can't tell where this response ends
+        return false;
+    }
+    // Skip whatever the user hasn't read of the body
+    unsigned long timeoutStart = millis();
+    while ((!endOfBodyReached()) && 
+           ( (millis() - timeoutStart) < iHttpResponseTimeout ))
+    {
+        if (available())
+        {
+            (void)read();
+            timeoutStart = millis();
+        }
+        else if (!iClient->connected())
+        {
+            break;
+        }
+        else
+        {
+            delay(kHttpWaitForDataDelay);
+        }
+    }
+    return endOfBodyReached() && iClient->connected();
+}
+
 bool HttpClient::endOfBodyReached()
 {
     if (endOfHeadersReached() && (contentLength() != kNoContentLengthHeader))
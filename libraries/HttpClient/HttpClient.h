@@ -8,6 +8,7 @@
 #include <Arduino.h>
 #include <IPAddress.h>
 #include "Client.h"
+#include "BufferedPrint.h"
 
 static const int HTTP_SUCCESS =0;
 // The end of the headers has been reached.  This consumes the '\n'
@@ -354,8 +355,11 @@ public:
     // Inherited from Print
     // Note: 1st call to these indicates the user is sending the body, so if need
     // Note: be we should finish the header first
-    virtual size_t write(uint8_t aByte) { if (iState < eRequestSent) { finishHeaders(); }; return iClient-> write(aByte); };
-    virtual size_t write(const uint8_t *aBuffer, size_t aSize) { if (iState < eRequestSent) { finishHeaders(); }; return iClient->write(aBuffer, aSize); };
+    // Note: Headers and body are collected in iOut and sent in as few segments
+    // Note: as possible, i.e. when the buffer is full, in endRequest(), flush()
+    // Note: or before the response is read
+    virtual size_t write(uint8_t aByte) { if (iState < eRequestSent) { finishHeaders(); }; return iOut.write(aByte); };
+    virtual size_t write(const uint8_t *aBuffer, size_t aSize) { if (iState < eRequestSent) { finishHeaders(); }; return iOut.write(aBuffer, aSize); };
     // Inherited from Stream
     virtual int available() { return iClient->available(); };
     /** Read the next byte from the server.
@@ -364,7 +368,7 @@ public:
     virtual int read();
     virtual int read(uint8_t *buf, size_t size);
     virtual int peek() { return iClient->peek(); };
-    virtual void flush() { return iClient->flush(); };
+    virtual void flush() { iOut.flush(); return iClient->flush(); };
 
     // Inherited from Client
     virtual int connect(IPAddress ip, uint16_t port) { return iClient->connect(ip, port); };
@@ -374,6 +378,19 @@ public:
     virtual operator bool() { return bool(iClient); };
     virtual uint32_t httpResponseTimeout() { return iHttpResponseTimeout; };
     virtual void setHttpResponseTimeout(uint32_t timeout) { iHttpResponseTimeout = timeout; };
+
+    /** Enable or disable persistent connections.
+      With keep-alive enabled stop() reads the rest of the response and leaves
+      the connection open, and the next request to the same server is sent over
+      it without connecting (and resolving the server name) again.  If the
+      server has closed the connection in the meantime a new one is opened.
+      Responses without a Content-Length header always close the connection.
+      With keep-alive disabled (the default) "Connection: close" is sent and
+      stop() closes the connection as before.
+      @param aKeepAlive true to keep connections open between requests
+    */
+    void setKeepAlive(bool aKeepAlive) { iKeepAlive = aKeepAlive; };
+    bool keepAlive() { return iKeepAlive; };
 protected:
     /** Reset internal state data back to the "just initialised" state
     */
@@ -402,6 +419,24 @@ protected:
     */
     void finishHeaders();
 
+    /** Make sure we're connected to the given server, reusing the connection
+      of the previous request if we're allowed to and it's still open
+      @param aServerName Name of the server, or NULL to connect to aServerAddress
+      @param aServerAddress IP address of the server, used if aServerName is NULL
+      @param aServerPort Port to connect to on the server
+      @return HTTP_SUCCESS if connected, else HTTP_ERROR_CONNECTION_FAILED
+    */
+    int openConnection(const char* aServerName,
+                       const IPAddress& aServerAddress,
+                       uint16_t aServerPort);
+
+    /** Read whatever is left of the current response so that the connection
+      can carry the next request
+      @return true if the whole response was read and the connection is
+      still open, else false
+    */
+    bool finishResponse();
+
     // Number of milliseconds that we wait each time there isn't any data
     // available to be read (during status code and header processing)
     static const int kHttpWaitForDataDelay = 1000;
@@ -437,6 +472,12 @@ protected:
     IPAddress iProxyAddress;
     uint16_t iProxyPort;
     uint32_t iHttpResponseTimeout;
+    // Write combining buffer in front of iClient for the request
+    BufferedPrint iOut;
+    // Whether connections are kept open between requests
+    bool iKeepAlive;
+    // Hash of the server and port the open connection goes to, 0 if none
+    uint16_t iConnectionId;
 };
 
 #endif
@@ -11,7 +11,7 @@ d		:= $(dir)
 
 # Local variables
 
-OBJS_$(d)	:= $(d)/b64.o $(d)/HttpClient.o
+OBJS_$(d)	:= $(d)/b64.o $(d)/BufferedPrint.o $(d)/HttpClient.o
 DEPS_$(d)	:= $(OBJS_$(d):%=%.d)
 CLEAN		:= $(CLEAN) $(OBJS_$(d)) $(DEPS_$(d))
 
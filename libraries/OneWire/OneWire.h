@@ -30,13 +30,21 @@
 #define ONEWIRE_CRC 1
 #endif
 
+// Values for ONEWIRE_CRC8_TABLE and ONEWIRE_CRC16_TABLE
+#define ONEWIRE_CRC_BITWISE 0
+#define ONEWIRE_CRC_FULL    1
+#define ONEWIRE_CRC_NIBBLE  2
+
 // Select the table-lookup method of computing the 8-bit CRC
-// by setting this to 1.  The lookup table enlarges code size by
-// about 250 bytes.  It does NOT consume RAM (but did in very
-// old versions of OneWire).  If you disable this, a slower
-// but very compact algorithm is used.
+// by setting this to 1 (ONEWIRE_CRC_FULL).  The lookup table enlarges
+// code size by about 250 bytes.  It does NOT consume RAM (but did in very
+// old versions of OneWire).  Setting this to 2 (ONEWIRE_CRC_NIBBLE) uses
+// two 16 entry tables (32 bytes) and two lookups per byte instead.  If you
+// disable this, a slower but very compact algorithm is used.
+// The method can be chosen at build time, e.g.
+//   make FEATURE_DEFINES=-DONEWIRE_CRC8_TABLE=2
 #ifndef ONEWIRE_CRC8_TABLE
-#define ONEWIRE_CRC8_TABLE 1
+#define ONEWIRE_CRC8_TABLE ONEWIRE_CRC_FULL
 #endif
 
 // You can allow 16-bit CRC checks by defining this to 1
@@ -45,6 +53,13 @@
 #define ONEWIRE_CRC16 1
 #endif
 
+// Select the method of computing the 16-bit CRC the same way as
+// ONEWIRE_CRC8_TABLE.  The full table takes 512 bytes of flash, the
+// nibble tables 64 bytes.  0 selects the compact parity algorithm.
+#ifndef ONEWIRE_CRC16_TABLE
+#define ONEWIRE_CRC16_TABLE ONEWIRE_CRC_NIBBLE
+#endif
+
 #define FALSE 0
 #define TRUE  1
 
@@ -73,6 +88,18 @@
 #define DIRECT_WRITE_LOW(base, mask)    ((*(base+8+1)) = (mask))          //LATXCLR  + 0x24
 #define DIRECT_WRITE_HIGH(base, mask)   ((*(base+8+2)) = (mask))          //LATXSET + 0x28
 
+#elif defined(HOST_TEST)
+// Simulated AVR ports of the host tests in Framework/test
+#define PIN_TO_BASEREG(pin)             (portInputRegister(digitalPinToPort(pin)))
+#define PIN_TO_BITMASK(pin)             (digitalPinToBitMask(pin))
+#define IO_REG_TYPE uint8_t
+#define IO_REG_ASM
+#define DIRECT_READ(base, mask)         (((*(base)) & (mask)) ? 1 : 0)
+#define DIRECT_MODE_INPUT(base, mask)   ((*(base+1)) &= ~(mask))
+#define DIRECT_MODE_OUTPUT(base, mask)  ((*(base+1)) |= (mask))
+#define DIRECT_WRITE_LOW(base, mask)    ((*(base+2)) &= ~(mask))
+#define DIRECT_WRITE_HIGH(base, mask)   ((*(base+2)) |= (mask))
+
 #else
 #error "Please define I/O register types here"
 #endif
@@ -57,6 +57,11 @@ boolean File::isDirectory(void) {
   return (_file && _file->isDir());
 }
 
+// copy of the directory entry, e.g. for the time of the last write
+uint8_t File::dirEntry(dir_t* dir) {
+  return (_file && _file->dirEntry(dir));
+}
+
 
 size_t File::write(uint8_t val) {
   return write(&val, 1);
@@ -47,6 +47,7 @@ public:
   char * name();
 
   boolean isDirectory(void);
+  uint8_t dirEntry(dir_t* dir);
   File openNextFile(uint8_t mode = O_RDONLY);
   void rewindDirectory(void);
   
@@ -0,0 +1,30 @@
+
+#include <Print.h>
+#include <string.h>
+
+// Print into a fixed size buffer.  Output that doesn't fit is dropped and
+// remembered, so the caller can tell whether the buffer holds everything
+class BufferPrint : public Print
+{
+public:
+  BufferPrint(char* aBuffer, size_t aSize) : _buffer(aBuffer), _size(aSize), _length(0), _overflow(false) {};
+  virtual size_t write(uint8_t aByte) { return write(&aByte, 1); };
+  virtual size_t write(const uint8_t *aBuffer, size_t aSize)
+  {
+    if (_length + aSize > _size)
+    {
+      _overflow = true;
+      return 0;
+    }
+    memcpy(&_buffer[_length], aBuffer, aSize);
+    _length += aSize;
+    return aSize;
+  };
+  size_t length() { return _length; };
+  bool overflow() { return _overflow; };
+protected:
+  char* _buffer;
+  size_t _size;
+  size_t _length;
+  bool _overflow;
+};
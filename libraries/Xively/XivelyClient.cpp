@@ -1,17 +1,47 @@
 #include <Xively.h>
 #include <HttpClient.h>
 #include <CountingStream.h>
+#include <BufferPrint.h>
 
 XivelyClient::XivelyClient(Client& aClient)
-  : _client(aClient)
+  : _client(aClient), _http(aClient)
 {
+  // Keep the connection to the server open between uploads, which saves the
+  // DNS lookup and the TCP handshake each time
+  _http.setKeepAlive(true);
 }
 
 int XivelyClient::put(XivelyFeed& aFeed, const char* aApiKey)
 {
-  HttpClient http(_client);
+  // A feed of a few datastreams fits into the scratch buffer
+  return putBody(aFeed.id(), aFeed, aApiKey, true);
+}
+
+int XivelyClient::put(unsigned long aFeedId, const Printable& aBody, const char* aApiKey)
+{
+  // Documents of unknown size, e.g. batches of datapoints, are usually bigger
+  // than the scratch buffer, so don't reserve it for them
+  return putBody(aFeedId, aBody, aApiKey, false);
+}
+
+int XivelyClient::putBody(unsigned long aFeedId, const Printable& aBody, const char* aApiKey, bool aRenderOnce)
+{
+  bool reused = _http.connected();
+  int ret = sendFeed(aFeedId, aBody, aApiKey, aRenderOnce);
+  if (reused && (ret < 0) && (ret > -100))
+  {
+    // The kept alive connection failed rather than the server rejecting the
+    // feed, most likely it was closed by the server.  Try again over a new one
+    ret = sendFeed(aFeedId, aBody, aApiKey, aRenderOnce);
+  }
+  return ret;
+}
+
+int XivelyClient::sendFeed(unsigned long aFeedId, const Printable& aBody, const char* aApiKey, bool aRenderOnce)
+{
+  HttpClient& http = _http;
   char path[30];
-  buildPath(path, aFeed.id(), "json");
+  buildPath(path, aFeedId, "json");
   http.beginRequest();
   int ret = http.put("api.xively.com", path);
   if (ret == 0)
@@ -19,25 +49,9 @@ int XivelyClient::put(XivelyFeed& aFeed, const char* aApiKey)
     http.sendHeader("X-ApiKey", aApiKey);
     http.sendHeader("User-Agent", "Xively-Arduino-Lib/1.0");    
 
-    CountingStream countingStream; // Used to work out how long that data will be
-    for (int i =kCalculateDataLength; i <= kSendData; i++)
+    if (!aRenderOnce || !sendRendered(aBody))
     {
-      Print* s;
-      int len =0;
-      if (i == kCalculateDataLength)
-      {
-        s = &countingStream;
-      }
-      else
-      {
-        s = &http;
-      }
-      len = s->print(aFeed);
-      if (i == kCalculateDataLength)
-      {
-        // We now know how long the data will be...
-        http.sendHeader("Content-Length", len);
-      }
+      sendCounted(aBody);
     }
     // Now we're done sending the request
     http.endRequest();
@@ -51,12 +65,40 @@ int XivelyClient::put(XivelyFeed& aFeed, const char* aApiKey)
         ret = ret * -1;
       }
     }
-    http.flush();
+    // Reads the rest of the response, the connection stays open if possible
     http.stop();
   }
   return ret;
 }
 
+// Kept out of sendFeed so the scratch buffer is only on the stack while it
+// is in use
+bool XivelyClient::sendRendered(const Printable& aBody)
+{
+  // Render the body once into the scratch buffer, which gives us the exact
+  // Content-Length and the body in one go
+  char buffer[XIVELY_RENDER_BUFFER_SIZE];
+  BufferPrint renderer(buffer, sizeof(buffer));
+  int len = renderer.print(aBody);
+  if (renderer.overflow())
+  {
+    // Nothing was sent yet, the caller falls back to sendCounted
+    return false;
+  }
+  _http.sendHeader("Content-Length", len);
+  _http.write((const uint8_t*)buffer, len);
+  return true;
+}
+
+void XivelyClient::sendCounted(const Printable& aBody)
+{
+  // Render the body twice, once to work out how long it will be and once to
+  // send it through the write buffer of the HttpClient
+  CountingStream countingStream;
+  _http.sendHeader("Content-Length", (int)countingStream.print(aBody));
+  _http.print(aBody);
+}
+
 void XivelyClient::buildPath(char* aDest, unsigned long aFeedId, const char* aFormat)
 {
   char idstr[12]; 
@@ -71,7 +113,10 @@ void XivelyClient::buildPath(char* aDest, unsigned long aFeedId, const char* aFo
 
 int XivelyClient::get(XivelyFeed& aFeed, const char* aApiKey)
 {
-  HttpClient http(_client);
+  // The CSV below is read until the server closes the connection, so this
+  // request can't use a kept alive one
+  HttpClient& http = _http;
+  http.setKeepAlive(false);
   char path[30];
   buildPath(path, aFeed.id(), "csv");
   http.beginRequest();
@@ -166,6 +211,7 @@ int XivelyClient::get(XivelyFeed& aFeed, const char* aApiKey)
     }
     http.stop();
   }
+  http.setKeepAlive(true);
   return ret;
 }
 
@@ -3,8 +3,16 @@
 #define XIVELYCLIENT_H
 
 #include <Client.h>
+#include <HttpClient.h>
 #include <XivelyFeed.h>
 
+// Size of the buffer the JSON body of a XivelyFeed put is rendered into.  It
+// lives on the stack only while the body is rendered.  Bigger feeds, and all
+// bodies put as Printable, are rendered twice, once to count and once to send
+#ifndef XIVELY_RENDER_BUFFER_SIZE
+#define XIVELY_RENDER_BUFFER_SIZE 512
+#endif
+
 class XivelyClient
 {
 public:
@@ -12,13 +20,19 @@ public:
 
   int get(XivelyFeed& aFeed, const char* aApiKey);
   int put(XivelyFeed& aFeed, const char* aApiKey);
+  // Put any JSON document to the given feed, e.g. one with datapoints
+  int put(unsigned long aFeedId, const Printable& aBody, const char* aApiKey);
 
 protected:
-  static const int kCalculateDataLength =0;
-  static const int kSendData =1;
   void buildPath(char* aDest, unsigned long aFeedId, const char* aFormat);
+  int putBody(unsigned long aFeedId, const Printable& aBody, const char* aApiKey, bool aRenderOnce);
+  int sendFeed(unsigned long aFeedId, const Printable& aBody, const char* aApiKey, bool aRenderOnce);
+  bool sendRendered(const Printable& aBody);
+  void sendCounted(const Printable& aBody);
 
   Client& _client;
+  // Shared by all requests so the connection can be kept open between them
+  HttpClient _http;
 };
 
 #endif
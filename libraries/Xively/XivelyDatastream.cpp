@@ -139,10 +139,46 @@ char* XivelyDatastream::getBuffer()
   }
 }
 
+// Print a float with two decimals like Print::printFloat, but with integer
+// arithmetic only and as a single write
+static size_t printFixed(Print& aPrint, float aValue)
+{
+  char text[14];
+  char* p = &text[sizeof(text)];
+  unsigned long scaled;
+  bool negative = aValue < 0;
+
+  if ((aValue >= 21474836.0) || (aValue <= -21474836.0) || (aValue != aValue))
+  {
+    // Out of range for the fixed point version
+    return aPrint.print(aValue);
+  }
+  if (negative)
+  {
+    aValue = -aValue;
+  }
+  scaled = aValue * 100 + 0.5;
+  *--p = '0' + scaled % 10;
+  scaled /= 10;
+  *--p = '0' + scaled % 10;
+  scaled /= 10;
+  *--p = '.';
+  do
+  {
+    *--p = '0' + scaled % 10;
+    scaled /= 10;
+  } while (scaled);
+  if (negative)
+  {
+    *--p = '-';
+  }
+  return aPrint.write((const uint8_t*)p, &text[sizeof(text)] - p);
+}
+
 size_t XivelyDatastream::printTo(Print& aPrint) const
 {
   size_t count =0;
-  count += aPrint.print("{ \"id\" : \"");
+  count += aPrint.print("{\"id\":\"");
   if (_idType == DATASTREAM_STRING)
   {
     count += aPrint.print(_idString);
@@ -151,7 +187,7 @@ size_t XivelyDatastream::printTo(Print& aPrint) const
   {
     count += aPrint.print(_idBuffer._buffer);
   }
-  count += aPrint.print("\", \"current_value\" : \"");
+  count += aPrint.print("\",\"current_value\":\"");
   switch (_valueType)
   {
   case DATASTREAM_STRING:
@@ -164,10 +200,10 @@ size_t XivelyDatastream::printTo(Print& aPrint) const
     count += aPrint.print(_value._valueInt);
     break;
   case DATASTREAM_FLOAT:
-    count += aPrint.print(_value._valueFloat);
+    count += printFixed(aPrint, _value._valueFloat);
     break;
   };
-  count += aPrint.print("\" }");
+  count += aPrint.print("\"}");
   return count;
 }
 